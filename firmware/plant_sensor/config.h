@@ -1,5 +1,6 @@
-/* Optional config overrides for plant_sensor.ino
- * This file is generated at flash time when using FLASH_SSID / FLASH_PASS
- * or FLASH_TARGET_IP. If left empty, the sketch uses its built-in defaults.
+/* Optional build-time defaults for plant_sensor.ino (WIFI_SSID, WIFI_PASS,
+ * TARGET_IP, CONTROL_PIN). They only seed the config block; the gateway
+ * patches FLASH_SSID / FLASH_PASS / FLASH_TARGET_IP / FLASH_CONTROL_PIN
+ * into the compiled image (src/fw_patch.c), so this file normally stays
+ * empty.
  */
-
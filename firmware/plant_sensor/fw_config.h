@@ -0,0 +1,53 @@
+/* fw_config.h
+ * Layout of the configuration block that plant_sensor.ino keeps in flash.
+ * The block is a constant in the firmware image, tagged with a magic so the
+ * gateway can find it in the compiled .bin and patch WiFi credentials,
+ * target IP and control pin into a copy of one prebuilt image per device
+ * (see src/fw_patch.c) instead of recompiling.
+ *
+ * Shared by the firmware (C++) and the gateway (C): fixed-size fields,
+ * little-endian integers, no padding. Bump FW_CONFIG_VERSION when the
+ * layout changes.
+ */
+#ifndef FW_CONFIG_H
+#define FW_CONFIG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FW_CONFIG_MAGIC "PSCONFIG" /* stored without the NUL */
+#define FW_CONFIG_MAGIC_LEN 8
+#define FW_CONFIG_MAGIC_INIT { 'P', 'S', 'C', 'O', 'N', 'F', 'I', 'G' }
+#define FW_CONFIG_VERSION 1
+#define FW_CONFIG_CRC_UNSET 0u /* as built: the defaults, not checked */
+
+typedef struct {
+    char magic[FW_CONFIG_MAGIC_LEN];
+    uint16_t version;
+    uint16_t size;       /* sizeof(fw_config_t) */
+    char ssid[33];       /* NUL-terminated strings */
+    char pass[65];
+    char target_ip[16];  /* dotted quad */
+    uint8_t control_pin;
+    uint8_t reserved;
+    uint32_t crc;        /* CRC-32 of the bytes before this field */
+} fw_config_t;
+
+#define FW_CONFIG_SIZE 132
+#define FW_CONFIG_CRC_OFFSET 128
+typedef char fw_config_size_check[(sizeof(fw_config_t) == FW_CONFIG_SIZE &&
+                                   offsetof(fw_config_t, crc) == FW_CONFIG_CRC_OFFSET) ? 1 : -1];
+
+/* CRC-32 (IEEE, as zlib), bitwise: the block is read once per boot */
+static inline uint32_t fw_config_crc32(const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= p[i];
+        for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+#endif /* FW_CONFIG_H */
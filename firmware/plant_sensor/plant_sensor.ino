@@ -3,12 +3,15 @@
  * "mac value" UDP packets containing the device MAC and the voltage
  * read from A0. It also prints the MAC on serial for registration.
  *
- * Configure SSID/password by defining WIFI_SSID and WIFI_PASS before
- * compiling. If not defined, defaults are used (SSID: "PiTestAP",
- * PASS: "doublepump").
+ * SSID, password, target IP and control pin live in a config block in
+ * flash (fw_config.h). WIFI_SSID, WIFI_PASS, TARGET_IP and CONTROL_PIN
+ * give its built-in values (SSID: "PiTestAP", PASS: "doublepump"); the
+ * gateway patches the block in the compiled image before uploading, so
+ * changing them doesn't need a recompile.
  */
 
 #include "config.h"
+#include "fw_config.h"
 #include <WiFiNINA.h>
 #include <WiFiUdp.h>
 #include <FlashStorage.h>
@@ -20,8 +23,27 @@
 #define WIFI_PASS "doublepump"
 #endif
 
-const char* ssid = WIFI_SSID;
-const char* pass = WIFI_PASS;
+#ifndef TARGET_IP
+#define TARGET_IP "192.168.50.1"
+#endif
+
+// Control pin for remote commands. Default to D2 (safer than D0 which is Serial RX).
+#ifndef CONTROL_PIN
+#define CONTROL_PIN 2
+#endif
+
+// The config block. volatile keeps the compiler from folding the built-in
+// values into the code: the gateway may have patched them in the image.
+extern const volatile fw_config_t fw_config;
+__attribute__((used, aligned(4))) const volatile fw_config_t fw_config = {
+  FW_CONFIG_MAGIC_INIT, FW_CONFIG_VERSION, sizeof(fw_config_t),
+  WIFI_SSID, WIFI_PASS, TARGET_IP, CONTROL_PIN, 0, FW_CONFIG_CRC_UNSET
+};
+
+static fw_config_t cfg; /* RAM copy, loaded in setup() */
+const char* ssid = cfg.ssid;
+const char* pass = cfg.pass;
+static uint8_t controlPin = CONTROL_PIN;
 
 WiFiUDP Udp;
 unsigned int localPort = 12345;
@@ -32,10 +54,25 @@ IPAddress targetIp; /* global target IP for UDP debug messages */
 FlashStorage(thresholdStore, uint8_t);
 static uint8_t stored_threshold = 50;
 
-// Control pin for remote commands. Default to D2 (safer than D0 which is Serial RX).
-#ifndef CONTROL_PIN
-#define CONTROL_PIN 2
-#endif
+/* Copy the config block to RAM. A block with a bad checksum (a broken
+ * patch) is replaced by the built-in values. */
+static void load_config() {
+  const volatile uint8_t *src = (const volatile uint8_t *)&fw_config;
+  uint8_t *dst = (uint8_t *)&cfg;
+  for (size_t i = 0; i < sizeof(cfg); i++) dst[i] = src[i];
+  if (cfg.crc != FW_CONFIG_CRC_UNSET && cfg.crc != fw_config_crc32(&cfg, offsetof(fw_config_t, crc))) {
+    Serial.println("CONFIG: checksum mismatch, using built-in defaults");
+    memset(&cfg, 0, sizeof(cfg));
+    strncpy(cfg.ssid, WIFI_SSID, sizeof(cfg.ssid) - 1);
+    strncpy(cfg.pass, WIFI_PASS, sizeof(cfg.pass) - 1);
+    strncpy(cfg.target_ip, TARGET_IP, sizeof(cfg.target_ip) - 1);
+    cfg.control_pin = CONTROL_PIN;
+  }
+  cfg.ssid[sizeof(cfg.ssid) - 1] = '\0';
+  cfg.pass[sizeof(cfg.pass) - 1] = '\0';
+  cfg.target_ip[sizeof(cfg.target_ip) - 1] = '\0';
+  controlPin = cfg.control_pin;
+}
 
 void setup() {
   Serial.begin(115200);
@@ -47,6 +84,7 @@ void setup() {
   Serial.println("Plant sensor starting...");
   // Unique banner to verify firmware version running on device
   Serial.println("PLANT_SENSOR_BIN:v2");
+  load_config();
 
   // Connect to WiFi (retry every 5 seconds indefinitely)
   int status = WL_IDLE_STATUS;
@@ -78,23 +116,18 @@ void setup() {
   Udp.begin(localPort);
   Serial.println("UDP socket started");
   // initialize targetIp once in setup
-#ifndef TARGET_IP
-  targetIp = IPAddress(192,168,50,1);
-#else
   {
-    const char *t = TARGET_IP;
     int a,b,c,d;
-    if (sscanf(t, "%d.%d.%d.%d", &a,&b,&c,&d) == 4) targetIp = IPAddress(a,b,c,d);
+    if (sscanf(cfg.target_ip, "%d.%d.%d.%d", &a,&b,&c,&d) == 4) targetIp = IPAddress(a,b,c,d);
     else targetIp = IPAddress(255,255,255,255);
   }
-#endif
 
   // Ensure control pin is available and set as output
-  pinMode(CONTROL_PIN, OUTPUT);
-  digitalWrite(CONTROL_PIN, LOW);
+  pinMode(controlPin, OUTPUT);
+  digitalWrite(controlPin, LOW);
   // Print initial control pin state for debugging
-  Serial.print("CONTROL_PIN (D"); Serial.print(CONTROL_PIN); Serial.print(") initial state: ");
-  Serial.println(digitalRead(CONTROL_PIN) == HIGH ? "HIGH" : "LOW");
+  Serial.print("CONTROL_PIN (D"); Serial.print(controlPin); Serial.print(") initial state: ");
+  Serial.println(digitalRead(controlPin) == HIGH ? "HIGH" : "LOW");
 
   // Read persisted threshold from flash storage
   uint8_t t = thresholdStore.read();
@@ -178,25 +211,8 @@ void loop() {
   else if (voltage >= 3.3f) percent = 0;
   else percent = (int)roundf((1.0f - (voltage / 3.3f)) * 100.0f);
 
-  // Send "mac value" as text via UDP to the Pi gateway by default.
-  // Default target IP is 192.168.50.1 (Pi hotspot gateway). Can be
-  // overridden at build time by defining TARGET_IP.
-#ifndef TARGET_IP
-  const IPAddress targetIp(192,168,50,1);
-#else
-  IPAddress targetIp;
-  {
-    // TARGET_IP expected as string literal like "192.168.50.1"
-    const char *t = TARGET_IP;
-    int a,b,c,d;
-    if (sscanf(t, "%d.%d.%d.%d", &a,&b,&c,&d) == 4) {
-      targetIp = IPAddress(a,b,c,d);
-    } else {
-      targetIp = IPAddress(255,255,255,255);
-    }
-  }
-#endif
-
+  // Send "mac value" as text via UDP to the Pi gateway (targetIp, from the
+  // config block; 192.168.50.1, the Pi hotspot, unless patched).
   char buf[64];
   // Format the float into a string using integer math (millivolts)
   char vbuf[16];
@@ -215,13 +231,13 @@ void loop() {
   // configured threshold. If the automatic decision changes the pin state
   // notify the gateway with a short CMD-style packet so the server parser
   // can update the UI immediately.
-  int current_state = digitalRead(CONTROL_PIN) == HIGH ? 1 : 0;
+  int current_state = digitalRead(controlPin) == HIGH ? 1 : 0;
   int desired_state = (percent < stored_threshold) ? 1 : 0;
   if (current_state != desired_state) {
-    digitalWrite(CONTROL_PIN, desired_state ? HIGH : LOW);
+    digitalWrite(controlPin, desired_state ? HIGH : LOW);
     // Send a compact ACK/notification that matches the server's parser
     char ackpkt[64];
-    int an = snprintf(ackpkt, sizeof(ackpkt), "CMD: set D%d = %d", CONTROL_PIN, desired_state);
+    int an = snprintf(ackpkt, sizeof(ackpkt), "CMD: set D%d = %d", controlPin, desired_state);
     Udp.beginPacket(targetIp, localPort);
     Udp.write((const uint8_t*)ackpkt, an);
     Udp.endPacket();
@@ -242,7 +258,7 @@ void loop() {
     "CONTROL_PIN (D%d) state: %s\n"
     "STORED_THRESHOLD: %d\n"
     "=== LOOP END ===\n",
-    millis(), macStr, raw, voltage, milliv, percent, buf, CONTROL_PIN, digitalRead(CONTROL_PIN) == HIGH ? "HIGH" : "LOW", stored_threshold);
+    millis(), macStr, raw, voltage, milliv, percent, buf, controlPin, digitalRead(controlPin) == HIGH ? "HIGH" : "LOW", stored_threshold);
   // Send debug over UDP
   if (WiFi.status() == WL_CONNECTED) udp_debug(dbg);
   // Also print locally to Serial for USB-attached debugging
@@ -266,8 +282,8 @@ void loop() {
       // Accept commands like: "D0 1" or "D0 0" or "D0,1"
       int pin = -1, val = -1;
       if (sscanf(cmdbuf, "D%d %d", &pin, &val) == 2 || sscanf(cmdbuf, "D%d,%d", &pin, &val) == 2 || sscanf(cmdbuf, "D%d:%d", &pin, &val) == 2) {
-        if (pin == CONTROL_PIN && (val == 0 || val == 1)) {
-          digitalWrite(CONTROL_PIN, val ? HIGH : LOW);
+        if (pin == controlPin && (val == 0 || val == 1)) {
+          digitalWrite(controlPin, val ? HIGH : LOW);
           Serial.print("CMD: set D"); Serial.print(pin); Serial.print(" = "); Serial.println(val);
           // Optional: send an ACK back to gateway (same port)
           char ack[64]; int n = snprintf(ack, sizeof(ack), "%s CMD D%d %d", macStr, pin, val);
@@ -106,7 +106,19 @@
  * - LV_OS_MQX
  * - LV_OS_SDL2
  * - LV_OS_CUSTOM */
-#define LV_USE_OS   LV_OS_NONE
+/** Simulator render profile: the number of software render threads.
+ *  0 keeps the single-threaded build without an OS layer; N > 0 builds with
+ *  LV_OS_PTHREAD and N software draw units (4 on a Raspberry Pi 4).
+ *  Set from the build, e.g. `cmake -DLV_SIM_RENDER_THREADS=4`. */
+#ifndef LV_SIM_RENDER_THREADS
+    #define LV_SIM_RENDER_THREADS 0
+#endif
+
+#if LV_SIM_RENDER_THREADS > 0
+    #define LV_USE_OS   LV_OS_PTHREAD
+#else
+    #define LV_USE_OS   LV_OS_NONE
+#endif
 
 #if LV_USE_OS == LV_OS_CUSTOM
     #define LV_OS_CUSTOM_INCLUDE <stdint.h>
@@ -153,7 +165,7 @@
 /** Stack size of drawing thread.
  * NOTE: If FreeType or ThorVG is enabled, it is recommended to set it to 32KB or more.
  */
-#define LV_DRAW_THREAD_STACK_SIZE    (8 * 1024)         /**< [bytes]*/
+#define LV_DRAW_THREAD_STACK_SIZE    (32 * 1024)        /**< [bytes] gradients and shadows need more than 8K */
 
 /** Thread priority of the drawing task.
  *  Higher values mean higher priority.
@@ -191,7 +203,11 @@
     /** Set number of draw units.
      *  - > 1 requires operating system to be enabled in `LV_USE_OS`.
      *  - > 1 means multiple threads will render the screen in parallel. */
-    #define LV_DRAW_SW_DRAW_UNIT_CNT    1
+    #if LV_SIM_RENDER_THREADS > 0
+        #define LV_DRAW_SW_DRAW_UNIT_CNT    LV_SIM_RENDER_THREADS
+    #else
+        #define LV_DRAW_SW_DRAW_UNIT_CNT    1
+    #endif
 
     /** Use Arm-2D to accelerate software (sw) rendering. */
     #define LV_USE_DRAW_ARM2D_SYNC      0
@@ -207,8 +223,9 @@
     #if LV_DRAW_SW_COMPLEX == 1
         /** Allow buffering some shadow calculation.
          *  LV_DRAW_SW_SHADOW_CACHE_SIZE is the maximum shadow size to buffer, where shadow size is
-         *  `shadow_width + radius`.  Caching has LV_DRAW_SW_SHADOW_CACHE_SIZE^2 RAM cost. */
-        #define LV_DRAW_SW_SHADOW_CACHE_SIZE 0
+         *  `shadow_width + radius`.  Caching has LV_DRAW_SW_SHADOW_CACHE_SIZE^2 RAM cost.
+         *  The dialogs in src/modal.c all share shadow 40 / radius 16, so one entry always hits. */
+        #define LV_DRAW_SW_SHADOW_CACHE_SIZE 64
 
         /** Set number of maximally-cached circle data.
          *  The circumference of 1/4 circle are saved for anti-aliasing.
@@ -217,10 +234,12 @@
         #define LV_DRAW_SW_CIRCLE_CACHE_SIZE 4
     #endif
 
-    #define  LV_USE_DRAW_SW_ASM     LV_DRAW_SW_ASM_NONE
+    /** RGB565 fill/blend kernels in src/blend_simd.h: AVX2, SSE2 or NEON,
+     *  picked at compile time; plain C where none is available. */
+    #define  LV_USE_DRAW_SW_ASM     LV_DRAW_SW_ASM_CUSTOM
 
     #if LV_USE_DRAW_SW_ASM == LV_DRAW_SW_ASM_CUSTOM
-        #define  LV_DRAW_SW_ASM_CUSTOM_INCLUDE ""
+        #define  LV_DRAW_SW_ASM_CUSTOM_INCLUDE "src/blend_simd.h"
     #endif
 
     /** Enable drawing complex gradients in software: linear at an angle, radial or conical */
@@ -1037,7 +1056,7 @@
 /* Documentation for several of the below items can be found here: https://docs.lvgl.io/master/details/auxiliary-modules/index.html . */
 
 /** 1: Enable API to take snapshot for object */
-#define LV_USE_SNAPSHOT 0
+#define LV_USE_SNAPSHOT 1
 
 /** 1: Enable system monitor component */
 #define LV_USE_SYSMON   0
@@ -1379,6 +1398,9 @@
 /** Use GLFW to open window on PC and handle mouse and keyboard. Requires*/
 #define LV_USE_GLFW   0
 
+/** Simulator backend rendering into memory, for benchmarks and CI (`-b HEADLESS`) */
+#define LV_SIM_USE_HEADLESS   1
+
 
 /** QNX Screen display and input drivers */
 #define LV_USE_QNX              0
@@ -0,0 +1,18 @@
+#!/bin/sh
+
+# Build the simulator with 1, 2 and 4 software draw units and time full
+# dashboard frames with each, to see how rendering scales across cores.
+# Extra arguments are passed to lvglsim, e.g. `-b SDL`.
+#
+# usage: scripts/bench_render_threads.sh [lvglsim args...]
+
+set -e
+
+for threads in 1 2 4
+do
+    build_dir="build-rt$threads"
+    cmake -S . -B "$build_dir" -DLV_SIM_RENDER_THREADS="$threads" > /dev/null
+    cmake --build "$build_dir" -j > /dev/null
+    echo "== LV_SIM_RENDER_THREADS=$threads"
+    "$build_dir/bin/lvglsim" -G "$@"
+done
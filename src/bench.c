@@ -0,0 +1,728 @@
+/*
+ * bench.c
+ * Scripted render benchmark: drives the real dashboard through fixed
+ * scenarios with a virtual pointer and a stepped LVGL clock, and reports
+ * frame times, CPU time and memory per scenario.
+ *
+ * Scenarios are queues of pointer actions (press, move, release, wait)
+ * aimed at dashboard objects, so they go through the same event handlers,
+ * animations and redraws as a finger on the kiosk. On the headless backend
+ * (`lvglsim -b HEADLESS -S all`, or the `bench` build target) the numbers
+ * depend only on the machine.
+ */
+
+#include "src/bench.h"
+#include "src/moisture.h"
+#include "src/lib/event_loop.h"
+#include "src/lib/frame_stats.h"
+#include "src/lib/refresh_governor.h"
+#include <dirent.h>
+#include <linux/input.h>
+#include <malloc.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ---------------- Config ---------------- */
+
+#define BENCH_STEP_MS 5            /* LVGL time advanced per loop iteration */
+#define BENCH_PLOTS 20             /* sensors fed by the steady scenario */
+#define BENCH_FEED_PERIOD 200      /* 5 Hz */
+#define BENCH_SETTLE_MS 2000       /* idle time before and after each scenario */
+#define BENCH_TEARDOWN_MS 20000    /* give up restoring the start state after this */
+#define TAP_HOLD_MS 80             /* longer than one indev read period */
+#define TAP_GAP_MS 500             /* lets slides and popups finish animating */
+#define LONG_PRESS_HOLD_MS 800
+#define SLIDER_DRAG_PX 200
+
+/* ---------------- Actions ---------------- */
+
+typedef enum {
+    TARGET_POINT,       /* absolute point */
+    TARGET_OBJ,         /* centre of a dashboard object */
+    TARGET_OBJ_BOTTOM,  /* near the bottom of a slot, clear of its slider */
+    TARGET_SLIDER_KNOB, /* the knob of a slot's threshold slider */
+    TARGET_TEXT,        /* centre of the button labelled `text` */
+} target_kind_t;
+
+typedef enum {
+    ACT_PRESS,   /* press at a target; pressing while pressed moves there */
+    ACT_MOVE,    /* move by `p` over `ms` */
+    ACT_RELEASE,
+    ACT_WAIT,
+    ACT_CALL,
+} act_type_t;
+
+typedef struct {
+    act_type_t type;
+    target_kind_t kind;
+    moisture_obj_t obj;
+    int plot_idx;
+    const char* text;
+    lv_point_t p;
+    uint32_t ms;
+    void (*fn)(void);
+} bench_act_t;
+
+typedef struct {
+    const char* name;
+    bool (*setup)(void);    /* queue actions run before measuring; false on error */
+    void (*cycle)(void);    /* queue one round, called whenever the queue runs dry */
+    bool (*teardown)(void); /* queue a step back to the start state; false when there */
+    uint32_t duration_ms;   /* measured LVGL time; 0 runs until the queue runs dry */
+} bench_scenario_t;
+
+typedef struct {
+    uint32_t frames;
+    double fps;
+    double p50_ms, p90_ms, p99_ms, max_ms;
+    double cpu_ms;
+    long rss_kb;
+    long heap_kb;
+    uint32_t missed;
+} bench_result_t;
+
+/* ---------------- State ---------------- */
+
+static uint32_t virtual_ms = 1000; /* 0 is "never" for the dashboard */
+
+static bench_act_t* acts;
+static size_t act_head, act_count, act_cap;
+static bool act_started;
+static uint32_t act_start_ms;
+static lv_point_t move_from;
+static uint32_t missed_targets;
+
+static lv_point_t pointer_point;
+static bool pointer_pressed;
+
+static bool measuring;
+static uint32_t* samples;
+static size_t sample_count, sample_cap;
+static bool out_of_memory; /* an action or a sample was lost: the run is void */
+
+static lv_timer_t* feed_timer;
+
+static const char* replay_path;
+
+/* ---------------- Clock & Input ---------------- */
+
+static uint32_t bench_tick_cb(void) {
+    return virtual_ms;
+}
+
+static void pointer_read_cb(lv_indev_t* indev, lv_indev_data_t* data) {
+    (void)indev;
+    data->point = pointer_point;
+    data->state = pointer_pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+}
+
+static void frame_cb(const uint32_t* phase_us, uint32_t total_us) {
+    (void)phase_us;
+    if (!measuring) return;
+    if (sample_count == sample_cap) {
+        size_t cap = sample_cap ? sample_cap * 2 : 1024;
+        uint32_t* s = realloc(samples, cap * sizeof(*s));
+        if (!s) {
+            out_of_memory = true;
+            return;
+        }
+        samples = s;
+        sample_cap = cap;
+    }
+    samples[sample_count++] = total_us;
+}
+
+/* ---------------- Action Queue ---------------- */
+
+static void queue_push(const bench_act_t* a) {
+    if (act_head + act_count == act_cap) {
+        size_t cap = act_cap ? act_cap * 2 : 256;
+        bench_act_t* q = realloc(acts, cap * sizeof(*q));
+        if (!q) {
+            out_of_memory = true;
+            return;
+        }
+        acts = q;
+        act_cap = cap;
+    }
+    acts[act_head + act_count++] = *a;
+}
+
+static void queue_clear(void) {
+    act_head = act_count = 0;
+    act_started = false;
+}
+
+static void queue_wait(uint32_t ms) {
+    bench_act_t a = { .type = ACT_WAIT, .ms = ms };
+    queue_push(&a);
+}
+
+static void queue_release(void) {
+    bench_act_t a = { .type = ACT_RELEASE };
+    queue_push(&a);
+}
+
+static void queue_move(int32_t dx, int32_t dy, uint32_t ms) {
+    bench_act_t a = { .type = ACT_MOVE, .p = { dx, dy }, .ms = ms };
+    queue_push(&a);
+}
+
+static void queue_call(void (*fn)(void)) {
+    bench_act_t a = { .type = ACT_CALL, .fn = fn };
+    queue_push(&a);
+}
+
+static void queue_press(target_kind_t kind, moisture_obj_t obj, int plot_idx) {
+    bench_act_t a = { .type = ACT_PRESS, .kind = kind, .obj = obj, .plot_idx = plot_idx };
+    queue_push(&a);
+}
+
+static void queue_press_point(lv_point_t p) {
+    bench_act_t a = { .type = ACT_PRESS, .kind = TARGET_POINT, .p = p };
+    queue_push(&a);
+}
+
+static void queue_tap(target_kind_t kind, moisture_obj_t obj, int plot_idx) {
+    queue_press(kind, obj, plot_idx);
+    queue_wait(TAP_HOLD_MS);
+    queue_release();
+    queue_wait(TAP_GAP_MS);
+}
+
+static void queue_tap_text(const char* text) {
+    bench_act_t a = { .type = ACT_PRESS, .kind = TARGET_TEXT, .text = text };
+    queue_push(&a);
+    queue_wait(TAP_HOLD_MS);
+    queue_release();
+    queue_wait(TAP_GAP_MS);
+}
+
+/* The button whose label reads `text`, searched depth first */
+static lv_obj_t* find_button_by_text(lv_obj_t* parent, const char* text) {
+    uint32_t n = lv_obj_get_child_count(parent);
+    for (uint32_t i = 0; i < n; i++) {
+        lv_obj_t* child = lv_obj_get_child(parent, (int32_t)i);
+        if (lv_obj_has_flag(child, LV_OBJ_FLAG_HIDDEN)) continue;
+        if (lv_obj_check_type(child, &lv_label_class) && strcmp(lv_label_get_text(child), text) == 0) {
+            return parent;
+        }
+        lv_obj_t* found = find_button_by_text(child, text);
+        if (found) return found;
+    }
+    return NULL;
+}
+
+static bool resolve_target(const bench_act_t* a, lv_point_t* out) {
+    if (a->kind == TARGET_POINT) {
+        *out = a->p;
+        return true;
+    }
+
+    lv_obj_t* obj;
+    if (a->kind == TARGET_TEXT) {
+        /* Dialogs live on the top layer */
+        obj = find_button_by_text(lv_layer_top(), a->text);
+        if (!obj) obj = find_button_by_text(lv_screen_active(), a->text);
+    } else {
+        obj = moisture_get_object(a->obj, a->plot_idx);
+    }
+    if (!obj) return false;
+
+    lv_area_t c;
+    lv_obj_get_coords(obj, &c);
+    out->x = (c.x1 + c.x2) / 2;
+    out->y = (c.y1 + c.y2) / 2;
+    if (a->kind == TARGET_OBJ_BOTTOM) {
+        out->y = c.y2 - 40;
+    } else if (a->kind == TARGET_SLIDER_KNOB) {
+        int32_t min = lv_slider_get_min_value(obj);
+        int32_t range = lv_slider_get_max_value(obj) - min;
+        if (range > 0) out->y = c.y2 - (lv_slider_get_value(obj) - min) * lv_area_get_height(&c) / range;
+    }
+    return true;
+}
+
+/* Start, continue or finish the actions due at the current LVGL time */
+static void run_actions(void) {
+    while (act_count > 0) {
+        bench_act_t* a = &acts[act_head];
+
+        if (!act_started) {
+            act_started = true;
+            act_start_ms = virtual_ms;
+            move_from = pointer_point;
+            switch (a->type) {
+                case ACT_PRESS:
+                    if (resolve_target(a, &pointer_point)) pointer_pressed = true;
+                    else missed_targets++;
+                    break;
+                case ACT_RELEASE:
+                    pointer_pressed = false;
+                    break;
+                case ACT_CALL:
+                    a->fn();
+                    a = &acts[act_head]; /* the call may have grown the queue */
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        if (a->type == ACT_MOVE || a->type == ACT_WAIT) {
+            uint32_t elapsed = virtual_ms - act_start_ms;
+            if (a->type == ACT_MOVE) {
+                int32_t t = (int32_t)LV_MIN(elapsed, a->ms);
+                int32_t d = (int32_t)LV_MAX(a->ms, 1);
+                pointer_point.x = move_from.x + a->p.x * t / d;
+                pointer_point.y = move_from.y + a->p.y * t / d;
+            }
+            if (elapsed < a->ms) return;
+        }
+
+        act_head++;
+        act_count--;
+        act_started = false;
+        if (act_count == 0) act_head = 0;
+    }
+}
+
+static void bench_step(void) {
+    run_actions();
+    event_loop_poll_wakeups();
+    frame_stats_timer_handler();
+    virtual_ms += BENCH_STEP_MS;
+}
+
+static void run_for(uint32_t ms) {
+    uint32_t end = virtual_ms + ms;
+    while ((int32_t)(end - virtual_ms) > 0) bench_step();
+}
+
+static void run_until_idle(uint32_t limit_ms) {
+    uint32_t start = virtual_ms;
+    while (act_count > 0 && virtual_ms - start < limit_ms) bench_step();
+}
+
+/* ---------------- Sensor Feed ---------------- */
+
+static void feed_timer_cb(lv_timer_t* t) {
+    (void)t;
+    sensor_reading_t r[BENCH_PLOTS];
+    float phase = lv_tick_get() / 1000.0f;
+    for (int i = 0; i < BENCH_PLOTS; i++) {
+        snprintf(r[i].mac, sizeof(r[i].mac), "BE:NC:00:00:00:%02X", i);
+        /* 57..97 %: above the default threshold, so no D0 command is sent */
+        float pct = 77.0f + 20.0f * sinf(phase + i * 0.7f);
+        r[i].moisture = 3.3f * (1.0f - pct / 100.0f);
+    }
+    moisture_receive_sensor_values(r, BENCH_PLOTS);
+}
+
+/* ---------------- Scenarios ---------------- */
+
+static bool leave_edit_mode(void) {
+    /* The add button is only shown in edit mode */
+    if (!moisture_get_object(MOISTURE_OBJ_ADD_BUTTON, 0)) return false;
+    queue_tap(TARGET_OBJ, MOISTURE_OBJ_EDIT_BUTTON, 0);
+    return true;
+}
+
+/* steady: 20 sensors updating at 5 Hz, no input */
+static bool steady_setup(void) {
+    lv_timer_resume(feed_timer);
+    return true;
+}
+
+static void steady_cycle(void) {
+    queue_wait(1000);
+}
+
+static bool steady_teardown(void) {
+    lv_timer_pause(feed_timer);
+    return false;
+}
+
+/* scroll: page through the carousel with the arrow buttons, back and forth */
+static bool scroll_forward = true;
+
+static void scroll_cycle(void) {
+    moisture_obj_t btn = scroll_forward ? MOISTURE_OBJ_RIGHT_BUTTON : MOISTURE_OBJ_LEFT_BUTTON;
+    if (!moisture_get_object(btn, 0)) {
+        scroll_forward = !scroll_forward;
+        btn = scroll_forward ? MOISTURE_OBJ_RIGHT_BUTTON : MOISTURE_OBJ_LEFT_BUTTON;
+    }
+    queue_tap(TARGET_OBJ, btn, 0);
+}
+
+static bool scroll_teardown(void) {
+    scroll_forward = true;
+    if (!moisture_get_object(MOISTURE_OBJ_LEFT_BUTTON, 0)) return false;
+    queue_tap(TARGET_OBJ, MOISTURE_OBJ_LEFT_BUTTON, 0);
+    return true;
+}
+
+/* slider: drag the first plot's threshold up and down in edit mode */
+static bool slider_setup(void) {
+    queue_tap(TARGET_OBJ, MOISTURE_OBJ_EDIT_BUTTON, 0);
+    return true;
+}
+
+static void slider_cycle(void) {
+    queue_press(TARGET_SLIDER_KNOB, MOISTURE_OBJ_SLIDER, 0);
+    queue_wait(TAP_HOLD_MS);
+    queue_move(0, -SLIDER_DRAG_PX, 400);
+    queue_move(0, SLIDER_DRAG_PX, 400);
+    queue_release();
+    queue_wait(200);
+}
+
+/* popups: open and close every popup and the overview screen in turn */
+static uint32_t popup_stage;
+
+static void cancel_keyboard(void) {
+    lv_obj_t* top = lv_layer_top();
+    uint32_t n = lv_obj_get_child_count(top);
+    for (uint32_t i = 0; i < n; i++) {
+        lv_obj_t* overlay = lv_obj_get_child(top, (int32_t)i);
+        if (lv_obj_has_flag(overlay, LV_OBJ_FLAG_HIDDEN)) continue;
+        uint32_t m = lv_obj_get_child_count(overlay);
+        for (uint32_t j = 0; j < m; j++) {
+            lv_obj_t* kb = lv_obj_get_child(overlay, (int32_t)j);
+            if (lv_obj_check_type(kb, &lv_keyboard_class)) {
+                lv_obj_send_event(kb, LV_EVENT_CANCEL, NULL);
+                return;
+            }
+        }
+    }
+    missed_targets++;
+}
+
+static void popups_cycle(void) {
+    switch (popup_stage++ % 7) {
+        case 0: /* overview screen */
+            queue_tap(TARGET_OBJ, MOISTURE_OBJ_OVERVIEW_BUTTON, 0);
+            queue_tap(TARGET_OBJ, MOISTURE_OBJ_OVERVIEW_BACK, 0);
+            break;
+        case 1: /* plot without a device */
+            queue_tap(TARGET_OBJ_BOTTOM, MOISTURE_OBJ_SLOT, 0);
+            queue_tap_text("OK");
+            break;
+        case 2: /* live debug output of a bench sensor on the next page */
+            queue_tap(TARGET_OBJ, MOISTURE_OBJ_RIGHT_BUTTON, 0);
+            queue_tap(TARGET_OBJ_BOTTOM, MOISTURE_OBJ_SLOT, 4);
+            queue_tap_text("Close");
+            queue_tap(TARGET_OBJ, MOISTURE_OBJ_LEFT_BUTTON, 0);
+            break;
+        case 3: /* flash */
+            queue_tap(TARGET_OBJ, MOISTURE_OBJ_EDIT_BUTTON, 0);
+            queue_tap(TARGET_OBJ, MOISTURE_OBJ_ADD_BUTTON, 0);
+            queue_tap_text("No");
+            break;
+        case 4: /* factory reset */
+            queue_press(TARGET_OBJ, MOISTURE_OBJ_DELETE_BUTTON, 0);
+            queue_wait(LONG_PRESS_HOLD_MS);
+            queue_release();
+            queue_wait(TAP_GAP_MS);
+            queue_tap_text("No");
+            break;
+        case 5: /* delete; the long press may have left delete mode on */
+        {
+            lv_obj_t* del = moisture_get_object(MOISTURE_OBJ_DELETE_BUTTON, 0);
+            if (!del || !lv_obj_has_state(del, LV_STATE_CHECKED)) {
+                queue_tap(TARGET_OBJ, MOISTURE_OBJ_DELETE_BUTTON, 0);
+            }
+        }
+            queue_tap(TARGET_OBJ_BOTTOM, MOISTURE_OBJ_SLOT, 0);
+            queue_tap_text("No");
+            queue_tap(TARGET_OBJ, MOISTURE_OBJ_DELETE_BUTTON, 0);
+            break;
+        default: /* rename, with the on-screen keyboard */
+            queue_tap(TARGET_OBJ, MOISTURE_OBJ_RENAME_BUTTON, 0);
+            queue_tap(TARGET_OBJ_BOTTOM, MOISTURE_OBJ_SLOT, 0);
+            queue_call(cancel_keyboard);
+            queue_wait(TAP_GAP_MS);
+            queue_tap(TARGET_OBJ, MOISTURE_OBJ_RENAME_BUTTON, 0);
+            queue_tap(TARGET_OBJ, MOISTURE_OBJ_EDIT_BUTTON, 0);
+            break;
+    }
+}
+
+static bool popups_teardown(void) {
+    popup_stage = 0;
+    return leave_edit_mode();
+}
+
+/* replay:<file>: a recorded evdev session, at its recorded pace. Raw
+ * coordinates are used as pixels unless LV_SIM_BENCH_REPLAY_RANGE="maxx,maxy"
+ * gives the device range to scale from. */
+static uint64_t event_time_us(const struct input_event* ev) {
+#ifdef input_event_sec
+    return (uint64_t)ev->input_event_sec * 1000000u + (uint64_t)ev->input_event_usec;
+#else
+    return (uint64_t)ev->time.tv_sec * 1000000u + (uint64_t)ev->time.tv_usec;
+#endif
+}
+
+static bool replay_setup(void) {
+    FILE* f = fopen(replay_path, "rb");
+    if (!f) {
+        fprintf(stderr, "bench: cannot open %s\n", replay_path);
+        return false;
+    }
+
+    int32_t range_x = 0, range_y = 0;
+    const char* range = getenv("LV_SIM_BENCH_REPLAY_RANGE");
+    if (range && sscanf(range, "%d,%d", &range_x, &range_y) != 2) range_x = range_y = 0;
+    lv_display_t* disp = lv_display_get_default();
+    int32_t hor = lv_display_get_horizontal_resolution(disp);
+    int32_t ver = lv_display_get_vertical_resolution(disp);
+
+    struct input_event ev;
+    int32_t x = 0, y = 0;
+    bool down = false, was_down = false, first = true;
+    uint64_t last_us = 0;
+    size_t reports = 0;
+
+    while (fread(&ev, sizeof(ev), 1, f) == 1) {
+        if (ev.type == EV_ABS) {
+            if (ev.code == ABS_X || ev.code == ABS_MT_POSITION_X) x = ev.value;
+            else if (ev.code == ABS_Y || ev.code == ABS_MT_POSITION_Y) y = ev.value;
+        } else if (ev.type == EV_KEY && (ev.code == BTN_TOUCH || ev.code == BTN_LEFT)) {
+            down = ev.value != 0;
+        } else if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+            uint64_t us = event_time_us(&ev);
+            if (!first && us > last_us && (us - last_us) >= 1000) queue_wait((uint32_t)((us - last_us) / 1000));
+            first = false;
+            last_us = us;
+
+            lv_point_t p = { x, y };
+            if (range_x > 0 && range_y > 0) {
+                p.x = x * hor / (range_x + 1);
+                p.y = y * ver / (range_y + 1);
+            }
+            if (down) queue_press_point(p); /* a press while pressed is a move */
+            else if (was_down) queue_release();
+            was_down = down;
+            reports++;
+        }
+    }
+    fclose(f);
+
+    if (was_down) queue_release();
+    if (reports == 0) {
+        fprintf(stderr, "bench: no input events in %s\n", replay_path);
+        return false;
+    }
+    return true;
+}
+
+static const bench_scenario_t scenarios[] = {
+    { "steady", steady_setup, steady_cycle, steady_teardown, 10000 },
+    { "scroll", NULL, scroll_cycle, scroll_teardown, 10000 },
+    { "slider", slider_setup, slider_cycle, leave_edit_mode, 10000 },
+    { "popups", NULL, popups_cycle, popups_teardown, 20000 },
+};
+
+static const bench_scenario_t replay_scenario = { "replay", replay_setup, NULL, leave_edit_mode, 0 };
+
+/* ---------------- Measurement ---------------- */
+
+static uint64_t cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static long rss_kb(void) {
+    long size = 0, resident = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    if (fscanf(f, "%ld %ld", &size, &resident) != 2) resident = 0;
+    fclose(f);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static long heap_kb(void) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 mi = mallinfo2();
+    return (long)(mi.uordblks / 1024);
+#else
+    return 0;
+#endif
+}
+
+static int cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_ms(double q) {
+    if (sample_count == 0) return 0.0;
+    size_t i = (size_t)(q * (double)(sample_count - 1) + 0.5);
+    return samples[LV_MIN(i, sample_count - 1)] / 1000.0;
+}
+
+static bool run_scenario(const bench_scenario_t* sc, bench_result_t* res) {
+    memset(res, 0, sizeof(*res));
+    queue_clear();
+    missed_targets = 0;
+    out_of_memory = false;
+
+    if (sc->setup && !sc->setup()) return false;
+    run_until_idle(BENCH_TEARDOWN_MS);
+    run_for(BENCH_SETTLE_MS);
+
+    /* Measured part */
+    sample_count = 0;
+    measuring = true;
+    uint64_t cpu_start = cpu_ns();
+    uint32_t start = virtual_ms;
+    while (!out_of_memory && (sc->duration_ms == 0 || virtual_ms - start < sc->duration_ms)) {
+        if (act_count == 0) {
+            if (!sc->cycle) break;
+            sc->cycle();
+        }
+        bench_step();
+    }
+    uint32_t elapsed = virtual_ms - start;
+    res->cpu_ms = (double)(cpu_ns() - cpu_start) / 1e6;
+    measuring = false;
+    bool complete = !out_of_memory;
+
+    qsort(samples, sample_count, sizeof(samples[0]), cmp_u32);
+    res->frames = (uint32_t)sample_count;
+    res->fps = elapsed ? (double)sample_count * 1000.0 / elapsed : 0.0;
+    res->p50_ms = percentile_ms(0.50);
+    res->p90_ms = percentile_ms(0.90);
+    res->p99_ms = percentile_ms(0.99);
+    res->max_ms = percentile_ms(1.0);
+    res->rss_kb = rss_kb();
+    res->heap_kb = heap_kb();
+    res->missed = missed_targets;
+
+    /* Back to the start state for the next scenario */
+    queue_clear();
+    if (pointer_pressed) {
+        queue_release();
+        queue_wait(TAP_GAP_MS);
+    }
+    uint32_t teardown_start = virtual_ms;
+    do {
+        run_until_idle(BENCH_TEARDOWN_MS);
+    } while (sc->teardown && virtual_ms - teardown_start < BENCH_TEARDOWN_MS && sc->teardown());
+    run_until_idle(BENCH_TEARDOWN_MS);
+    run_for(BENCH_SETTLE_MS);
+
+    if (!complete) {
+        fprintf(stderr, "bench: %s: out of memory, results discarded\n", sc->name);
+        return false;
+    }
+    return true;
+}
+
+static void print_result(const char* name, const bench_result_t* r, FILE* csv) {
+    fprintf(stdout, "%-10s %7u %6.1f %7.2f %7.2f %7.2f %7.2f %8.0f %8ld %8ld",
+            name, (unsigned)r->frames, r->fps, r->p50_ms, r->p90_ms, r->p99_ms, r->max_ms,
+            r->cpu_ms, r->rss_kb, r->heap_kb);
+    if (r->missed) fprintf(stdout, "  (%u targets not found)", (unsigned)r->missed);
+    fprintf(stdout, "\n");
+    if (csv) {
+        fprintf(csv, "%s,%u,%.2f,%.3f,%.3f,%.3f,%.3f,%.1f,%ld,%ld,%u\n",
+                name, (unsigned)r->frames, r->fps, r->p50_ms, r->p90_ms, r->p99_ms, r->max_ms,
+                r->cpu_ms, r->rss_kb, r->heap_kb, (unsigned)r->missed);
+    }
+}
+
+/* ---------------- Public API ---------------- */
+
+static void remove_dir(const char* path) {
+    DIR* d = opendir(path);
+    if (d) {
+        struct dirent* e;
+        char file[512];
+        while ((e = readdir(d)) != NULL) {
+            if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+            snprintf(file, sizeof(file), "%s/%s", path, e->d_name);
+            unlink(file);
+        }
+        closedir(d);
+    }
+    rmdir(path);
+}
+
+int bench_run(const char* names) {
+    /* Keep the user's saved plots out of it: the dashboard persists under $HOME */
+    char home[] = "/tmp/lvglsim-bench-XXXXXX";
+    if (!mkdtemp(home)) {
+        perror("bench: mkdtemp");
+        return 1;
+    }
+    setenv("HOME", home, 1);
+
+    /* Scenarios idle between inputs, which must not lower the frame rate */
+    refresh_governor_set_enabled(false);
+    lv_tick_set_cb(bench_tick_cb);
+    lv_indev_t* pointer = lv_indev_create();
+    lv_indev_set_type(pointer, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_read_cb(pointer, pointer_read_cb);
+    frame_stats_set_frame_cb(frame_cb);
+
+    ui_moisture_dashboard_absolute();
+
+    /* Register the bench sensors once, then feed them only in "steady" */
+    feed_timer = lv_timer_create(feed_timer_cb, BENCH_FEED_PERIOD, NULL);
+    feed_timer_cb(feed_timer);
+    lv_timer_pause(feed_timer);
+    run_for(BENCH_SETTLE_MS);
+
+    FILE* csv = NULL;
+    const char* csv_path = getenv("LV_SIM_BENCH_CSV");
+    if (csv_path) csv = fopen(csv_path, "a");
+
+    lv_display_t* disp = lv_display_get_default();
+    fprintf(stdout, "Dashboard benchmark, %dx%d, %d ms steps\n",
+            (int)lv_display_get_horizontal_resolution(disp),
+            (int)lv_display_get_vertical_resolution(disp), BENCH_STEP_MS);
+    fprintf(stdout, "%-10s %7s %6s %7s %7s %7s %7s %8s %8s %8s\n",
+            "scenario", "frames", "fps", "p50 ms", "p90 ms", "p99 ms", "max ms", "cpu ms", "rss KB", "heap KB");
+
+    char* list = strdup(strcmp(names, "all") == 0 ? "steady,scroll,slider,popups" : names);
+    char* save = NULL;
+    int rc = 0;
+    for (char* name = strtok_r(list, ",", &save); name; name = strtok_r(NULL, ",", &save)) {
+        const bench_scenario_t* sc = NULL;
+        if (strncmp(name, "replay:", 7) == 0) {
+            replay_path = name + 7;
+            sc = &replay_scenario;
+        }
+        for (size_t i = 0; !sc && i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+            if (strcmp(name, scenarios[i].name) == 0) sc = &scenarios[i];
+        }
+        if (!sc) {
+            fprintf(stderr, "bench: unknown scenario '%s'\n", name);
+            rc = 1;
+            continue;
+        }
+
+        bench_result_t res;
+        if (!run_scenario(sc, &res)) {
+            rc = 1;
+            continue;
+        }
+        print_result(sc->name, &res, csv);
+    }
+
+    free(list);
+    free(samples);
+    free(acts);
+    if (csv) fclose(csv);
+    frame_stats_set_frame_cb(NULL);
+    refresh_governor_set_enabled(true);
+    remove_dir(home);
+    return rc;
+}
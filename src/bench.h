@@ -0,0 +1,25 @@
+#pragma once
+/* bench.h */
+#ifndef BENCH_H
+#define BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lvgl/lvgl.h"
+
+/* Create the dashboard on the current display and drive it through the
+ * scripted scenarios in `names`: "all" or a comma separated list of
+ * steady, scroll, slider, popups and replay:<file>, where <file> is a
+ * recorded evdev session (`cat /dev/input/eventN > file`). LVGL time is
+ * stepped, not slept, and every scenario prints one result row with FPS,
+ * frame time percentiles, CPU time and memory. Returns 0 on success.
+ */
+int bench_run(const char *names);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* BENCH_H */
@@ -1,14 +1,23 @@
 /*
  * flash.c
- * Clean implementation of the flasher thread:
- * - find a serial device (ttyACM* / ttyUSB*)
- * - optionally copy the sketch and inject config.h from env vars
- * - run arduino-cli upload and stream output to the UI via
- *   `moisture_flash_status_update()`
- * - after upload re-scan /dev to find the serial node and wait for a
- *   registration line containing a MAC address (aa:bb:cc:dd:ee:ff)
- * - call `moisture_add_plot_for_sensor(mac)` on success, or with NULL
+ * Flashing orchestrator for a tray of sensors:
+ * - find every serial device (ttyACM* / ttyUSB*)
+ * - compile the sketch once with arduino-cli (or reuse a cached build)
+ * - patch FLASH_SSID / FLASH_PASS / FLASH_TARGET_IP / FLASH_CONTROL_PIN
+ *   into the image's config block (fw_patch.c)
+ * - upload to the devices in parallel on a fixed pool of FLASH_WORKERS
+ *   worker threads (default 4). The status text shows the tray's counts
+ *   and failures; tool output and per-device notes go to the flash log
+ *   with the device name in front
+ * - after each upload follow the board through its reset by USB identity
+ *   (hotplug events, uevent.c) and wait for a registration line containing
+ *   a MAC address (aa:bb:cc:dd:ee:ff)
+ * - call `moisture_request_plot_for_sensor(mac)` on success, or with NULL
  *   to add an unassigned plot on failure.
+ *
+ * The coordinator and the workers are started on the first request and
+ * live for the rest of the process; a request only wakes the coordinator.
+ * The status text a batch ends with is cleared STATUS_HOLD_SEC later.
  */
 
 #include "flash.h"
@@ -23,14 +32,65 @@
 #include <sys/stat.h>
 #include <pthread.h>
 #include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <stdint.h>
 
 #include "src/moisture.h"
+#include "src/fw_patch.h"
+#include "src/uevent.h"
 
 #define FIRMWARE_PATH "firmware/plant_sensor"
+#define SKETCH_NAME "plant_sensor"
 #define FQBN_ENV_VAR "FLASH_FQBN"
 #define DEFAULT_FQBN "arduino:samd:nano_33_iot"
+#define WORKERS_ENV_VAR "FLASH_WORKERS"
+#define DEFAULT_WORKERS 4
+#define MAX_WORKERS 16
+#define MAX_DEVICES 64
 #define SERIAL_WAIT_SEC 60
+#define REAPPEAR_WAIT_SEC 15 /* the port drops out while the board resets */
+#define STATUS_HOLD_SEC 10 /* how long the closing status stays up */
 
+typedef enum {
+    DEV_QUEUED,
+    DEV_UPLOADING,
+    DEV_REGISTERING,
+    DEV_DONE,
+    DEV_FAILED
+} dev_state_t;
+
+typedef struct {
+    char path[64];
+    const char *name; /* path without /dev/ */
+    dev_state_t state;
+    uevent_tty_t usb; /* identity to follow across re-enumeration */
+    int have_usb;
+} flash_dev_t;
+
+/* Everything below is protected by pool_mutex. */
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t request_cond = PTHREAD_COND_INITIALIZER; /* coordinator: request or job finished */
+static pthread_cond_t job_cond = PTHREAD_COND_INITIALIZER;     /* workers: job queued */
+static int pool_started = 0;
+static int request_pending = 0;
+static int batch_running = 0;
+static flash_dev_t devices[MAX_DEVICES];
+static int device_count = 0;
+static int jobs_queued = 0;   /* devices handed out so far may not exceed this */
+static int next_job = 0;
+static int jobs_finished = 0;
+
+/* Batch settings, written by the coordinator before jobs are queued */
+static const char *batch_cli = NULL;   /* NULL: no upload */
+static const char *batch_fqbn = NULL;
+static char batch_sketch[512];
+static char batch_build[512];
+static char batch_image[600];   /* configured copy of the built image */
+
+/* Raw 115200 8N1 for reading. With VMIN = 0 and VTIME = 1 a read returns
+ * whatever has arrived at once, or 0 after 100 ms if nothing has; poll()
+ * does the waiting. */
 static int open_serial_rd(const char *path)
 {
     int fd = open(path, O_RDONLY | O_NOCTTY);
@@ -41,6 +101,8 @@ static int open_serial_rd(const char *path)
     cfsetispeed(&tty, B115200);
     cfsetospeed(&tty, B115200);
     tty.c_cflag |= (CLOCAL | CREAD);
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 1;
     tcsetattr(fd, TCSANOW, &tty);
     return fd;
 }
@@ -66,126 +128,581 @@ static int extract_mac_from_string(const char *s, char *out, size_t out_len)
     return -1;
 }
 
-static int wait_for_registration_on_serial(const char *devpath, int timeout_sec, char *out_mac, size_t out_mac_len)
+static void dev_status(const flash_dev_t *dev, const char *msg);
+
+static int64_t now_ms(void)
+{
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Split serial input into lines and look for a MAC in each */
+typedef struct {
+    char buf[256];
+    size_t len;
+} line_asm_t;
+
+/* Returns 0 with the MAC in `out_mac` as soon as a line holding one is
+ * complete, -1 if the data so far has none. */
+static int line_asm_feed(line_asm_t *la, const char *data, size_t n, char *out_mac, size_t out_mac_len)
+{
+    for (size_t i = 0; i < n; ++i) {
+        char c = data[i];
+        if (c == '\n' || c == '\r') {
+            la->buf[la->len] = '\0';
+            if (la->len > 0 && extract_mac_from_string(la->buf, out_mac, out_mac_len) == 0) return 0;
+            la->len = 0;
+            continue;
+        }
+        la->buf[la->len++] = c;
+        if (la->len == sizeof(la->buf) - 1) {
+            /* Overlong line: check it, then keep a tail in case a MAC straddles the cut */
+            la->buf[la->len] = '\0';
+            if (extract_mac_from_string(la->buf, out_mac, out_mac_len) == 0) return 0;
+            memmove(la->buf, la->buf + la->len - 16, 16);
+            la->len = 16;
+        }
+    }
+    return -1;
+}
+
+static int wait_for_registration_on_serial(const flash_dev_t *dev, int timeout_sec, char *out_mac, size_t out_mac_len)
 {
-    int fd = open_serial_rd(devpath);
+    int fd = open_serial_rd(dev->path);
     if (fd < 0) return -1;
-    int flags = fcntl(fd, F_GETFL, 0);
-    if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
 
-    char buf[256]; int pos = 0; int ticks = 0;
-    while (ticks < timeout_sec * 10) {
-        usleep(100000); ++ticks;
-        ssize_t r = read(fd, buf + pos, 1);
+    line_asm_t la = { .len = 0 };
+    int64_t deadline = now_ms() + (int64_t)timeout_sec * 1000;
+    int64_t next_note = now_ms() + 10000;
+    int rc = -1;
+    for (;;) {
+        int64_t now = now_ms();
+        if (now >= deadline) break;
+        if (now >= next_note) { dev_status(dev, "waiting for serial registration..."); next_note = now + 10000; }
+        int64_t wait = (deadline < next_note ? deadline : next_note) - now;
+
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        int pr = poll(&pfd, 1, (int)wait);
+        if (pr < 0) {
+            if (errno == EINTR) continue;
+            char eb[128]; snprintf(eb, sizeof(eb), "serial poll error: %s", strerror(errno)); dev_status(dev, eb); break;
+        }
+        if (pr == 0) continue;
+        if (pfd.revents & (POLLERR | POLLNVAL)) { dev_status(dev, "serial port error"); break; }
+
+        char chunk[512];
+        ssize_t r = read(fd, chunk, sizeof(chunk));
         if (r > 0) {
-            if (buf[pos] == '\n' || buf[pos] == '\r') {
-                buf[pos] = '\0';
-                if (extract_mac_from_string(buf, out_mac, out_mac_len) == 0) { close(fd); return 0; }
-                pos = 0;
-            } else {
-                ++pos; if (pos >= (int)sizeof(buf)-1) pos = 0;
-            }
-        } else if (r == -1) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) { if ((ticks % 10) == 0) moisture_flash_status_update("Waiting for serial registration..."); continue; }
-            else { char eb[128]; snprintf(eb, sizeof(eb), "Serial read error: %s", strerror(errno)); moisture_flash_status_update(eb); break; }
+            if (line_asm_feed(&la, chunk, (size_t)r, out_mac, out_mac_len) == 0) { rc = 0; break; }
+        } else if (r < 0 && errno != EINTR && errno != EAGAIN) {
+            char eb[128]; snprintf(eb, sizeof(eb), "serial read error: %s", strerror(errno)); dev_status(dev, eb); break;
+        } else if (r == 0 && (pfd.revents & POLLHUP)) {
+            dev_status(dev, "serial port closed"); break;
         }
     }
-    close(fd); return -1;
+    close(fd); return rc;
 }
 
-static int find_first_serial(char *out_path, size_t out_len)
+
+static int compare_devices(const void *a, const void *b)
 {
-    DIR *d = opendir("/dev"); if (!d) return -1;
-    struct dirent *ent; int found = 0;
-    while ((ent = readdir(d)) != NULL) {
-        if (strncmp(ent->d_name, "ttyACM", 6) == 0 || strncmp(ent->d_name, "ttyUSB", 6) == 0) { snprintf(out_path, out_len, "/dev/%s", ent->d_name); found = 1; break; }
+    return strcmp(((const flash_dev_t *)a)->path, ((const flash_dev_t *)b)->path);
+}
+
+/* Fill devices[] with every USB serial node, in name order */
+static int find_all_serial(void)
+{
+    DIR *d = opendir("/dev"); if (!d) return 0;
+    struct dirent *ent; int n = 0;
+    while ((ent = readdir(d)) != NULL && n < MAX_DEVICES) {
+        if (strncmp(ent->d_name, "ttyACM", 6) != 0 && strncmp(ent->d_name, "ttyUSB", 6) != 0) continue;
+        flash_dev_t *dev = &devices[n];
+        int len = snprintf(dev->path, sizeof(dev->path), "/dev/%s", ent->d_name);
+        if (len < 0 || (size_t)len >= sizeof(dev->path)) continue; /* never open a truncated path */
+        dev->state = DEV_QUEUED;
+        n++;
+    }
+    closedir(d);
+    qsort(devices, n, sizeof(devices[0]), compare_devices);
+    for (int i = 0; i < n; ++i) {
+        devices[i].name = devices[i].path + 5;
+        devices[i].have_usb = uevent_tty_info(devices[i].name, &devices[i].usb) == 0;
     }
-    closedir(d); return found ? 0 : -1;
+    return n;
 }
 
-static void *flash_thread_fn(void *arg)
+/* Log "<device>: <msg>". The status text only changes with a device's
+ * state (post_summary), so workers don't take turns on it. */
+static void dev_status(const flash_dev_t *dev, const char *msg)
 {
-    (void)arg;
-    FILE *m = fopen("/tmp/flash_thread_started", "a"); if (m) { fprintf(m, "flash thread started\n"); fclose(m); }
-
-    moisture_flash_status_update("Searching for serial device...");
-    char devpath[256] = {0}; if (find_first_serial(devpath, sizeof(devpath)) != 0) { moisture_flash_status_update("No serial device found"); moisture_add_plot_for_sensor(NULL); return NULL; }
-
-    const char *env_ssid = getenv("FLASH_SSID"); const char *env_pass = getenv("FLASH_PASS"); const char *env_target = getenv("FLASH_TARGET_IP"); const char *env_ctrl = getenv("FLASH_CONTROL_PIN");
-    char use_path[512]; strncpy(use_path, FIRMWARE_PATH, sizeof(use_path)); use_path[sizeof(use_path)-1] = '\0'; int created_tmp = 0; char tmpdir[512];
-    if (env_ssid || env_pass || env_target) {
-        snprintf(tmpdir, sizeof(tmpdir), "/tmp/plant_sensor_%d", (int)getpid()); mkdir(tmpdir, 0755);
-        char src[512], dst[512]; snprintf(src, sizeof(src), "%s/plant_sensor.ino", FIRMWARE_PATH); snprintf(dst, sizeof(dst), "%s/plant_sensor.ino", tmpdir);
-        FILE *fr = fopen(src, "rb"); if (fr) {
-            FILE *fw = fopen(dst, "wb"); if (fw) { char dbuf[4096]; size_t n; while ((n = fread(dbuf,1,sizeof(dbuf),fr))>0) fwrite(dbuf,1,n,fw); fclose(fw); }
-            fclose(fr);
-            snprintf(dst, sizeof(dst), "%s/config.h", tmpdir);
-            FILE *fc = fopen(dst, "wb");
-            if (fc) {
-                if (env_ssid) fprintf(fc, "#define WIFI_SSID \"%s\"\n", env_ssid);
-                if (env_pass) fprintf(fc, "#define WIFI_PASS \"%s\"\n", env_pass);
-                if (env_target) fprintf(fc, "#define TARGET_IP \"%s\"\n", env_target);
-                /* Ensure control pin default is D2 unless overridden */
-                if (env_ctrl) fprintf(fc, "#define CONTROL_PIN %s\n", env_ctrl);
-                else fprintf(fc, "#define CONTROL_PIN 2\n");
-                fclose(fc);
-                strncpy(use_path, tmpdir, sizeof(use_path)); created_tmp = 1;
-            }
+    char line[256];
+    size_t l = strlen(msg);
+    while (l > 0 && (msg[l-1] == '\n' || msg[l-1] == '\r')) --l; /* tool output keeps its newline */
+    snprintf(line, sizeof(line), "%s: %.*s", dev->name, (int)l, msg);
+    moisture_flash_log(line);
+}
+
+/* Post "Flashing: 3/8 done, 2 uploading, 1 registering, 1 failed (ttyACM2)" */
+static void post_summary(void)
+{
+    int count[DEV_FAILED + 1] = {0};
+    char failed[48] = ""; size_t fl = 0; int more = 0;
+    pthread_mutex_lock(&pool_mutex);
+    int total = device_count;
+    for (int i = 0; i < total; ++i) {
+        count[devices[i].state]++;
+        if (devices[i].state != DEV_FAILED) continue;
+        size_t need = strlen(devices[i].name) + (fl ? 2 : 0);
+        if (more || fl + need + 4 >= sizeof(failed)) { more = 1; continue; } /* room for ", ..." */
+        fl += (size_t)snprintf(failed + fl, sizeof(failed) - fl, "%s%s", fl ? ", " : "", devices[i].name);
+    }
+    pthread_mutex_unlock(&pool_mutex);
+
+    char line[256];
+    int l = snprintf(line, sizeof(line), "%s: %d/%d done", batch_cli ? "Flashing" : "Registering", count[DEV_DONE], total);
+    if (count[DEV_UPLOADING]) l += snprintf(line + l, sizeof(line) - (size_t)l, ", %d uploading", count[DEV_UPLOADING]);
+    if (count[DEV_REGISTERING]) l += snprintf(line + l, sizeof(line) - (size_t)l, ", %d registering", count[DEV_REGISTERING]);
+    if (count[DEV_FAILED]) snprintf(line + l, sizeof(line) - (size_t)l, ", %d failed (%s%s)", count[DEV_FAILED], failed, more ? ", ..." : "");
+    moisture_flash_status_update(line);
+}
+
+static void set_state(flash_dev_t *dev, dev_state_t state)
+{
+    pthread_mutex_lock(&pool_mutex);
+    dev->state = state;
+    pthread_mutex_unlock(&pool_mutex);
+    post_summary();
+}
+
+/* The sketch is compiled in place; the temporary directory holds the
+ * build when there is no cache and the configured image. */
+static void prepare_tmpdir(char *tmpdir, size_t tmpdir_len)
+{
+    snprintf(tmpdir, tmpdir_len, "/tmp/plant_sensor_%d", (int)getpid());
+    mkdir(tmpdir, 0755);
+    snprintf(batch_sketch, sizeof(batch_sketch), "%s", FIRMWARE_PATH);
+    snprintf(batch_build, sizeof(batch_build), "%s/build", tmpdir);
+}
+
+/* Write the FLASH_* settings into a copy of the compiled image. The
+ * settings are the same for the whole tray, so one copy serves every
+ * device. */
+static int patch_image(const char *tmpdir)
+{
+    const char *env_ctrl = getenv("FLASH_CONTROL_PIN");
+    fw_patch_config_t cfg = { getenv("FLASH_SSID"), getenv("FLASH_PASS"), getenv("FLASH_TARGET_IP"), env_ctrl ? atoi(env_ctrl) : -1 };
+    char src[600]; snprintf(src, sizeof(src), "%s/%s.ino.bin", batch_build, SKETCH_NAME);
+    snprintf(batch_image, sizeof(batch_image), "%s/%s.bin", tmpdir, SKETCH_NAME);
+    int rc = fw_patch_file(src, batch_image, &cfg);
+    if (rc == FW_PATCH_OK) return 0;
+    char eb[128];
+    snprintf(eb, sizeof(eb), "Could not configure the firmware image: %s", rc == FW_PATCH_NO_BLOCK ? "no config block" : rc == FW_PATCH_TOO_LONG ? "setting too long" : "I/O error");
+    moisture_flash_status_update(eb);
+    return -1;
+}
+
+static void remove_tree(const char *path)
+{
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", path);
+    if (system(cmd) != 0) moisture_flash_status_update("Could not remove the temporary flash directory");
+}
+
+/* ---- Build cache ----
+ * Compiled binaries are kept under $XDG_CACHE_HOME/plant_sensor (or
+ * ~/.cache/plant_sensor) in a directory named after a hash of everything
+ * that goes into them: every file under the sketch directory (names and
+ * contents, subdirectories included), the FQBN, the arduino-cli version and
+ * the ID and installed version of each core. WiFi settings are patched in
+ * after the build, so a repeat flash normally uploads the cached binary
+ * without compiling. Object files are kept in one build path per FQBN, so a
+ * changed sketch rebuilds only itself.
+ */
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+#define SKETCH_MAX_DEPTH 4
+
+static uint64_t fnv1a(uint64_t h, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; ++i) { h ^= p[i]; h *= FNV_PRIME; }
+    return h;
+}
+
+static int hash_stream(uint64_t *h, FILE *f)
+{
+    char buf[4096]; size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) *h = fnv1a(*h, buf, n);
+    return ferror(f) ? -1 : 0;
+}
+
+static int compare_names(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/* Hash the names and contents of the files under `dir`, in name order,
+ * descending into subdirectories (arduino-cli compiles src/ too). `rel` is
+ * the path below the sketch directory, hashed in place of the bare name so
+ * that moving a file changes the key. */
+static int hash_sketch_dir(uint64_t *h, const char *dir, const char *rel, int depth)
+{
+    if (depth > SKETCH_MAX_DEPTH) return -1;
+    DIR *d = opendir(dir); if (!d) return -1;
+    char **names = NULL; size_t n = 0, cap = 0; struct dirent *ent; int rc = 0;
+    while ((ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        if (n == cap) {
+            size_t ncap = cap ? cap * 2 : 16;
+            char **grown = realloc(names, ncap * sizeof(*names));
+            if (!grown) { rc = -1; break; }
+            names = grown; cap = ncap;
         }
+        if (!(names[n] = strdup(ent->d_name))) { rc = -1; break; }
+        n++;
     }
+    closedir(d);
+    if (n) qsort(names, n, sizeof(names[0]), compare_names);
 
-    const char *arduino_cli = NULL; if (access("/usr/local/bin/arduino-cli", X_OK) == 0) arduino_cli = "/usr/local/bin/arduino-cli"; else if (access("/usr/bin/arduino-cli", X_OK) == 0) arduino_cli = "/usr/bin/arduino-cli";
-    if (arduino_cli) {
-        const char *fqbn = getenv(FQBN_ENV_VAR); if (!fqbn) fqbn = DEFAULT_FQBN;
-
-        char compile_cmd[2048];
-        snprintf(compile_cmd, sizeof(compile_cmd), "%s compile --fqbn %s %s 2>&1", arduino_cli, fqbn, use_path);
-        moisture_flash_status_update("Compiling sketch...");
-        FILE *pc = popen(compile_cmd, "r");
-        int compile_ok = 0;
-        if (pc) {
-            char line[512];
-            while (fgets(line, sizeof(line), pc)) moisture_flash_status_update(line);
-            int rc = pclose(pc);
-            if (rc == 0) compile_ok = 1;
-            else {
-                char eb[128]; snprintf(eb, sizeof(eb), "Compile failed (rc=%d)", rc); moisture_flash_status_update(eb);
-            }
-        } else {
-            moisture_flash_status_update("Failed to run arduino-cli compile");
+    for (size_t i = 0; i < n; ++i) {
+        char path[768], sub[256]; struct stat st;
+        int pl = snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+        int sl = snprintf(sub, sizeof(sub), "%s%s%s", rel, rel[0] ? "/" : "", names[i]);
+        if (rc != 0 || pl < 0 || (size_t)pl >= sizeof(path) || sl < 0 || (size_t)sl >= sizeof(sub)) rc = -1;
+        else if (stat(path, &st) != 0) rc = -1;
+        else if (S_ISDIR(st.st_mode)) {
+            *h = fnv1a(*h, sub, strlen(sub) + 1);
+            if (hash_sketch_dir(h, path, sub, depth + 1) != 0) rc = -1;
+        } else if (S_ISREG(st.st_mode)) {
+            FILE *f = fopen(path, "rb");
+            if (!f || hash_stream(h, f) != 0) rc = -1;
+            if (f) fclose(f);
+            *h = fnv1a(*h, sub, strlen(sub) + 1);
         }
+        free(names[i]);
+    }
+    free(names);
+    return rc;
+}
+
+/* Hash the first `columns` whitespace-separated fields of each line a
+ * command prints; the toolchain reports its versions this way. Later
+ * columns are left out: `core list` ends with the latest available version
+ * and the name, which change with the package index, not the install. */
+static int hash_command(uint64_t *h, const char *cmd, int columns)
+{
+    FILE *p = popen(cmd, "r"); if (!p) return -1;
+    char line[512];
+    while (fgets(line, sizeof(line), p)) {
+        char *save = NULL;
+        int c = 0;
+        for (char *tok = strtok_r(line, " \t\r\n", &save); tok && c < columns; tok = strtok_r(NULL, " \t\r\n", &save), ++c)
+            *h = fnv1a(*h, tok, strlen(tok) + 1);
+        *h = fnv1a(*h, "\n", 1);
+    }
+    int rc = ferror(p) ? -1 : 0;
+    return (pclose(p) == 0) ? rc : -1;
+}
+
+static int mkdir_p(const char *path)
+{
+    char tmp[512];
+    int len = snprintf(tmp, sizeof(tmp), "%s", path);
+    if (len < 0 || (size_t)len >= sizeof(tmp)) return -1;
+    for (char *p = tmp + 1; *p; ++p) {
+        if (*p != '/') continue;
+        *p = '\0'; mkdir(tmp, 0755); *p = '/';
+    }
+    return (mkdir(tmp, 0755) == 0 || errno == EEXIST) ? 0 : -1;
+}
+
+static int cache_root(char *out, size_t out_len)
+{
+    const char *xdg = getenv("XDG_CACHE_HOME"); const char *home = getenv("HOME");
+    int len;
+    if (xdg && xdg[0]) len = snprintf(out, out_len, "%s/plant_sensor", xdg);
+    else if (home && home[0]) len = snprintf(out, out_len, "%s/.cache/plant_sensor", home);
+    else return -1;
+    if (len < 0 || (size_t)len >= out_len) return -1;
+    return mkdir_p(out);
+}
+
+/* Point batch_build at the cache entry for the current sketch. Returns 1 if
+ * it already holds a build, 0 if it must be compiled, -1 if there's no
+ * cache, in which case batch_build (the temporary directory) is kept and
+ * build_path is left empty. */
+static int lookup_build_cache(char *build_path, size_t build_path_len)
+{
+    char root[sizeof(batch_build) - 32], cmd[600];
+    build_path[0] = '\0';
+    if (cache_root(root, sizeof(root)) != 0) return -1;
+
+    uint64_t h = FNV_OFFSET;
+    if (hash_sketch_dir(&h, batch_sketch, "", 0) != 0) return -1;
+    h = fnv1a(h, batch_fqbn, strlen(batch_fqbn) + 1);
+    snprintf(cmd, sizeof(cmd), "%s version 2>/dev/null", batch_cli);
+    if (hash_command(&h, cmd, 3) != 0) return -1; /* "arduino-cli Version: x.y.z" */
+    snprintf(cmd, sizeof(cmd), "%s core list 2>/dev/null", batch_cli);
+    if (hash_command(&h, cmd, 2) != 0) return -1; /* ID, Installed */
+
+    /* root leaves room for "/build-" or "/" plus 16 hex digits */
+    uint64_t fqbn_h = fnv1a(FNV_OFFSET, batch_fqbn, strlen(batch_fqbn));
+    int bl = snprintf(build_path, build_path_len, "%s/build-%016llx", root, (unsigned long long)fqbn_h);
+    if (bl < 0 || (size_t)bl >= build_path_len) { build_path[0] = '\0'; return -1; }
+    snprintf(batch_build, sizeof(batch_build), "%s/%016llx", root, (unsigned long long)h);
+
+    /* The marker is written last, so an interrupted compile is not a hit */
+    char marker[sizeof(batch_build) + 16]; snprintf(marker, sizeof(marker), "%s/.complete", batch_build);
+    return (access(marker, F_OK) == 0) ? 1 : 0;
+}
+
+/* Compile once into batch_build; every upload reuses the binary */
+static int compile_sketch(void)
+{
+    char build_path[512];
+    int cached = lookup_build_cache(build_path, sizeof(build_path));
+    if (cached == 1) {
+        char msg[600]; snprintf(msg, sizeof(msg), "Using cached build %s", batch_build); moisture_flash_status_update(msg);
+        return 0;
+    }
+
+    char compile_cmd[2048];
+    if (build_path[0]) snprintf(compile_cmd, sizeof(compile_cmd), "%s compile --fqbn %s --build-path %s --output-dir %s %s 2>&1", batch_cli, batch_fqbn, build_path, batch_build, batch_sketch);
+    else snprintf(compile_cmd, sizeof(compile_cmd), "%s compile --fqbn %s --output-dir %s %s 2>&1", batch_cli, batch_fqbn, batch_build, batch_sketch);
+    moisture_flash_status_update("Compiling sketch...");
+    FILE *pc = popen(compile_cmd, "r");
+    if (!pc) { moisture_flash_status_update("Failed to run arduino-cli compile"); return -1; }
+    char line[512];
+    while (fgets(line, sizeof(line), pc)) moisture_flash_status_update(line);
+    int rc = pclose(pc);
+    if (rc != 0) { char eb[128]; snprintf(eb, sizeof(eb), "Compile failed (rc=%d)", rc); moisture_flash_status_update(eb); return -1; }
 
-        if (compile_ok) {
-            char cmd[2048];
-            snprintf(cmd, sizeof(cmd), "%s upload -p %s --fqbn %s %s 2>&1", arduino_cli, devpath, fqbn, use_path);
-            moisture_flash_status_update("Flashing device...");
-            FILE *p = popen(cmd, "r");
-            if (p) {
-                char line[512]; while (fgets(line, sizeof(line), p)) moisture_flash_status_update(line);
-                pclose(p);
-            } else moisture_flash_status_update("Failed to run arduino-cli upload");
-        } else {
-            moisture_flash_status_update("Skipping upload due to compile errors");
+    if (cached == 0) {
+        char marker[600]; snprintf(marker, sizeof(marker), "%s/.complete", batch_build);
+        FILE *m = fopen(marker, "w"); if (m) fclose(m);
+    }
+    return 0;
+}
+
+/* Look for the board among the USB serial nodes present now. Returns 1
+ * with its node name in `name`, 0 if it isn't attached. */
+static int find_by_identity(const uevent_tty_t *usb, char *name, size_t name_len)
+{
+    DIR *d = opendir("/sys/class/tty"); if (!d) return 0;
+    struct dirent *ent; int found = 0;
+    while (!found && (ent = readdir(d)) != NULL) {
+        if (strncmp(ent->d_name, "ttyACM", 6) != 0 && strncmp(ent->d_name, "ttyUSB", 6) != 0) continue;
+        uevent_tty_t info;
+        if (uevent_tty_info(ent->d_name, &info) != 0 || !uevent_same_device(&info, usb)) continue;
+        int len = snprintf(name, name_len, "%s", ent->d_name);
+        if (len < 0 || (size_t)len >= name_len) continue; /* never follow a truncated name */
+        found = 1;
+    }
+    closedir(d);
+    return found;
+}
+
+/* After an upload the board resets: its node goes away and comes back,
+ * possibly under another name if another board took the old one in the
+ * meantime. Follow it by USB identity through the hotplug events queued on
+ * `mon` since before the upload; without events or USB attributes, wait
+ * for the old node to reappear. Returns 0 with dev->path pointing at the
+ * board. */
+static int follow_device(flash_dev_t *dev, int mon)
+{
+    if (mon < 0 || !dev->have_usb) {
+        for (int i = 0; i < REAPPEAR_WAIT_SEC * 10 && access(dev->path, F_OK) != 0; ++i) usleep(100000);
+        return access(dev->path, F_OK) == 0 ? 0 : -1;
+    }
+
+    /* Replay what happened during the upload without waiting; if the board
+     * is gone at the end of it, wait for it to come back */
+    int present = 1; char name[32]; snprintf(name, sizeof(name), "%s", dev->usb.name);
+    int64_t deadline = now_ms() + (int64_t)REAPPEAR_WAIT_SEC * 1000;
+    for (;;) {
+        int64_t left = deadline - now_ms();
+        if (!present && left <= 0) return -1;
+        uevent_tty_t ev;
+        int r = uevent_read_tty(mon, present ? 0 : (int)left, &ev);
+        if (r == UEVENT_OVERRUN) {
+            /* Events were lost, perhaps the board's return among them.
+             * Skip what is still queued, then take the board's state from
+             * sysfs; events after this point are newer than the scan. */
+            while ((r = uevent_read_tty(mon, 0, &ev)) != 0 && r != -1) {}
+            if (r < 0) return follow_device(dev, -1);
+            present = find_by_identity(&dev->usb, name, sizeof(name));
+            continue;
         }
-    } else { moisture_flash_status_update("arduino-cli not found; skipping flash"); }
+        if (r < 0) return follow_device(dev, -1);
+        if (r == 0) { if (present) break; continue; }
+        if (!ev.added && strcmp(ev.name, name) == 0) present = 0;
+        else if (ev.added && uevent_same_device(&ev, &dev->usb)) { present = 1; snprintf(name, sizeof(name), "%s", ev.name); }
+    }
 
-    char newpath[256] = {0}; if (find_first_serial(newpath, sizeof(newpath)) == 0) {
-        char msg[128]; snprintf(msg, sizeof(msg), "Using serial device %s for registration", newpath); moisture_flash_status_update(msg);
-        char mac[32] = {0}; if (wait_for_registration_on_serial(newpath, SERIAL_WAIT_SEC, mac, sizeof(mac)) == 0) { char reg[128]; snprintf(reg, sizeof(reg), "Registered %s", mac); moisture_flash_status_update(reg); moisture_add_plot_for_sensor(mac); }
-        else { moisture_flash_status_update("No registration received; adding unassigned plot"); moisture_add_plot_for_sensor(NULL); }
-    } else { moisture_flash_status_update("No serial device found after upload"); moisture_add_plot_for_sensor(NULL); }
+    if (strcmp(name, dev->usb.name) != 0) {
+        char note[64]; snprintf(note, sizeof(note), "came back as %s", name); dev_status(dev, note);
+        pthread_mutex_lock(&pool_mutex);
+        snprintf(dev->path, sizeof(dev->path), "/dev/%s", name);
+        snprintf(dev->usb.name, sizeof(dev->usb.name), "%s", name);
+        pthread_mutex_unlock(&pool_mutex);
+    }
+    return 0;
+}
 
-    if (created_tmp) { char tmpfile[512]; snprintf(tmpfile, sizeof(tmpfile), "%s/plant_sensor.ino", tmpdir); unlink(tmpfile); snprintf(tmpfile, sizeof(tmpfile), "%s/config.h", tmpdir); unlink(tmpfile); rmdir(tmpdir); }
+/* Upload and registration of one device, on a worker thread */
+static void flash_device(flash_dev_t *dev)
+{
+    int mon = batch_cli ? uevent_open() : -1; /* before the upload resets the board */
+    if (batch_cli) {
+        set_state(dev, DEV_UPLOADING);
+        dev_status(dev, "flashing...");
+        char cmd[2048];
+        snprintf(cmd, sizeof(cmd), "%s upload -p %s --fqbn %s --input-file %s 2>&1", batch_cli, dev->path, batch_fqbn, batch_image);
+        FILE *p = popen(cmd, "r");
+        if (p) {
+            char line[512]; while (fgets(line, sizeof(line), p)) dev_status(dev, line);
+            int rc = pclose(p);
+            if (rc != 0) { char eb[64]; snprintf(eb, sizeof(eb), "upload failed (rc=%d)", rc); dev_status(dev, eb); }
+        } else dev_status(dev, "failed to run arduino-cli upload");
+    }
+
+    set_state(dev, DEV_REGISTERING);
+    int back = follow_device(dev, mon);
+    uevent_close(mon);
+    char mac[32] = {0};
+    if (back == 0 && wait_for_registration_on_serial(dev, SERIAL_WAIT_SEC, mac, sizeof(mac)) == 0) {
+        set_state(dev, DEV_DONE);
+        char reg[128]; snprintf(reg, sizeof(reg), "registered %s", mac); dev_status(dev, reg);
+        moisture_request_plot_for_sensor(mac);
+    } else {
+        set_state(dev, DEV_FAILED);
+        dev_status(dev, "no registration received; adding unassigned plot");
+        moisture_request_plot_for_sensor(NULL);
+    }
+}
+
+static void *worker_thread_fn(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&pool_mutex);
+        while (next_job >= jobs_queued) pthread_cond_wait(&job_cond, &pool_mutex);
+        flash_dev_t *dev = &devices[next_job++];
+        pthread_mutex_unlock(&pool_mutex);
+
+        flash_device(dev);
+
+        pthread_mutex_lock(&pool_mutex);
+        jobs_finished++;
+        pthread_cond_signal(&request_cond);
+        pthread_mutex_unlock(&pool_mutex);
+    }
+    return NULL;
+}
+
+static void run_batch(void)
+{
+    moisture_flash_status_update("Searching for serial devices...");
+    pthread_mutex_lock(&pool_mutex);
+    device_count = find_all_serial();
+    jobs_queued = next_job = jobs_finished = 0;
+    int count = device_count;
+    pthread_mutex_unlock(&pool_mutex);
+    if (count == 0) { moisture_flash_status_update("No serial device found"); moisture_request_plot_for_sensor(NULL); return; }
+
+    char tmpdir[64]; /* "/tmp/plant_sensor_<pid>" */
+    prepare_tmpdir(tmpdir, sizeof(tmpdir));
+
+    batch_cli = NULL;
+    if (access("/usr/local/bin/arduino-cli", X_OK) == 0) batch_cli = "/usr/local/bin/arduino-cli"; else if (access("/usr/bin/arduino-cli", X_OK) == 0) batch_cli = "/usr/bin/arduino-cli";
+    batch_fqbn = getenv(FQBN_ENV_VAR); if (!batch_fqbn) batch_fqbn = DEFAULT_FQBN;
+    if (!batch_cli) moisture_flash_status_update("arduino-cli not found; skipping flash");
+    else if (compile_sketch() != 0) { moisture_flash_status_update("Skipping upload due to compile errors"); batch_cli = NULL; }
+    else if (patch_image(tmpdir) != 0) { moisture_flash_status_update("Skipping upload"); batch_cli = NULL; }
+
+    char msg[128]; snprintf(msg, sizeof(msg), "%s %d device(s)...", batch_cli ? "Flashing" : "Registering", count); moisture_flash_status_update(msg);
+    pthread_mutex_lock(&pool_mutex);
+    jobs_queued = count;
+    pthread_cond_broadcast(&job_cond);
+    while (jobs_finished < count) pthread_cond_wait(&request_cond, &pool_mutex);
+    int done = 0;
+    for (int i = 0; i < count; ++i) if (devices[i].state == DEV_DONE) done++;
+    pthread_mutex_unlock(&pool_mutex);
 
-    moisture_flash_status_update(NULL);
+    remove_tree(tmpdir);
+    snprintf(msg, sizeof(msg), "Flashing finished: %d of %d device(s) registered", done, count);
+    moisture_flash_status_update(msg);
+}
+
+static void *coordinator_thread_fn(void *arg)
+{
+    (void)arg;
+    int hold = 0; /* the last batch's closing status is on screen */
+    for (;;) {
+        pthread_mutex_lock(&pool_mutex);
+        if (hold) {
+            /* Clear it after a while unless another request comes first;
+             * the flash log keeps it */
+            struct timespec until; clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_sec += STATUS_HOLD_SEC;
+            while (!request_pending && pthread_cond_timedwait(&request_cond, &pool_mutex, &until) != ETIMEDOUT) {}
+            hold = 0;
+            if (!request_pending) {
+                pthread_mutex_unlock(&pool_mutex);
+                moisture_flash_status_update(NULL);
+                pthread_mutex_lock(&pool_mutex);
+            }
+        }
+        while (!request_pending) pthread_cond_wait(&request_cond, &pool_mutex);
+        request_pending = 0;
+        pthread_mutex_unlock(&pool_mutex);
+
+        run_batch();
+        hold = 1;
+
+        pthread_mutex_lock(&pool_mutex);
+        batch_running = 0;
+        pthread_mutex_unlock(&pool_mutex);
+    }
     return NULL;
 }
 
-int flash_flash_first_device_and_register(void)
+/* Start the workers and the coordinator. Called with pool_mutex held. */
+static int start_pool(void)
 {
-    pthread_t t; FILE *marker = fopen("/tmp/flash_start_request", "a"); if (marker) { fprintf(marker, "flash start requested\n"); fclose(marker); }
-    int rc = pthread_create(&t, NULL, flash_thread_fn, NULL);
+    static int workers_started = 0;
+    const char *env = getenv(WORKERS_ENV_VAR);
+    int workers = env ? atoi(env) : DEFAULT_WORKERS;
+    if (workers < 1) workers = 1;
+    if (workers > MAX_WORKERS) workers = MAX_WORKERS;
+
+    pthread_t t;
+    for (; workers_started < workers; ++workers_started) {
+        if (pthread_create(&t, NULL, worker_thread_fn, NULL) != 0) break;
+    }
+    /* The coordinator alone would wait forever for its jobs */
+    if (workers_started == 0) { moisture_flash_status_update("Could not start flash workers"); return -1; }
+    int rc = pthread_create(&t, NULL, coordinator_thread_fn, NULL);
     if (rc != 0) { char eb[128]; snprintf(eb, sizeof(eb), "pthread_create failed: %s", strerror(rc)); moisture_flash_status_update(eb); return -1; }
-    pthread_detach(t);
+    return 0;
+}
+
+int flash_all_devices_and_register(void)
+{
+    pthread_mutex_lock(&pool_mutex);
+    if (!pool_started) {
+        if (start_pool() != 0) { pthread_mutex_unlock(&pool_mutex); return -1; }
+        pool_started = 1;
+    }
+    if (batch_running) {
+        pthread_mutex_unlock(&pool_mutex);
+        moisture_flash_status_update("Flashing already in progress");
+        return 0;
+    }
+    batch_running = 1;
+    request_pending = 1;
+    pthread_cond_broadcast(&request_cond);
+    pthread_mutex_unlock(&pool_mutex);
     return 0;
 }
@@ -6,13 +6,17 @@
 extern "C" {
 #endif
 
-/* Try to find a USB serial device, flash the configured firmware using arduino-cli
- * (if available), then wait for a registration string on the serial port.
- * If registration is received it will call into the moisture module to add the
- * sensor. If not, a new plot is added with an automatically assigned id.
- * Returns 0 on success (flashing attempted), -1 on failure.
+/* Find every USB serial device, compile the configured firmware once using
+ * arduino-cli (if available), then upload it to all devices in parallel on
+ * a pool of FLASH_WORKERS threads (default 4) and wait for a registration
+ * string on each serial port. Each registered device is added through the
+ * moisture module; a device that doesn't register adds a new plot with an
+ * automatically assigned id. The status text (moisture_flash_status_update())
+ * shows how many devices are done, in progress and failed; each device's
+ * messages go to the flash log (moisture_flash_log()). A request while a
+ * batch is running is ignored. Returns 0 on success (flashing started), -1 on failure.
  */
-int flash_flash_first_device_and_register(void);
+int flash_all_devices_and_register(void);
 
 #ifdef __cplusplus
 }
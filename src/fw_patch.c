@@ -0,0 +1,93 @@
+/*
+ * fw_patch.c
+ * Per-device provisioning as a byte patch: the firmware is compiled once
+ * with a magic-tagged config block (firmware/plant_sensor/fw_config.h) and
+ * the gateway writes WiFi credentials, target IP and control pin into a
+ * copy of the binary before uploading it.
+ *
+ * The block is located by its magic followed by the expected version and
+ * size, so a stray copy of the magic string elsewhere in the image is not
+ * mistaken for it. Integers are stored little-endian, as on the SAMD21.
+ */
+
+#include "fw_patch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "firmware/plant_sensor/fw_config.h"
+
+#define MAX_IMAGE_SIZE (1024 * 1024) /* larger than any SAMD flash */
+
+static uint16_t get_le16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+static long find_block(const uint8_t *image, size_t len)
+{
+    if (len < FW_CONFIG_SIZE) return -1;
+    /* The block is 4-byte aligned in flash, and so in the image */
+    for (size_t off = 0; off + FW_CONFIG_SIZE <= len; off += 4) {
+        const uint8_t *p = image + off;
+        if (memcmp(p, FW_CONFIG_MAGIC, FW_CONFIG_MAGIC_LEN) != 0) continue;
+        if (get_le16(p + offsetof(fw_config_t, version)) != FW_CONFIG_VERSION) continue;
+        if (get_le16(p + offsetof(fw_config_t, size)) != FW_CONFIG_SIZE) continue;
+        return (long)off;
+    }
+    return -1;
+}
+
+static int set_string(uint8_t *field, size_t field_len, const char *value)
+{
+    if (!value) return 0;
+    size_t n = strlen(value);
+    if (n >= field_len) return -1;
+    memset(field, 0, field_len);
+    memcpy(field, value, n);
+    return 0;
+}
+
+int fw_patch_image(uint8_t *image, size_t len, const fw_patch_config_t *cfg)
+{
+    long off = find_block(image, len);
+    if (off < 0) return FW_PATCH_NO_BLOCK;
+    if (cfg->control_pin > 255) return FW_PATCH_TOO_LONG;
+
+    /* Build the new block aside so a bad value leaves the image as it was */
+    uint8_t block[FW_CONFIG_SIZE];
+    memcpy(block, image + off, sizeof(block));
+    if (set_string(block + offsetof(fw_config_t, ssid), sizeof(((fw_config_t *)0)->ssid), cfg->ssid) != 0 ||
+        set_string(block + offsetof(fw_config_t, pass), sizeof(((fw_config_t *)0)->pass), cfg->pass) != 0 ||
+        set_string(block + offsetof(fw_config_t, target_ip), sizeof(((fw_config_t *)0)->target_ip), cfg->target_ip) != 0)
+        return FW_PATCH_TOO_LONG;
+    if (cfg->control_pin >= 0) block[offsetof(fw_config_t, control_pin)] = (uint8_t)cfg->control_pin;
+    put_le32(block + FW_CONFIG_CRC_OFFSET, fw_config_crc32(block, FW_CONFIG_CRC_OFFSET));
+
+    memcpy(image + off, block, sizeof(block));
+    return FW_PATCH_OK;
+}
+
+int fw_patch_file(const char *in, const char *out, const fw_patch_config_t *cfg)
+{
+    FILE *f = fopen(in, "rb"); if (!f) return FW_PATCH_IO;
+    uint8_t *image = malloc(MAX_IMAGE_SIZE);
+    if (!image) { fclose(f); return FW_PATCH_IO; }
+    size_t len = fread(image, 1, MAX_IMAGE_SIZE, f);
+    int rc = (ferror(f) || !feof(f)) ? FW_PATCH_IO : FW_PATCH_OK;
+    fclose(f);
+
+    if (rc == FW_PATCH_OK) rc = fw_patch_image(image, len, cfg);
+    if (rc == FW_PATCH_OK) {
+        FILE *o = fopen(out, "wb");
+        if (!o) rc = FW_PATCH_IO;
+        else {
+            if (fwrite(image, 1, len, o) != len) rc = FW_PATCH_IO;
+            if (fclose(o) != 0) rc = FW_PATCH_IO;
+        }
+    }
+    free(image);
+    return rc;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#ifndef FW_PATCH_H
+#define FW_PATCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Values to write into the firmware's config block (fw_config.h). NULL
+ * strings and a negative control_pin keep what the image already has.
+ */
+typedef struct {
+    const char *ssid;
+    const char *pass;
+    const char *target_ip;
+    int control_pin;
+} fw_patch_config_t;
+
+#define FW_PATCH_OK 0
+#define FW_PATCH_NO_BLOCK -1   /* no config block of this version in the image */
+#define FW_PATCH_TOO_LONG -2   /* a value doesn't fit its field */
+#define FW_PATCH_IO -3         /* reading or writing a file failed */
+
+/* Find the config block in a firmware image held in memory, write `cfg`
+ * into it and update its checksum. Returns FW_PATCH_OK or an error above;
+ * the image is left untouched on error.
+ */
+int fw_patch_image(uint8_t *image, size_t len, const fw_patch_config_t *cfg);
+
+/* Patch a copy of the image file `in` into `out` */
+int fw_patch_file(const char *in, const char *out, const fw_patch_config_t *cfg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FW_PATCH_H */
@@ -32,11 +32,15 @@ typedef lv_display_t *(*display_init_t)(void);
 /* Prototype of the run loop */
 typedef void (*run_loop_t)(void);
 
+/* Prototype of the function powering the display down (blank = true) and up */
+typedef void (*display_blank_t)(lv_display_t *disp, bool blank);
+
 /* Represents a display driver handle */
 typedef struct {
     display_init_t init_display; /* The display creation/initialization function */
     run_loop_t run_loop;         /* The run loop of the driver handle */
     lv_display_t *display;       /* The LVGL display that was created */
+    display_blank_t blank;       /* Optional, NULL if the display cannot be blanked */
 } display_backend_t;
 
 /* Prototype for the initialization of an indev driver backend */
@@ -80,6 +84,7 @@ int backend_init_sdl(backend_t *backend);
 int backend_init_glfw3(backend_t *backend);
 int backend_init_wayland(backend_t *backend);
 int backend_init_x11(backend_t *backend);
+int backend_init_headless(backend_t *backend);
 
 /* Input device driver backends */
 int backend_init_evdev(backend_t *backend);
@@ -0,0 +1,97 @@
+/**
+ * @file damage.c
+ *
+ * Per-frame damage rectangles for direct mode display backends
+ *
+ * In direct mode the flush callback is called once per invalidated area
+ * with the whole frame in the draw buffer. Collecting the areas until the
+ * last flush of the frame lets a backend copy or report only what changed.
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <string.h>
+
+#include "damage.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void damage_add(damage_t *damage, const lv_area_t *area)
+{
+    lv_area_t *bbox;
+    uint32_t i;
+
+    if (damage->count < DAMAGE_MAX_RECTS) {
+        damage->rects[damage->count++] = *area;
+        return;
+    }
+
+    /* Out of slots: fall back to a single bounding box */
+    bbox = &damage->rects[0];
+    for (i = 1; i < damage->count; i++) {
+        lv_area_join(bbox, bbox, &damage->rects[i]);
+    }
+    lv_area_join(bbox, bbox, area);
+    damage->count = 1;
+}
+
+void damage_clear(damage_t *damage)
+{
+    damage->count = 0;
+}
+
+uint32_t damage_get_pixels(const damage_t *damage)
+{
+    uint32_t pixels = 0;
+    uint32_t i;
+
+    for (i = 0; i < damage->count; i++) {
+        pixels += lv_area_get_size(&damage->rects[i]);
+    }
+
+    return pixels;
+}
+
+void damage_copy(const damage_t *damage, uint8_t *dst, uint32_t dst_stride,
+                 const uint8_t *src, uint32_t src_stride, uint32_t px_size)
+{
+    const lv_area_t *a;
+    uint32_t row_len;
+    int32_t y;
+    uint32_t i;
+
+    for (i = 0; i < damage->count; i++) {
+        a = &damage->rects[i];
+        row_len = (uint32_t)lv_area_get_width(a) * px_size;
+
+        for (y = a->y1; y <= a->y2; y++) {
+            memcpy(dst + (size_t)y * dst_stride + (size_t)a->x1 * px_size,
+                   src + (size_t)y * src_stride + (size_t)a->x1 * px_size,
+                   row_len);
+        }
+    }
+}
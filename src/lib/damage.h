@@ -0,0 +1,82 @@
+/**
+ * @file damage.h
+ *
+ * Per-frame damage rectangles for direct mode display backends
+ *
+ */
+
+#ifndef DAMAGE_H
+#define DAMAGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include "lvgl/lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* More areas than this in one frame are merged into their bounding box */
+#define DAMAGE_MAX_RECTS 16
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/* The areas a frame changed, as passed to the flush callback */
+typedef struct {
+    lv_area_t rects[DAMAGE_MAX_RECTS];
+    uint32_t count;
+} damage_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * @brief Add a flushed area to the damage of the current frame
+ * @param damage the frame damage
+ * @param area the area
+ */
+void damage_add(damage_t *damage, const lv_area_t *area);
+
+/**
+ * @brief Start a new frame
+ * @param damage the frame damage
+ */
+void damage_clear(damage_t *damage);
+
+/**
+ * @brief Count the damaged pixels
+ * @param damage the frame damage
+ * @return the pixel count, areas are not expected to overlap
+ */
+uint32_t damage_get_pixels(const damage_t *damage);
+
+/**
+ * @brief Copy the damaged areas between two buffers of the same size and format
+ * @param damage the frame damage
+ * @param dst the destination, e.g. the mapped framebuffer
+ * @param dst_stride the destination stride in bytes
+ * @param src the source, e.g. the LVGL draw buffer
+ * @param src_stride the source stride in bytes
+ * @param px_size the pixel size in bytes
+ */
+void damage_copy(const damage_t *damage, uint8_t *dst, uint32_t dst_stride,
+                 const uint8_t *src, uint32_t src_stride, uint32_t px_size);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*DAMAGE_H*/
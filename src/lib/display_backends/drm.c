@@ -19,12 +19,23 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
 
 #include "lvgl/lvgl.h"
 #if LV_USE_LINUX_DRM
+#include <xf86drm.h>
+#include <xf86drmMode.h>
 #include "../simulator_util.h"
 #include "../simulator_settings.h"
 #include "../backends.h"
+#include "../event_loop.h"
+#include "../damage.h"
+#include "../frame_stats.h"
 
 /*********************
  *      DEFINES
@@ -34,18 +45,52 @@
  *      TYPEDEFS
  **********************/
 
+/* A dumb buffer registered as a framebuffer */
+typedef struct {
+    uint32_t handle;
+    uint32_t fb_id;
+    uint32_t pitch;
+    uint64_t size;
+    uint8_t *map;
+    lv_draw_buf_t draw_buf;
+} drm_buffer_t;
+
+typedef struct {
+    int fd;
+    uint32_t conn_id;
+    uint32_t crtc_id;
+    drmModeModeInfo mode;
+    drmModeCrtcPtr saved_crtc;  /* restored on exit */
+    drm_buffer_t bufs[2];
+    int buf_count;
+    int front;                  /* the buffer on screen */
+    bool flip_pending;
+    bool dirty_fb;              /* drmModeDirtyFB is supported */
+    damage_t damage;
+} drm_dev_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 static void run_loop_drm(void);
 static lv_display_t *init_drm(void);
-
+static void blank_drm(lv_display_t *disp, bool blank);
+static bool find_output(drm_dev_t *dev);
+static bool create_buffer(drm_dev_t *dev, drm_buffer_t *buf, uint32_t bpp, lv_color_format_t cf);
+static void destroy_buffer(drm_dev_t *dev, drm_buffer_t *buf);
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map);
+static void flush_wait_cb(lv_display_t *disp);
+static void page_flip_handler(int fd, unsigned int sequence, unsigned int tv_sec,
+                              unsigned int tv_usec, void *user_data);
+static void restore_crtc(void);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
 static char *backend_name = "DRM";
 
+static drm_dev_t drm_dev = { .fd = -1 };
+
 /**********************
  *      MACROS
  **********************/
@@ -64,11 +109,12 @@ int backend_init_drm(backend_t *backend)
 {
     LV_ASSERT_NULL(backend);
 
-    backend->handle->display = malloc(sizeof(display_backend_t));
+    backend->handle->display = calloc(1, sizeof(display_backend_t));
     LV_ASSERT_NULL(backend->handle->display);
 
     backend->handle->display->init_display = init_drm;
     backend->handle->display->run_loop = run_loop_drm;
+    backend->handle->display->blank = blank_drm;
     backend->name = backend_name;
     backend->type = BACKEND_DISPLAY;
 
@@ -82,20 +128,89 @@ int backend_init_drm(backend_t *backend)
 /**
  * Initialize the DRM display driver
  *
+ * @description Sets the preferred mode of the first connected output and
+ * renders in direct mode into dumb buffers, so a frame only redraws its
+ * invalidated areas. With LV_LINUX_DRM_BUFFERS=2 (the default) LVGL draws
+ * into the hidden buffer and the flush page flips to it on the next
+ * vblank; with 1 it draws into the scanned out buffer. The damaged areas
+ * are passed to drmModeDirtyFB for drivers that upload or compose by
+ * damage (USB and SPI panels, virtual displays).
+ *
  * @return the LVGL display
  */
 static lv_display_t *init_drm(void)
 {
     const char *device = getenv_default("LV_LINUX_DRM_CARD", "/dev/dri/card0");
-    lv_display_t * disp = lv_linux_drm_create();
+    int buffers = atoi(getenv_default("LV_LINUX_DRM_BUFFERS", "2"));
+    lv_color_format_t cf = LV_COLOR_FORMAT_NATIVE;
+    uint32_t bpp = LV_COLOR_DEPTH;
+    lv_display_t *disp;
+    int i;
 
-    if (disp == NULL) {
+    drm_dev.fd = open(device, O_RDWR | O_CLOEXEC);
+    if (drm_dev.fd < 0) {
+        LV_LOG_ERROR("Failed to open %s: %s", device, strerror(errno));
         return NULL;
     }
 
-    lv_linux_drm_set_file(disp, device, -1);
+    if (!find_output(&drm_dev)) {
+        LV_LOG_ERROR("No connected output on %s", device);
+        goto err_close;
+    }
+
+    drm_dev.buf_count = buffers >= 2 ? 2 : 1;
+    for (i = 0; i < drm_dev.buf_count; i++) {
+        if (!create_buffer(&drm_dev, &drm_dev.bufs[i], bpp, cf)) {
+            /* Not every driver scans out 16 bpp, all do 32 */
+            if (bpp == 32 || i > 0) {
+                goto err_buffers;
+            }
+            bpp = 32;
+            cf = LV_COLOR_FORMAT_XRGB8888;
+            i--;
+        }
+    }
+
+    drm_dev.saved_crtc = drmModeGetCrtc(drm_dev.fd, drm_dev.crtc_id);
+    drm_dev.front = 0;
+    if (drmModeSetCrtc(drm_dev.fd, drm_dev.crtc_id, drm_dev.bufs[0].fb_id, 0, 0,
+                       &drm_dev.conn_id, 1, &drm_dev.mode) < 0) {
+        LV_LOG_ERROR("drmModeSetCrtc failed: %s", strerror(errno));
+        goto err_buffers;
+    }
+    atexit(restore_crtc);
+
+    disp = lv_display_create(drm_dev.mode.hdisplay, drm_dev.mode.vdisplay);
+    if (disp == NULL) {
+        goto err_buffers;
+    }
+    lv_display_set_color_format(disp, cf);
 
+    if (drm_dev.buf_count == 2) {
+        /* Buffer 0 is on screen: draw the first frame into buffer 1 */
+        lv_display_set_draw_buffers(disp, &drm_dev.bufs[1].draw_buf, &drm_dev.bufs[0].draw_buf);
+    } else {
+        lv_display_set_draw_buffers(disp, &drm_dev.bufs[0].draw_buf, NULL);
+    }
+    lv_display_set_render_mode(disp, LV_DISPLAY_RENDER_MODE_DIRECT);
+    lv_display_set_flush_cb(disp, flush_cb);
+    lv_display_set_flush_wait_cb(disp, flush_wait_cb);
+    lv_display_set_driver_data(disp, &drm_dev);
+
+    drm_dev.dirty_fb = true;
+
+    LV_LOG_INFO("%s: %ux%u@%u, %u bpp, %d buffers", device, drm_dev.mode.hdisplay,
+                drm_dev.mode.vdisplay, drm_dev.mode.vrefresh, bpp, drm_dev.buf_count);
     return disp;
+
+err_buffers:
+    for (i = 0; i < 2; i++) {
+        destroy_buffer(&drm_dev, &drm_dev.bufs[i]);
+    }
+err_close:
+    close(drm_dev.fd);
+    drm_dev.fd = -1;
+    return NULL;
 }
 
 
@@ -104,14 +219,322 @@ static lv_display_t *init_drm(void)
  */
 static void run_loop_drm(void)
 {
-    uint32_t idle_time;
+    /* Sleeps until a timer is due, input arrives or new data is signaled */
+    event_loop_run();
+}
+
+/**
+ * Power the output down or up through DPMS
+ *
+ * @param disp the LVGL display
+ * @param blank true to power it down
+ */
+static void blank_drm(lv_display_t *disp, bool blank)
+{
+    drm_dev_t *dev = lv_display_get_driver_data(disp);
+    drmModeConnectorPtr conn;
+    drmModePropertyPtr prop;
+    int i;
+
+    conn = drmModeGetConnector(dev->fd, dev->conn_id);
+    if (conn == NULL) {
+        return;
+    }
+
+    for (i = 0; i < conn->count_props; i++) {
+        prop = drmModeGetProperty(dev->fd, conn->props[i]);
+        if (prop == NULL) {
+            continue;
+        }
+        if (strcmp(prop->name, "DPMS") == 0 &&
+            drmModeConnectorSetProperty(dev->fd, dev->conn_id, prop->prop_id,
+                                        blank ? DRM_MODE_DPMS_OFF : DRM_MODE_DPMS_ON) < 0) {
+            LV_LOG_WARN("Setting DPMS failed: %s", strerror(errno));
+        }
+        drmModeFreeProperty(prop);
+    }
+
+    drmModeFreeConnector(conn);
+}
+
+/**
+ * Pick the first connected connector, its preferred mode and a CRTC
+ *
+ * @param dev the device
+ * @return true if an output was found
+ */
+static bool find_output(drm_dev_t *dev)
+{
+    drmModeResPtr res;
+    drmModeConnectorPtr conn = NULL;
+    drmModeEncoderPtr enc;
+    bool found = false;
+    int i;
+    int j;
+    int k;
+
+    res = drmModeGetResources(dev->fd);
+    if (res == NULL) {
+        return false;
+    }
+
+    for (i = 0; i < res->count_connectors && !found; i++) {
+        conn = drmModeGetConnector(dev->fd, res->connectors[i]);
+        if (conn == NULL) {
+            continue;
+        }
+        if (conn->connection != DRM_MODE_CONNECTED || conn->count_modes == 0) {
+            drmModeFreeConnector(conn);
+            continue;
+        }
+
+        dev->conn_id = conn->connector_id;
+        dev->mode = conn->modes[0];
+        for (j = 0; j < conn->count_modes; j++) {
+            if (conn->modes[j].type & DRM_MODE_TYPE_PREFERRED) {
+                dev->mode = conn->modes[j];
+                break;
+            }
+        }
+
+        /* Keep the CRTC already driving the connector, else any it can use */
+        enc = conn->encoder_id ? drmModeGetEncoder(dev->fd, conn->encoder_id) : NULL;
+        if (enc != NULL && enc->crtc_id != 0) {
+            dev->crtc_id = enc->crtc_id;
+            found = true;
+        }
+        if (enc != NULL) {
+            drmModeFreeEncoder(enc);
+        }
+
+        for (j = 0; j < conn->count_encoders && !found; j++) {
+            enc = drmModeGetEncoder(dev->fd, conn->encoders[j]);
+            if (enc == NULL) {
+                continue;
+            }
+            for (k = 0; k < res->count_crtcs; k++) {
+                if (enc->possible_crtcs & (1u << k)) {
+                    dev->crtc_id = res->crtcs[k];
+                    found = true;
+                    break;
+                }
+            }
+            drmModeFreeEncoder(enc);
+        }
+
+        drmModeFreeConnector(conn);
+    }
+
+    drmModeFreeResources(res);
+    return found;
+}
+
+/**
+ * Allocate, register and map a dumb buffer the size of the mode
+ *
+ * @param dev the device
+ * @param buf the buffer to fill
+ * @param bpp bits per pixel, 16 or 32
+ * @param cf the matching LVGL color format
+ * @return true on success
+ */
+static bool create_buffer(drm_dev_t *dev, drm_buffer_t *buf, uint32_t bpp, lv_color_format_t cf)
+{
+    struct drm_mode_create_dumb create;
+    struct drm_mode_map_dumb map;
+    struct drm_mode_destroy_dumb destroy;
+    uint32_t w = dev->mode.hdisplay;
+    uint32_t h = dev->mode.vdisplay;
+
+    memset(buf, 0, sizeof(*buf));
+    memset(&create, 0, sizeof(create));
+    create.width = w;
+    create.height = h;
+    create.bpp = bpp;
+    if (drmIoctl(dev->fd, DRM_IOCTL_MODE_CREATE_DUMB, &create) < 0) {
+        LV_LOG_ERROR("Failed to create a dumb buffer: %s", strerror(errno));
+        return false;
+    }
+    buf->handle = create.handle;
+    buf->pitch = create.pitch;
+    buf->size = create.size;
+
+    if (drmModeAddFB(dev->fd, w, h, bpp == 16 ? 16 : 24, bpp, buf->pitch,
+                     buf->handle, &buf->fb_id) < 0) {
+        LV_LOG_WARN("Failed to add a %u bpp framebuffer: %s", bpp, strerror(errno));
+        goto err_destroy;
+    }
+
+    memset(&map, 0, sizeof(map));
+    map.handle = buf->handle;
+    if (drmIoctl(dev->fd, DRM_IOCTL_MODE_MAP_DUMB, &map) < 0) {
+        goto err_rmfb;
+    }
+    buf->map = mmap(NULL, buf->size, PROT_READ | PROT_WRITE, MAP_SHARED, dev->fd, map.offset);
+    if (buf->map == MAP_FAILED) {
+        buf->map = NULL;
+        goto err_rmfb;
+    }
+    memset(buf->map, 0, buf->size);
+
+    lv_draw_buf_init(&buf->draw_buf, w, h, cf, buf->pitch, buf->map, (uint32_t)buf->size);
+    return true;
+
+err_rmfb:
+    drmModeRmFB(dev->fd, buf->fb_id);
+err_destroy:
+    memset(&destroy, 0, sizeof(destroy));
+    destroy.handle = buf->handle;
+    drmIoctl(dev->fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+    memset(buf, 0, sizeof(*buf));
+    return false;
+}
+
+static void destroy_buffer(drm_dev_t *dev, drm_buffer_t *buf)
+{
+    struct drm_mode_destroy_dumb destroy;
+
+    if (buf->handle == 0) {
+        return;
+    }
+    if (buf->map != NULL) {
+        munmap(buf->map, buf->size);
+    }
+    if (buf->fb_id != 0) {
+        drmModeRmFB(dev->fd, buf->fb_id);
+    }
+    memset(&destroy, 0, sizeof(destroy));
+    destroy.handle = buf->handle;
+    drmIoctl(dev->fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+    memset(buf, 0, sizeof(*buf));
+}
+
+/**
+ * Called once per invalidated area; the frame is complete on the last one
+ *
+ * @param disp the LVGL display
+ * @param area the area
+ * @param px_map the whole draw buffer, in direct mode
+ */
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    drm_dev_t *dev = lv_display_get_driver_data(disp);
+    drmModeClip clips[DAMAGE_MAX_RECTS];
+    drm_buffer_t *buf;
+    int back;
+    uint32_t i;
+
+    damage_add(&dev->damage, area);
+
+    if (!lv_display_flush_is_last(disp)) {
+        lv_display_flush_ready(disp);
+        return;
+    }
+
+    back = px_map == dev->bufs[0].map ? 0 : 1;
+    buf = &dev->bufs[back];
+
+    if (dev->dirty_fb) {
+        for (i = 0; i < dev->damage.count; i++) {
+            clips[i].x1 = (uint16_t)dev->damage.rects[i].x1;
+            clips[i].y1 = (uint16_t)dev->damage.rects[i].y1;
+            clips[i].x2 = (uint16_t)(dev->damage.rects[i].x2 + 1);
+            clips[i].y2 = (uint16_t)(dev->damage.rects[i].y2 + 1);
+        }
+        if (drmModeDirtyFB(dev->fd, buf->fb_id, clips, dev->damage.count) < 0) {
+            /* Most drivers scan out from memory and do not need it */
+            LV_LOG_INFO("No drmModeDirtyFB: %s", strerror(errno));
+            dev->dirty_fb = false;
+        }
+    }
+
+    frame_stats_damage(damage_get_pixels(&dev->damage));
+    damage_clear(&dev->damage);
+
+    if (back == dev->front) {
+        /* Single buffered: already on screen */
+        lv_display_flush_ready(disp);
+        return;
+    }
+
+    if (drmModePageFlip(dev->fd, dev->crtc_id, buf->fb_id, DRM_MODE_PAGE_FLIP_EVENT, dev) == 0) {
+        /* Ready once the flip event arrives, see flush_wait_cb */
+        dev->flip_pending = true;
+        dev->front = back;
+        return;
+    }
+
+    LV_LOG_WARN("drmModePageFlip failed: %s", strerror(errno));
+    if (drmModeSetCrtc(dev->fd, dev->crtc_id, buf->fb_id, 0, 0, &dev->conn_id, 1, &dev->mode) == 0) {
+        dev->front = back;
+    }
+    lv_display_flush_ready(disp);
+}
+
+/**
+ * Wait for the page flip, so LVGL never draws into the buffer on screen
+ *
+ * @param disp the LVGL display
+ */
+static void flush_wait_cb(lv_display_t *disp)
+{
+    drm_dev_t *dev = lv_display_get_driver_data(disp);
+    drmEventContext ctx;
+    struct pollfd pfd;
+    int ret;
 
-    /* Handle LVGL tasks */
-    while (true) {
-        /* Returns the time to the next timer execution */
-        idle_time = lv_timer_handler();
-        usleep(idle_time * 1000);
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.version = 2;
+    ctx.page_flip_handler = page_flip_handler;
+
+    pfd.fd = dev->fd;
+    pfd.events = POLLIN;
+
+    while (dev->flip_pending) {
+        ret = poll(&pfd, 1, 100);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            /* A lost flip event must not hang the UI */
+            LV_LOG_WARN("Page flip timed out");
+            dev->flip_pending = false;
+            break;
+        }
+        drmHandleEvent(dev->fd, &ctx);
     }
+
+    lv_display_flush_ready(disp);
+}
+
+static void page_flip_handler(int fd, unsigned int sequence, unsigned int tv_sec,
+                              unsigned int tv_usec, void *user_data)
+{
+    drm_dev_t *dev = user_data;
+
+    LV_UNUSED(fd);
+    LV_UNUSED(sequence);
+    LV_UNUSED(tv_sec);
+    LV_UNUSED(tv_usec);
+
+    dev->flip_pending = false;
+}
+
+/**
+ * Give the output back to the console, or to whoever had it
+ */
+static void restore_crtc(void)
+{
+    drmModeCrtcPtr crtc = drm_dev.saved_crtc;
+
+    if (crtc == NULL || drm_dev.fd < 0) {
+        return;
+    }
+
+    drmModeSetCrtc(drm_dev.fd, crtc->crtc_id, crtc->buffer_id, crtc->x, crtc->y,
+                   &drm_dev.conn_id, 1, &crtc->mode);
+    drmModeFreeCrtc(crtc);
+    drm_dev.saved_crtc = NULL;
 }
 
 #endif /*#if LV_USE_LINUX_DRM*/
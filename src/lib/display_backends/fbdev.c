@@ -18,26 +18,57 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/fb.h>
 
 #include "lvgl/lvgl.h"
 #if LV_USE_LINUX_FBDEV
 #include "../simulator_util.h"
 #include "../backends.h"
+#include "../event_loop.h"
+#include "../damage.h"
+#include "../frame_stats.h"
 
 /*********************
  *      DEFINES
  *********************/
 
+#ifndef FBIO_WAITFORVSYNC
+#define FBIO_WAITFORVSYNC _IOW('F', 0x20, uint32_t)
+#endif
+
 /**********************
  *      TYPEDEFS
  **********************/
 
+typedef struct {
+    int fd;
+    uint8_t *mem;               /* the mapped framebuffer */
+    size_t mem_size;
+    uint32_t stride;            /* line length in bytes */
+    uint32_t px_size;
+    struct fb_var_screeninfo vinfo;
+    bool pan;                   /* LVGL draws into two framebuffer pages */
+    bool vsync;                 /* FBIO_WAITFORVSYNC works */
+    lv_draw_buf_t pages[2];     /* pan: the two pages */
+    lv_draw_buf_t *shadow;      /* otherwise: the buffer damage is copied from */
+    damage_t damage;
+} fbdev_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 
 static lv_display_t *init_fbdev(void);
 static void run_loop_fbdev(void);
+static void blank_fbdev(lv_display_t *disp, bool blank);
+static bool enable_panning(fbdev_t *fb);
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map);
+static void wait_vsync(fbdev_t *fb);
 
 /**********************
  *  STATIC VARIABLES
@@ -45,6 +76,8 @@ static void run_loop_fbdev(void);
 
 static char *backend_name = "FBDEV";
 
+static fbdev_t fbdev = { .fd = -1 };
+
 /**********************
  *      MACROS
  **********************/
@@ -63,11 +96,12 @@ int backend_init_fbdev(backend_t *backend)
 {
     LV_ASSERT_NULL(backend);
 
-    backend->handle->display = malloc(sizeof(display_backend_t));
+    backend->handle->display = calloc(1, sizeof(display_backend_t));
     LV_ASSERT_NULL(backend->handle->display);
 
     backend->handle->display->init_display = init_fbdev;
     backend->handle->display->run_loop = run_loop_fbdev;
+    backend->handle->display->blank = blank_fbdev;
     backend->name = backend_name;
     backend->type = BACKEND_DISPLAY;
 
@@ -81,20 +115,108 @@ int backend_init_fbdev(backend_t *backend)
 /**
  * Initialize the fbdev driver
  *
+ * @description Renders in direct mode, so a frame only redraws and flushes
+ * its invalidated areas. With LV_LINUX_FBDEV_BUFFERS=2 (the default) and a
+ * driver that can pan a double-height virtual screen, LVGL draws into the
+ * hidden page and the flush pans to it. Otherwise LVGL draws into a buffer
+ * in RAM and the flush copies the damaged areas into the framebuffer. Both
+ * wait for vertical blanking if the driver supports FBIO_WAITFORVSYNC and
+ * LV_LINUX_FBDEV_VSYNC is not 0.
+ *
  * @return the LVGL display
  */
 static lv_display_t *init_fbdev(void)
 {
     const char *device = getenv_default("LV_LINUX_FBDEV_DEVICE", "/dev/fb0");
-    lv_display_t *disp = lv_linux_fbdev_create();
+    int buffers = atoi(getenv_default("LV_LINUX_FBDEV_BUFFERS", "2"));
+    struct fb_fix_screeninfo finfo;
+    lv_color_format_t cf;
+    lv_display_t *disp;
+    uint32_t w;
+    uint32_t h;
 
-    if (disp == NULL) {
+    fbdev.fd = open(device, O_RDWR | O_CLOEXEC);
+    if (fbdev.fd < 0) {
+        LV_LOG_ERROR("Failed to open %s: %s", device, strerror(errno));
         return NULL;
     }
 
-    lv_linux_fbdev_set_file(disp, device);
+    if (ioctl(fbdev.fd, FBIOGET_VSCREENINFO, &fbdev.vinfo) < 0 ||
+        ioctl(fbdev.fd, FBIOGET_FSCREENINFO, &finfo) < 0) {
+        LV_LOG_ERROR("Failed to query %s: %s", device, strerror(errno));
+        goto err_close;
+    }
+
+    switch (fbdev.vinfo.bits_per_pixel) {
+    case 16:
+        cf = LV_COLOR_FORMAT_RGB565;
+        break;
+    case 24:
+        cf = LV_COLOR_FORMAT_RGB888;
+        break;
+    case 32:
+        cf = LV_COLOR_FORMAT_XRGB8888;
+        break;
+    default:
+        LV_LOG_ERROR("Unsupported framebuffer depth: %u bpp", fbdev.vinfo.bits_per_pixel);
+        goto err_close;
+    }
+
+    w = fbdev.vinfo.xres;
+    h = fbdev.vinfo.yres;
+    fbdev.px_size = fbdev.vinfo.bits_per_pixel / 8;
+    fbdev.stride = finfo.line_length;
+    fbdev.vsync = atoi(getenv_default("LV_LINUX_FBDEV_VSYNC", "1")) != 0;
+    fbdev.pan = buffers >= 2 && enable_panning(&fbdev);
+
+    /* Panning may have grown the framebuffer memory */
+    ioctl(fbdev.fd, FBIOGET_FSCREENINFO, &finfo);
+    fbdev.mem_size = finfo.smem_len;
+    fbdev.mem = mmap(NULL, fbdev.mem_size, PROT_READ | PROT_WRITE, MAP_SHARED, fbdev.fd, 0);
+    if (fbdev.mem == MAP_FAILED) {
+        LV_LOG_ERROR("Failed to map %s: %s", device, strerror(errno));
+        goto err_close;
+    }
+
+    disp = lv_display_create(w, h);
+    if (disp == NULL) {
+        goto err_unmap;
+    }
+    lv_display_set_color_format(disp, cf);
+
+    if (fbdev.pan) {
+        /* Page 0 is on screen: draw the first frame into page 1 */
+        lv_draw_buf_init(&fbdev.pages[0], w, h, cf, fbdev.stride,
+                         fbdev.mem, fbdev.stride * h);
+        lv_draw_buf_init(&fbdev.pages[1], w, h, cf, fbdev.stride,
+                         fbdev.mem + (size_t)fbdev.stride * h, fbdev.stride * h);
+        lv_display_set_draw_buffers(disp, &fbdev.pages[1], &fbdev.pages[0]);
+    } else {
+        if (buffers >= 2) {
+            LV_LOG_WARN("%s cannot pan, copying damage from one buffer", device);
+        }
+        fbdev.shadow = lv_draw_buf_create(w, h, cf, LV_STRIDE_AUTO);
+        if (fbdev.shadow == NULL) {
+            lv_display_delete(disp);
+            goto err_unmap;
+        }
+        lv_display_set_draw_buffers(disp, fbdev.shadow, NULL);
+    }
+
+    lv_display_set_render_mode(disp, LV_DISPLAY_RENDER_MODE_DIRECT);
+    lv_display_set_flush_cb(disp, flush_cb);
+    lv_display_set_driver_data(disp, &fbdev);
 
+    LV_LOG_INFO("%s: %ux%u, %u bpp, %s", device, w, h, fbdev.vinfo.bits_per_pixel,
+                fbdev.pan ? "page flipping" : "damage copy");
     return disp;
+
+err_unmap:
+    munmap(fbdev.mem, fbdev.mem_size);
+err_close:
+    close(fbdev.fd);
+    fbdev.fd = -1;
+    return NULL;
 }
 
 /**
@@ -102,14 +224,97 @@ static lv_display_t *init_fbdev(void)
  */
 static void run_loop_fbdev(void)
 {
-    uint32_t idle_time;
+    /* Sleeps until a timer is due, input arrives or new data is signaled */
+    event_loop_run();
+}
+
+/**
+ * Power the framebuffer display down or up
+ *
+ * @param disp the LVGL display
+ * @param blank true to power it down
+ */
+static void blank_fbdev(lv_display_t *disp, bool blank)
+{
+    LV_UNUSED(disp);
+
+    if (ioctl(fbdev.fd, FBIOBLANK, blank ? FB_BLANK_POWERDOWN : FB_BLANK_UNBLANK) < 0) {
+        LV_LOG_WARN("FBIOBLANK failed: %s", strerror(errno));
+    }
+}
+
+/**
+ * Ask for a virtual screen twice the visible height, to flip by panning
+ *
+ * @param fb the framebuffer
+ * @return true if the driver provides it
+ */
+static bool enable_panning(fbdev_t *fb)
+{
+    struct fb_var_screeninfo vinfo = fb->vinfo;
+
+    if (vinfo.yres_virtual < vinfo.yres * 2) {
+        vinfo.yres_virtual = vinfo.yres * 2;
+        if (ioctl(fb->fd, FBIOPUT_VSCREENINFO, &vinfo) < 0 ||
+            ioctl(fb->fd, FBIOGET_VSCREENINFO, &vinfo) < 0) {
+            return false;
+        }
+    }
+
+    if (vinfo.yres_virtual < vinfo.yres * 2) {
+        return false;
+    }
+
+    /* Make sure page 0 is the one on screen */
+    vinfo.yoffset = 0;
+    if (ioctl(fb->fd, FBIOPAN_DISPLAY, &vinfo) < 0) {
+        return false;
+    }
+
+    fb->vinfo = vinfo;
+    return true;
+}
+
+/**
+ * Called once per invalidated area; the frame is complete on the last one
+ *
+ * @param disp the LVGL display
+ * @param area the area
+ * @param px_map the whole draw buffer, in direct mode
+ */
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    fbdev_t *fb = lv_display_get_driver_data(disp);
+
+    damage_add(&fb->damage, area);
 
-    /* Handle LVGL tasks */
-    while (true) {
+    if (lv_display_flush_is_last(disp)) {
+        if (fb->pan) {
+            fb->vinfo.yoffset = px_map == fb->pages[0].data ? 0 : fb->vinfo.yres;
+            if (ioctl(fb->fd, FBIOPAN_DISPLAY, &fb->vinfo) < 0) {
+                LV_LOG_WARN("FBIOPAN_DISPLAY failed: %s", strerror(errno));
+            }
+            /* Do not draw into the page just hidden while it is scanned out */
+            wait_vsync(fb);
+        } else {
+            wait_vsync(fb);
+            damage_copy(&fb->damage, fb->mem, fb->stride, px_map, fb->shadow->header.stride, fb->px_size);
+        }
+
+        frame_stats_damage(damage_get_pixels(&fb->damage));
+        damage_clear(&fb->damage);
+    }
+
+    lv_display_flush_ready(disp);
+}
+
+static void wait_vsync(fbdev_t *fb)
+{
+    uint32_t crtc = 0;
 
-        /* Returns the time to the next timer execution */
-        idle_time = lv_timer_handler();
-        usleep(idle_time * 1000);
+    if (fb->vsync && ioctl(fb->fd, FBIO_WAITFORVSYNC, &crtc) < 0) {
+        LV_LOG_INFO("No FBIO_WAITFORVSYNC: %s", strerror(errno));
+        fb->vsync = false;
     }
 }
 
@@ -0,0 +1,331 @@
+/**
+ * @file headless.c
+ *
+ * In-memory display backend for benchmarks and CI
+ *
+ * Renders into a framebuffer in RAM at the configured resolution, with no
+ * hardware or windowing system. Frames can be dumped as PPM images and the
+ * LVGL clock can be stepped by a fixed amount per loop iteration, which
+ * makes runs reproducible on any Linux machine. Like the fbdev and DRM
+ * backends it renders in direct mode, single or double buffered, and
+ * reports the damage of every frame.
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+
+#include "lvgl/lvgl.h"
+#if LV_SIM_USE_HEADLESS
+#include "../simulator_util.h"
+#include "../simulator_settings.h"
+#include "../backends.h"
+#include "../event_loop.h"
+#include "../frame_stats.h"
+#include "../damage.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  EXTERNAL VARIABLES
+ **********************/
+extern simulator_settings_t settings;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static lv_display_t *init_headless(void);
+static void run_loop_headless(void);
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map);
+static void refr_start_cb(lv_event_t *e);
+static void duration_timer_cb(lv_timer_t *timer);
+static uint32_t virtual_tick_cb(void);
+static void stop(void);
+static void dump_frame(const lv_draw_buf_t *buf, uint32_t frame);
+static uint64_t now_ns(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+static char *backend_name = "HEADLESS";
+
+static lv_draw_buf_t *framebuffers[2];
+static damage_t damage;
+
+/* Configuration, from the environment */
+static uint32_t step_ms;      /* 0: free-running wall clock */
+static uint32_t max_frames;   /* 0: no limit */
+static uint32_t duration_ms;  /* 0: no limit */
+static const char *dump_dir;  /* NULL: no dumps */
+
+/* Run state */
+static bool done;
+static uint32_t virtual_ms;
+static uint32_t frame_count;
+static uint64_t frame_start_ns;
+static uint64_t render_total_ns;
+static uint64_t render_max_ns;
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * Register the backend
+ * @param backend the backend descriptor
+ * @description configures the descriptor
+ */
+int backend_init_headless(backend_t *backend)
+{
+    LV_ASSERT_NULL(backend);
+
+    backend->handle->display = calloc(1, sizeof(display_backend_t));
+    LV_ASSERT_NULL(backend->handle->display);
+
+    backend->handle->display->init_display = init_headless;
+    backend->handle->display->run_loop = run_loop_headless;
+    backend->name = backend_name;
+    backend->type = BACKEND_DISPLAY;
+
+    return 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Initialize the headless display
+ *
+ * @return the LVGL display
+ */
+static lv_display_t *init_headless(void)
+{
+    lv_display_t *disp;
+    int buffer_count;
+    int i;
+
+    step_ms = atoi(getenv_default("LV_SIM_HEADLESS_STEP_MS", "0"));
+    max_frames = atoi(getenv_default("LV_SIM_HEADLESS_FRAMES", "0"));
+    duration_ms = atoi(getenv_default("LV_SIM_HEADLESS_DURATION_MS", "0"));
+    dump_dir = getenv("LV_SIM_HEADLESS_DUMP_DIR");
+
+    buffer_count = atoi(getenv_default("LV_SIM_HEADLESS_BUFFERS", "1")) >= 2 ? 2 : 1;
+
+    disp = lv_display_create(settings.window_width, settings.window_height);
+
+    if (disp == NULL) {
+        return NULL;
+    }
+
+    /* Full-size buffers in direct mode: the flushed one always holds the
+     * whole frame, so a dump is a plain copy of it */
+    for (i = 0; i < buffer_count; i++) {
+        framebuffers[i] = lv_draw_buf_create(settings.window_width, settings.window_height,
+                                             lv_display_get_color_format(disp), LV_STRIDE_AUTO);
+
+        if (framebuffers[i] == NULL) {
+            if (i > 0) {
+                lv_draw_buf_destroy(framebuffers[0]);
+            }
+            lv_display_delete(disp);
+            return NULL;
+        }
+    }
+
+    lv_display_set_draw_buffers(disp, framebuffers[0], framebuffers[1]);
+    lv_display_set_render_mode(disp, LV_DISPLAY_RENDER_MODE_DIRECT);
+    lv_display_set_flush_cb(disp, flush_cb);
+    lv_display_add_event_cb(disp, refr_start_cb, LV_EVENT_REFR_START, NULL);
+
+    if (step_ms > 0) {
+        lv_tick_set_cb(virtual_tick_cb);
+    }
+
+    if (duration_ms > 0) {
+        lv_timer_t *timer = lv_timer_create(duration_timer_cb, duration_ms, NULL);
+        lv_timer_set_repeat_count(timer, 1);
+    }
+
+    return disp;
+}
+
+/**
+ * The run loop of the headless driver
+ *
+ * @description Free-running, it sleeps in the shared event loop like the
+ * other backends. With a fixed step, LVGL time advances by step_ms per
+ * iteration and nothing sleeps, so the run is as fast and as reproducible
+ * as the machine allows. Either way it returns once the frame or duration
+ * limit is reached and prints the frame statistics.
+ */
+static void run_loop_headless(void)
+{
+    uint64_t start_ns = now_ns();
+    uint64_t wall_ns;
+
+    if (step_ms == 0) {
+        event_loop_run();
+    } else {
+        while (!done) {
+            event_loop_poll_wakeups();
+            frame_stats_timer_handler();
+            virtual_ms += step_ms;
+        }
+    }
+
+    wall_ns = now_ns() - start_ns;
+
+    fprintf(stdout, "HEADLESS: %" PRIu32 " frames, %.1f ms wall", frame_count, wall_ns / 1e6);
+    if (step_ms > 0) {
+        fprintf(stdout, ", %" PRIu32 " ms virtual", virtual_ms);
+    }
+    if (frame_count > 0) {
+        fprintf(stdout, ", render avg %.3f ms max %.3f ms",
+                render_total_ns / 1e6 / frame_count, render_max_ns / 1e6);
+    }
+    fprintf(stdout, "\n");
+
+    frame_stats_dump();
+}
+
+static void refr_start_cb(lv_event_t *e)
+{
+    LV_UNUSED(e);
+    frame_start_ns = now_ns();
+}
+
+/**
+ * Called once per invalidated area; the frame is complete on the last one
+ */
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    uint64_t render_ns;
+
+    damage_add(&damage, area);
+
+    if (lv_display_flush_is_last(disp)) {
+        render_ns = now_ns() - frame_start_ns;
+        render_total_ns += render_ns;
+        if (render_ns > render_max_ns) {
+            render_max_ns = render_ns;
+        }
+
+        frame_stats_damage(damage_get_pixels(&damage));
+        damage_clear(&damage);
+
+        if (dump_dir != NULL) {
+            dump_frame(px_map == framebuffers[0]->data ? framebuffers[0] : framebuffers[1], frame_count);
+        }
+
+        frame_count++;
+        if (max_frames > 0 && frame_count >= max_frames) {
+            stop();
+        }
+    }
+
+    lv_display_flush_ready(disp);
+}
+
+static void duration_timer_cb(lv_timer_t *timer)
+{
+    LV_UNUSED(timer);
+    stop();
+}
+
+static uint32_t virtual_tick_cb(void)
+{
+    return virtual_ms;
+}
+
+static void stop(void)
+{
+    done = true;
+    event_loop_quit();
+}
+
+/**
+ * Write a framebuffer to <dump_dir>/frame_NNNNNN.ppm
+ *
+ * @param buf the framebuffer holding the frame
+ * @param frame the frame number
+ */
+static void dump_frame(const lv_draw_buf_t *buf, uint32_t frame)
+{
+    char path[512];
+    uint32_t w = buf->header.w;
+    uint32_t h = buf->header.h;
+    lv_color_format_t cf = buf->header.cf;
+    uint8_t *row_rgb;
+    FILE *f;
+    uint32_t x;
+    uint32_t y;
+
+    snprintf(path, sizeof(path), "%s/frame_%06" PRIu32 ".ppm", dump_dir, frame);
+    f = fopen(path, "wb");
+    if (f == NULL) {
+        LV_LOG_ERROR("Failed to open %s: %s", path, strerror(errno));
+        dump_dir = NULL;
+        return;
+    }
+
+    row_rgb = malloc(w * 3);
+    LV_ASSERT_NULL(row_rgb);
+
+    fprintf(f, "P6\n%" PRIu32 " %" PRIu32 "\n255\n", w, h);
+
+    for (y = 0; y < h; y++) {
+        const uint8_t *src = buf->data + y * buf->header.stride;
+
+        for (x = 0; x < w; x++) {
+            uint8_t *dst = row_rgb + x * 3;
+
+            if (cf == LV_COLOR_FORMAT_RGB565) {
+                uint16_t c = ((const uint16_t *)src)[x];
+                dst[0] = (uint8_t)(((c >> 11) & 0x1F) * 255 / 31);
+                dst[1] = (uint8_t)(((c >> 5) & 0x3F) * 255 / 63);
+                dst[2] = (uint8_t)((c & 0x1F) * 255 / 31);
+            } else {
+                /* RGB888, XRGB8888 and ARGB8888 are stored as B, G, R(, X) */
+                uint32_t px_size = lv_color_format_get_size(cf);
+                dst[0] = src[x * px_size + 2];
+                dst[1] = src[x * px_size + 1];
+                dst[2] = src[x * px_size + 0];
+            }
+        }
+
+        fwrite(row_rgb, 3, w, f);
+    }
+
+    free(row_rgb);
+    fclose(f);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#endif /*#if LV_SIM_USE_HEADLESS*/
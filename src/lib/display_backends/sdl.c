@@ -24,6 +24,7 @@
 #include "../simulator_util.h"
 #include "../simulator_settings.h"
 #include "../backends.h"
+#include "../event_loop.h"
 
 /*********************
  *      DEFINES
@@ -67,7 +68,7 @@ int backend_init_sdl(backend_t *backend)
 {
     LV_ASSERT_NULL(backend);
 
-    backend->handle->display = malloc(sizeof(display_backend_t));
+    backend->handle->display = calloc(1, sizeof(display_backend_t));
     LV_ASSERT_NULL(backend->handle->display);
 
     backend->handle->display->init_display = init_sdl;
@@ -105,13 +106,7 @@ static lv_display_t *init_sdl(void)
  */
 static void run_loop_sdl(void)
 {
-    uint32_t idle_time;
-
-    /* Handle LVGL tasks */
-    while (true) {
-        /* Returns the time to the next timer execution */
-        idle_time = lv_timer_handler();
-        usleep(idle_time * 1000);
-    }
+    /* Sleeps until a timer is due, input arrives or new data is signaled */
+    event_loop_run();
 }
 #endif /*#if LV_USE_SDL*/
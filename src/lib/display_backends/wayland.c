@@ -24,6 +24,7 @@
 #include "../simulator_util.h"
 #include "../simulator_settings.h"
 #include "../backends.h"
+#include "../event_loop.h"
 
 /*********************
  *      DEFINES
@@ -66,7 +67,7 @@ extern simulator_settings_t settings;
 int backend_init_wayland(backend_t *backend)
 {
     LV_ASSERT_NULL(backend);
-    backend->handle->display = malloc(sizeof(display_backend_t));
+    backend->handle->display = calloc(1, sizeof(display_backend_t));
     LV_ASSERT_NULL(backend->handle->display);
 
     backend->handle->display->init_display = init_wayland;
@@ -127,6 +128,9 @@ static void run_loop_wayland(void)
     /* Handle LVGL tasks */
     while (true) {
 
+        /* The Wayland driver keeps its own loop: only pick up data wakeups */
+        event_loop_poll_wakeups();
+
         idle_time = lv_wayland_timer_handler();
 
         if(idle_time != 0) {
@@ -25,6 +25,7 @@
 #include "../simulator_util.h"
 #include "../simulator_settings.h"
 #include "../backends.h"
+#include "../event_loop.h"
 
 /*********************
  *      DEFINES
@@ -67,7 +68,7 @@ static char *backend_name = "X11";
 int backend_init_x11(backend_t *backend)
 {
     LV_ASSERT_NULL(backend);
-    backend->handle->display = malloc(sizeof(display_backend_t));
+    backend->handle->display = calloc(1, sizeof(display_backend_t));
     LV_ASSERT_NULL(backend->handle->display);
 
     backend->name = backend_name;
@@ -111,14 +112,8 @@ static lv_display_t *init_x11(void)
  */
 void run_loop_x11(void)
 {
-    uint32_t idle_time;
-
-    /* Handle LVGL tasks */
-    while (true) {
-        /* Returns the time to the next timer execution */
-        idle_time = lv_timer_handler();
-        usleep(idle_time * 1000);
-    }
+    /* Sleeps until a timer is due, input arrives or new data is signaled */
+    event_loop_run();
 }
 
 #endif /*#if LV_USE_X11*/
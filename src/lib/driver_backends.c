@@ -24,6 +24,8 @@
 #include "simulator_util.h"
 #include "simulator_settings.h"
 #include "driver_backends.h"
+#include "frame_stats.h"
+#include "refresh_governor.h"
 
 #include "backends.h"
 
@@ -37,7 +39,8 @@
     LV_USE_LINUX_DRM == 0 && \
     LV_USE_GLFW == 0 && \
     LV_USE_X11 == 0 && \
-    LV_USE_LINUX_FBDEV == 0
+    LV_USE_LINUX_FBDEV == 0 && \
+    LV_SIM_USE_HEADLESS == 0
 
 #error Unsupported configuration - Please select at least one graphics backend in lv_conf.h
 #endif
@@ -84,6 +87,10 @@ backend_init_t available_backends[] = {
     backend_init_glfw3,
 #endif
 
+#if LV_SIM_USE_HEADLESS
+    backend_init_headless,
+#endif
+
 #if LV_USE_EVDEV
     backend_init_evdev,
 #endif
@@ -144,6 +151,7 @@ int driver_backends_init_backend(char *backend_name)
     int i;
     display_backend_t *dispb;
     indev_backend_t *indevb;
+    lv_indev_t *indev;
 
     if (backends[0] == NULL) {
         LV_LOG_ERROR("Please call driver_backends_register first");
@@ -186,6 +194,12 @@ int driver_backends_init_backend(char *backend_name)
                 }
 
                 sel_display_backend = b;
+                frame_stats_attach(dispb->display);
+                /* A display nothing can wake or blank (HEADLESS) keeps the
+                 * full rate; slowing it down would only skew its timings */
+                if (dispb->blank != NULL || lv_indev_get_next(NULL) != NULL) {
+                    refresh_governor_attach(dispb->display, dispb->blank);
+                }
                 LV_LOG_INFO("Initialized %s display backend", b->name);
                 break;
 
@@ -208,7 +222,10 @@ int driver_backends_init_backend(char *backend_name)
                 dispb = sel_display_backend->handle->display;
 
                 LV_ASSERT_NULL(dispb->display);
-                indevb->init_indev(dispb->display);
+                indev = indevb->init_indev(dispb->display);
+                if (indev != NULL) {
+                    refresh_governor_add_indev(indev);
+                }
                 break;
             }
         }
@@ -0,0 +1,363 @@
+/**
+ * @file event_loop.c
+ *
+ * Event driven run loop shared by the display backends
+ *
+ * Replaces the lv_timer_handler(); usleep(idle_time) loops: the LVGL
+ * thread sleeps in epoll_wait() until the next LVGL timer is due, an input
+ * device has events or another thread signals new data.
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#include "event_loop.h"
+#include "frame_stats.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define EVENT_LOOP_MAX_INDEVS 8
+#define EVENT_LOOP_MAX_WAKEUP_CBS 4
+#define EVENT_LOOP_MAX_EVENTS (EVENT_LOOP_MAX_INDEVS + 2)
+
+/* epoll user data of the two internal fds, input devices use their index */
+#define TAG_TIMER UINT32_MAX
+#define TAG_WAKEUP (UINT32_MAX - 1)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct {
+    lv_indev_t *indev;
+    int fd;
+} loop_indev_t;
+
+typedef struct {
+    event_loop_wakeup_cb_t cb;
+    void *user_data;
+} loop_wakeup_cb_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static void loop_init(void);
+static int loop_add_fd(int fd, uint32_t tag);
+static void arm_timer(uint32_t ms);
+static bool drain_fd(int fd);
+static void run_wakeup_cbs(void);
+static bool read_held_indevs(void);
+static void run_loop_fallback(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+static int epoll_fd = -1;
+static int timer_fd = -1;
+static int wakeup_fd = -1;
+
+static loop_indev_t indevs[EVENT_LOOP_MAX_INDEVS];
+static int indev_count;
+
+static loop_wakeup_cb_t wakeup_cbs[EVENT_LOOP_MAX_WAKEUP_CBS];
+static int wakeup_cb_count;
+
+static bool quit_requested;
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void event_loop_run(void)
+{
+    struct epoll_event events[EVENT_LOOP_MAX_EVENTS];
+    uint32_t idle_time;
+    int timeout;
+    int n;
+    int i;
+
+    pthread_once(&init_once, loop_init);
+    if (epoll_fd < 0) {
+        LV_LOG_WARN("epoll unavailable, falling back to polling");
+        run_loop_fallback();
+        return;
+    }
+
+    while (!quit_requested) {
+
+        /* Returns the time to the next timer execution */
+        idle_time = frame_stats_timer_handler();
+        if (quit_requested) {
+            break;
+        }
+
+        /* A held pointer sends no events, but long press and scroll
+         * throw still need it read at the refresh rate */
+        if (read_held_indevs() && idle_time > LV_DEF_REFR_PERIOD) {
+            idle_time = LV_DEF_REFR_PERIOD;
+        }
+
+        if (idle_time == 0) {
+            /* Something is due already - only collect pending events */
+            timeout = 0;
+        } else {
+            arm_timer(idle_time);
+            timeout = -1;
+        }
+
+        n = epoll_wait(epoll_fd, events, EVENT_LOOP_MAX_EVENTS, timeout);
+        if (n < 0) {
+            if (errno != EINTR) {
+                LV_LOG_ERROR("epoll_wait failed: %s", strerror(errno));
+                run_loop_fallback();
+                return;
+            }
+            continue;
+        }
+
+        for (i = 0; i < n; i++) {
+            uint32_t tag = events[i].data.u32;
+
+            if (tag == TAG_TIMER) {
+                drain_fd(timer_fd);
+            } else if (tag == TAG_WAKEUP) {
+                if (drain_fd(wakeup_fd)) {
+                    run_wakeup_cbs();
+                }
+            } else if (tag < (uint32_t)indev_count) {
+                lv_lock();
+                lv_indev_read(indevs[tag].indev);
+                lv_unlock();
+            }
+        }
+    }
+}
+
+void event_loop_wakeup(void)
+{
+    uint64_t one = 1;
+
+    pthread_once(&init_once, loop_init);
+    if (wakeup_fd < 0) {
+        return;
+    }
+
+    /* Can only fail with EAGAIN when the counter is saturated, in which
+     * case the loop is already awake */
+    if (write(wakeup_fd, &one, sizeof(one)) < 0) {
+        return;
+    }
+}
+
+void event_loop_quit(void)
+{
+    quit_requested = true;
+}
+
+int event_loop_add_wakeup_cb(event_loop_wakeup_cb_t cb, void *user_data)
+{
+    LV_ASSERT_NULL(cb);
+
+    if (wakeup_cb_count >= EVENT_LOOP_MAX_WAKEUP_CBS) {
+        LV_LOG_ERROR("Too many wakeup callbacks");
+        return -1;
+    }
+
+    wakeup_cbs[wakeup_cb_count].cb = cb;
+    wakeup_cbs[wakeup_cb_count].user_data = user_data;
+    wakeup_cb_count++;
+
+    return 0;
+}
+
+int event_loop_add_indev(lv_indev_t *indev, int fd)
+{
+    LV_ASSERT_NULL(indev);
+
+    pthread_once(&init_once, loop_init);
+    if (epoll_fd < 0) {
+        return -1;
+    }
+
+    if (indev_count >= EVENT_LOOP_MAX_INDEVS) {
+        LV_LOG_ERROR("Too many input devices");
+        return -1;
+    }
+
+    if (loop_add_fd(fd, (uint32_t)indev_count) < 0) {
+        return -1;
+    }
+
+    indevs[indev_count].indev = indev;
+    indevs[indev_count].fd = fd;
+    indev_count++;
+
+    lv_indev_set_mode(indev, LV_INDEV_MODE_EVENT);
+
+    return 0;
+}
+
+void event_loop_poll_wakeups(void)
+{
+    pthread_once(&init_once, loop_init);
+
+    /* Without an eventfd wakeups cannot be seen: assume one */
+    if (wakeup_fd < 0 || drain_fd(wakeup_fd)) {
+        run_wakeup_cbs();
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Create the epoll instance, the timerfd and the eventfd
+ *
+ * @description On failure epoll_fd stays -1 and the loop polls instead
+ */
+static void loop_init(void)
+{
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (epoll_fd < 0 || timer_fd < 0 || wakeup_fd < 0 ||
+        loop_add_fd(timer_fd, TAG_TIMER) < 0 ||
+        loop_add_fd(wakeup_fd, TAG_WAKEUP) < 0) {
+
+        LV_LOG_ERROR("Failed to set up the event loop: %s", strerror(errno));
+
+        if (epoll_fd >= 0) {
+            close(epoll_fd);
+            epoll_fd = -1;
+        }
+        if (timer_fd >= 0) {
+            close(timer_fd);
+            timer_fd = -1;
+        }
+        if (wakeup_fd >= 0) {
+            close(wakeup_fd);
+            wakeup_fd = -1;
+        }
+    }
+}
+
+static int loop_add_fd(int fd, uint32_t tag)
+{
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = tag;
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        LV_LOG_ERROR("epoll_ctl failed for fd %d: %s", fd, strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Arm the timerfd to expire in `ms` milliseconds
+ *
+ * @param ms LV_NO_TIMER_READY disarms it: only input or a wakeup ends the wait
+ */
+static void arm_timer(uint32_t ms)
+{
+    struct itimerspec its;
+
+    memset(&its, 0, sizeof(its));
+    if (ms != LV_NO_TIMER_READY) {
+        its.it_value.tv_sec = ms / 1000;
+        its.it_value.tv_nsec = (long)(ms % 1000) * 1000000L;
+    }
+
+    timerfd_settime(timer_fd, 0, &its, NULL);
+}
+
+/**
+ * Reset a timerfd or eventfd counter
+ *
+ * @return true if it had been signaled
+ */
+static bool drain_fd(int fd)
+{
+    uint64_t count;
+
+    return read(fd, &count, sizeof(count)) == sizeof(count) && count > 0;
+}
+
+static void run_wakeup_cbs(void)
+{
+    int i;
+
+    lv_lock();
+    for (i = 0; i < wakeup_cb_count; i++) {
+        wakeup_cbs[i].cb(wakeup_cbs[i].user_data);
+    }
+    lv_unlock();
+}
+
+/**
+ * Read the input devices whose last state was pressed
+ *
+ * @return true if any is still held
+ */
+static bool read_held_indevs(void)
+{
+    bool held = false;
+    int i;
+
+    lv_lock();
+    for (i = 0; i < indev_count; i++) {
+        if (lv_indev_get_state(indevs[i].indev) == LV_INDEV_STATE_PRESSED) {
+            lv_indev_read(indevs[i].indev);
+            held = held || lv_indev_get_state(indevs[i].indev) == LV_INDEV_STATE_PRESSED;
+        }
+    }
+    lv_unlock();
+
+    return held;
+}
+
+/**
+ * The previous polling loop, used when epoll is unavailable
+ *
+ * @description Wakeups cannot be seen here, so the callbacks run on every
+ * iteration
+ */
+static void run_loop_fallback(void)
+{
+    uint32_t idle_time;
+
+    while (!quit_requested) {
+        run_wakeup_cbs();
+        idle_time = frame_stats_timer_handler();
+        if (idle_time == LV_NO_TIMER_READY) {
+            idle_time = LV_DEF_REFR_PERIOD;
+        }
+        usleep(idle_time * 1000);
+    }
+}
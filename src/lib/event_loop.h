@@ -0,0 +1,92 @@
+/**
+ * @file event_loop.h
+ *
+ * Event driven run loop shared by the display backends
+ *
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl/lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/* Called on the LVGL thread after another thread called event_loop_wakeup() */
+typedef void (*event_loop_wakeup_cb_t)(void *user_data);
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * @brief Run LVGL until event_loop_quit() is called
+ * @description Sleeps in epoll_wait() on a timerfd armed with the time to
+ * the next LVGL timer, the registered input device fds and an eventfd
+ * signaled by event_loop_wakeup(). The process stays asleep while nothing
+ * is due, and wakes up at once on input or new data.
+ */
+void event_loop_run(void);
+
+/**
+ * @brief Wake the run loop up
+ * @description Safe to call from any thread. The wakeup callbacks run on the
+ * LVGL thread before the next lv_timer_handler() call.
+ */
+void event_loop_wakeup(void);
+
+/**
+ * @brief Make event_loop_run() return
+ * @description Call from the LVGL thread, e.g. from an LVGL timer or a
+ * flush callback; the loop returns after the current iteration.
+ */
+void event_loop_quit(void);
+
+/**
+ * @brief Register a callback run on the LVGL thread after each wakeup
+ * @description Callbacks may also run without a wakeup when the loop has
+ * to fall back to polling; they must be cheap and idempotent.
+ * @param cb the callback
+ * @param user_data passed to the callback
+ * @return 0 on success, -1 if there is no free callback slot
+ */
+int event_loop_add_wakeup_cb(event_loop_wakeup_cb_t cb, void *user_data);
+
+/**
+ * @brief Read an input device when its fd becomes readable
+ * @description Switches `indev` to LV_INDEV_MODE_EVENT, so it is no longer
+ * polled by its read timer. `fd` must be non-blocking.
+ * @param indev the input device
+ * @param fd the file descriptor the device reads from
+ * @return 0 on success, -1 on error
+ */
+int event_loop_add_indev(lv_indev_t *indev, int fd);
+
+/**
+ * @brief Run the pending wakeup callbacks without blocking
+ * @description For backends that keep their own loop (Wayland)
+ */
+void event_loop_poll_wakeups(void);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*EVENT_LOOP_H*/
@@ -0,0 +1,462 @@
+/**
+ * @file frame_stats.c
+ *
+ * Frame timing instrumentation and performance HUD
+ *
+ * Timestamps the display refresh events (LV_EVENT_REFR_START, RENDER_START,
+ * FLUSH_START/FINISH, FLUSH_WAIT_START/FINISH, RENDER_READY, REFR_READY)
+ * and the lv_timer_handler() call around them to split every frame into
+ * timer, layout, render and flush time. A frame costs a handful of
+ * clock_gettime() calls, so it is always on.
+ *
+ * Touch-to-pixel latency runs from the kernel timestamp of an input event
+ * to the end of the first frame rendered after LVGL read it, i.e. when the
+ * frame has been flushed to the display.
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "simulator_util.h"
+#include "frame_stats.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define SLOW_FRAME_CNT 16
+#define HUD_PERIOD 500 /* ms */
+#define HUD_EXTRA_MAX 128
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct {
+    uint32_t tick;                           /* lv_tick_get() at refresh start */
+    uint32_t phase_us[FRAME_STATS_PHASE_CNT];
+    uint32_t total_us;
+} frame_record_t;
+
+/* Totals since the last HUD update */
+typedef struct {
+    uint32_t frames;
+    uint32_t overruns;
+    uint64_t phase_sum_us[FRAME_STATS_PHASE_CNT];
+    uint32_t total_max_us;
+    uint32_t inputs;
+    uint64_t latency_sum_us;
+    uint32_t latency_max_us;
+    uint32_t damage_frames;
+    uint64_t damage_px;
+} frame_window_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static void refr_event_cb(lv_event_t *e);
+static void record_frame(const frame_record_t *frame);
+static void record_latency(uint64_t now);
+static void hud_timer_cb(lv_timer_t *timer);
+static void format_ms(char *buf, size_t size, const char *label, uint64_t us);
+static uint64_t now_us(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/* Upper bounds of the histogram buckets in ms; the last bucket is open */
+static const uint32_t bucket_ms[] = { 2, 4, 8, 16, 33, 66, 133 };
+#define BUCKET_CNT (sizeof(bucket_ms) / sizeof(bucket_ms[0]) + 1)
+
+static uint32_t slow_frame_us = 50000;
+
+/* The frame in progress */
+static uint64_t handler_start_us;   /* 0 outside frame_stats_timer_handler() */
+static uint64_t handler_refr_us;    /* refresh time inside the current handler call */
+static uint64_t refr_start_us;
+static uint64_t render_start_us;
+static uint64_t flush_start_us;
+static uint64_t flush_us;
+static bool rendered;
+static frame_record_t current;
+
+/* Totals since start */
+static uint32_t histogram[BUCKET_CNT];
+static uint32_t frame_count;
+static uint32_t overrun_count;
+static uint64_t phase_total_us[FRAME_STATS_PHASE_CNT];
+
+/* The last slow frames, oldest overwritten first */
+static frame_record_t slow_frames[SLOW_FRAME_CNT];
+static uint32_t slow_frame_count;
+
+/* Touch-to-pixel latency */
+static uint64_t input_pending_us;   /* oldest input not shown yet, 0 if none */
+static uint32_t latency_count;
+static uint64_t latency_total_us;
+static uint32_t latency_max_us;
+
+/* Damage reported by the backend */
+static uint32_t screen_px;
+static uint32_t damage_frames;
+static uint64_t damage_total_px;
+
+static frame_window_t window;
+static uint32_t window_start_tick;
+
+static lv_obj_t *hud_label;
+static lv_timer_t *hud_timer;
+static frame_stats_hud_cb_t hud_extra_cb;
+static frame_stats_frame_cb_t frame_cb;
+
+static const char *phase_names[FRAME_STATS_PHASE_CNT] = { "timers", "layout", "render", "flush" };
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void frame_stats_attach(lv_display_t *disp)
+{
+    LV_ASSERT_NULL(disp);
+
+    slow_frame_us = (uint32_t)atoi(getenv_default("LV_SIM_SLOW_FRAME_MS", "50")) * 1000;
+    screen_px = (uint32_t)(lv_display_get_horizontal_resolution(disp) *
+                           lv_display_get_vertical_resolution(disp));
+
+    lv_display_add_event_cb(disp, refr_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, refr_event_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, refr_event_cb, LV_EVENT_FLUSH_START, NULL);
+    lv_display_add_event_cb(disp, refr_event_cb, LV_EVENT_FLUSH_FINISH, NULL);
+    lv_display_add_event_cb(disp, refr_event_cb, LV_EVENT_FLUSH_WAIT_START, NULL);
+    lv_display_add_event_cb(disp, refr_event_cb, LV_EVENT_FLUSH_WAIT_FINISH, NULL);
+    lv_display_add_event_cb(disp, refr_event_cb, LV_EVENT_RENDER_READY, NULL);
+    lv_display_add_event_cb(disp, refr_event_cb, LV_EVENT_REFR_READY, NULL);
+
+    if (getenv("LV_SIM_HUD") != NULL) {
+        frame_stats_hud_set_visible(true);
+    }
+}
+
+uint32_t frame_stats_timer_handler(void)
+{
+    uint32_t idle_time;
+    uint64_t timers_us;
+
+    handler_start_us = now_us();
+    handler_refr_us = 0;
+
+    idle_time = lv_timer_handler();
+
+    timers_us = now_us() - handler_start_us - handler_refr_us;
+    handler_start_us = 0;
+
+    if (timers_us > LV_DEF_REFR_PERIOD * 1000) {
+        overrun_count++;
+        window.overruns++;
+    }
+
+    return idle_time;
+}
+
+void frame_stats_set_frame_cb(frame_stats_frame_cb_t cb)
+{
+    frame_cb = cb;
+}
+
+void frame_stats_input(uint64_t timestamp_us)
+{
+    if (input_pending_us == 0) {
+        input_pending_us = timestamp_us;
+    }
+}
+
+void frame_stats_damage(uint32_t pixels)
+{
+    damage_frames++;
+    damage_total_px += pixels;
+    window.damage_frames++;
+    window.damage_px += pixels;
+}
+
+void frame_stats_dump(void)
+{
+    uint32_t first;
+    uint32_t n;
+    uint32_t i;
+    int p;
+
+    fprintf(stdout, "Frames: %u, timer overruns: %u\n", frame_count, overrun_count);
+    if (frame_count == 0) {
+        return;
+    }
+
+    fprintf(stdout, "Average per frame:");
+    for (p = 0; p < FRAME_STATS_PHASE_CNT; p++) {
+        fprintf(stdout, " %s %.3f ms", phase_names[p],
+                (double)phase_total_us[p] / frame_count / 1000.0);
+    }
+    fprintf(stdout, "\n");
+
+    fprintf(stdout, "Frame time histogram:\n");
+    for (i = 0; i < BUCKET_CNT; i++) {
+        if (i < BUCKET_CNT - 1) {
+            fprintf(stdout, "  < %3u ms: %u\n", bucket_ms[i], histogram[i]);
+        } else {
+            fprintf(stdout, "  >=%3u ms: %u\n", bucket_ms[i - 1], histogram[i]);
+        }
+    }
+
+    n = LV_MIN(slow_frame_count, SLOW_FRAME_CNT);
+    first = slow_frame_count - n;
+    fprintf(stdout, "Slow frames (> %u ms): %u\n", slow_frame_us / 1000, slow_frame_count);
+    for (i = first; i < slow_frame_count; i++) {
+        const frame_record_t *f = &slow_frames[i % SLOW_FRAME_CNT];
+        fprintf(stdout, "  @%u ms: %.1f ms (timers %.1f layout %.1f render %.1f flush %.1f)\n",
+                f->tick, f->total_us / 1000.0,
+                f->phase_us[FRAME_STATS_TIMERS] / 1000.0, f->phase_us[FRAME_STATS_LAYOUT] / 1000.0,
+                f->phase_us[FRAME_STATS_RENDER] / 1000.0, f->phase_us[FRAME_STATS_FLUSH] / 1000.0);
+    }
+
+    if (latency_count > 0) {
+        fprintf(stdout, "Touch to pixel: %u inputs, avg %.1f ms, max %.1f ms\n", latency_count,
+                (double)latency_total_us / latency_count / 1000.0, latency_max_us / 1000.0);
+    }
+
+    if (damage_frames > 0 && screen_px > 0) {
+        fprintf(stdout, "Damage: avg %.0f px/frame, %.1f%% of the screen\n",
+                (double)damage_total_px / damage_frames,
+                100.0 * damage_total_px / damage_frames / screen_px);
+    }
+}
+
+void frame_stats_hud_set_visible(bool visible)
+{
+    if (!visible) {
+        if (hud_timer != NULL) {
+            lv_timer_delete(hud_timer);
+            hud_timer = NULL;
+        }
+        if (hud_label != NULL) {
+            lv_obj_delete(hud_label);
+            hud_label = NULL;
+        }
+        return;
+    }
+
+    if (hud_label != NULL) {
+        return;
+    }
+
+    /* On the system layer it stays above every screen and popup */
+    hud_label = lv_label_create(lv_layer_sys());
+    lv_obj_set_style_bg_color(hud_label, lv_color_black(), 0);
+    lv_obj_set_style_bg_opa(hud_label, LV_OPA_70, 0);
+    lv_obj_set_style_text_color(hud_label, lv_color_hex(0x00FF66), 0);
+    lv_obj_set_style_text_font(hud_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_pad_all(hud_label, 4, 0);
+    lv_obj_align(hud_label, LV_ALIGN_TOP_LEFT, 0, 0);
+    lv_obj_remove_flag(hud_label, LV_OBJ_FLAG_CLICKABLE);
+    lv_label_set_text(hud_label, "...");
+
+    memset(&window, 0, sizeof(window));
+    window_start_tick = lv_tick_get();
+    hud_timer = lv_timer_create(hud_timer_cb, HUD_PERIOD, NULL);
+}
+
+void frame_stats_hud_toggle(void)
+{
+    frame_stats_hud_set_visible(hud_label == NULL);
+}
+
+void frame_stats_hud_set_extra_cb(frame_stats_hud_cb_t cb)
+{
+    hud_extra_cb = cb;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void refr_event_cb(lv_event_t *e)
+{
+    uint64_t t = now_us();
+
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_REFR_START:
+        refr_start_us = t;
+        flush_us = 0;
+        rendered = false;
+        memset(&current, 0, sizeof(current));
+        current.tick = lv_tick_get();
+        /* Timers that ran earlier in the same handler call */
+        if (handler_start_us != 0) {
+            current.phase_us[FRAME_STATS_TIMERS] = (uint32_t)(t - handler_start_us - handler_refr_us);
+        }
+        break;
+    case LV_EVENT_RENDER_START:
+        render_start_us = t;
+        current.phase_us[FRAME_STATS_LAYOUT] = (uint32_t)(t - refr_start_us);
+        break;
+    case LV_EVENT_FLUSH_START:
+    case LV_EVENT_FLUSH_WAIT_START:
+        flush_start_us = t;
+        break;
+    case LV_EVENT_FLUSH_FINISH:
+    case LV_EVENT_FLUSH_WAIT_FINISH:
+        flush_us += t - flush_start_us;
+        break;
+    case LV_EVENT_RENDER_READY:
+        rendered = true;
+        current.phase_us[FRAME_STATS_RENDER] = (uint32_t)(t - render_start_us - flush_us);
+        current.phase_us[FRAME_STATS_FLUSH] = (uint32_t)flush_us;
+        break;
+    case LV_EVENT_REFR_READY:
+        handler_refr_us += t - refr_start_us;
+        /* Refreshes with nothing invalidated are not frames */
+        if (rendered) {
+            current.total_us = (uint32_t)(t - refr_start_us) + current.phase_us[FRAME_STATS_TIMERS];
+            record_frame(&current);
+            record_latency(t);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void record_frame(const frame_record_t *frame)
+{
+    uint32_t i;
+    int p;
+
+    frame_count++;
+    window.frames++;
+
+    for (p = 0; p < FRAME_STATS_PHASE_CNT; p++) {
+        phase_total_us[p] += frame->phase_us[p];
+        window.phase_sum_us[p] += frame->phase_us[p];
+    }
+    window.total_max_us = LV_MAX(window.total_max_us, frame->total_us);
+
+    for (i = 0; i < BUCKET_CNT - 1; i++) {
+        if (frame->total_us < bucket_ms[i] * 1000) {
+            break;
+        }
+    }
+    histogram[i]++;
+
+    if (frame_cb != NULL) {
+        frame_cb(frame->phase_us, frame->total_us);
+    }
+
+    if (frame->total_us > slow_frame_us) {
+        slow_frames[slow_frame_count % SLOW_FRAME_CNT] = *frame;
+        slow_frame_count++;
+        fprintf(stderr, "SLOW FRAME: %.1f ms (timers %.1f layout %.1f render %.1f flush %.1f)\n",
+                frame->total_us / 1000.0,
+                frame->phase_us[FRAME_STATS_TIMERS] / 1000.0, frame->phase_us[FRAME_STATS_LAYOUT] / 1000.0,
+                frame->phase_us[FRAME_STATS_RENDER] / 1000.0, frame->phase_us[FRAME_STATS_FLUSH] / 1000.0);
+    }
+}
+
+static void record_latency(uint64_t now)
+{
+    uint32_t latency_us;
+
+    if (input_pending_us == 0) {
+        return;
+    }
+
+    /* Clamp a timestamp slightly ahead of now rather than wrapping */
+    latency_us = now > input_pending_us ? (uint32_t)(now - input_pending_us) : 0;
+    input_pending_us = 0;
+
+    latency_count++;
+    latency_total_us += latency_us;
+    latency_max_us = LV_MAX(latency_max_us, latency_us);
+
+    window.inputs++;
+    window.latency_sum_us += latency_us;
+    window.latency_max_us = LV_MAX(window.latency_max_us, latency_us);
+}
+
+static void hud_timer_cb(lv_timer_t *timer)
+{
+    char text[448];
+    char touch[64];
+    char damage[32];
+    char extra[HUD_EXTRA_MAX];
+    char phase[4][32];
+    uint32_t elapsed = lv_tick_elaps(window_start_tick);
+    uint32_t frames = window.frames;
+    int p;
+
+    LV_UNUSED(timer);
+
+    if (elapsed == 0) {
+        elapsed = 1;
+    }
+
+    for (p = 0; p < FRAME_STATS_PHASE_CNT; p++) {
+        format_ms(phase[p], sizeof(phase[p]), phase_names[p],
+                  frames ? window.phase_sum_us[p] / frames : 0);
+    }
+
+    touch[0] = '\0';
+    if (window.inputs > 0) {
+        snprintf(touch, sizeof(touch), "touch %.1f ms  max %.1f ms\n",
+                 (double)window.latency_sum_us / window.inputs / 1000.0,
+                 window.latency_max_us / 1000.0);
+    }
+
+    damage[0] = '\0';
+    if (window.damage_frames > 0 && screen_px > 0) {
+        snprintf(damage, sizeof(damage), "damage %.1f%%\n",
+                 100.0 * window.damage_px / window.damage_frames / screen_px);
+    }
+
+    extra[0] = '\0';
+    if (hud_extra_cb != NULL) {
+        hud_extra_cb(extra, sizeof(extra));
+    }
+
+    /* The HUD's own redraws are included: it is one small label */
+    snprintf(text, sizeof(text),
+             "%.1f fps  worst %.1f ms\n%s %s\n%s %s\n"
+             "overruns %u  slow %u\n%s%s%s",
+             frames * 1000.0 / elapsed, window.total_max_us / 1000.0,
+             phase[FRAME_STATS_TIMERS], phase[FRAME_STATS_LAYOUT],
+             phase[FRAME_STATS_RENDER], phase[FRAME_STATS_FLUSH],
+             window.overruns, slow_frame_count, touch, damage, extra);
+    lv_label_set_text(hud_label, text);
+
+    memset(&window, 0, sizeof(window));
+    window_start_tick = lv_tick_get();
+}
+
+static void format_ms(char *buf, size_t size, const char *label, uint64_t us)
+{
+    snprintf(buf, size, "%s %.2f", label, us / 1000.0);
+}
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
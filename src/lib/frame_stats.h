@@ -0,0 +1,117 @@
+/**
+ * @file frame_stats.h
+ *
+ * Frame timing instrumentation and performance HUD
+ *
+ */
+
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stddef.h>
+#include "lvgl/lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/* The phases a frame is split into */
+typedef enum {
+    FRAME_STATS_TIMERS,  /* LVGL timers other than the refresh, before the frame */
+    FRAME_STATS_LAYOUT,  /* refresh start to render start: layout and area joining */
+    FRAME_STATS_RENDER,  /* drawing the invalidated areas, without flushing */
+    FRAME_STATS_FLUSH,   /* flush callbacks and waiting for them */
+    FRAME_STATS_PHASE_CNT
+} frame_stats_phase_t;
+
+/* Called after every rendered frame with its phase times and total, in us */
+typedef void (*frame_stats_frame_cb_t)(const uint32_t *phase_us, uint32_t total_us);
+
+/* Fills `buf` with extra HUD lines, e.g. application queue depths */
+typedef void (*frame_stats_hud_cb_t)(char *buf, size_t size);
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * @brief Start timing the frames of a display
+ * @description Hooks the display refresh events. Shows the HUD right away
+ * if LV_SIM_HUD is set; LV_SIM_SLOW_FRAME_MS (default 50) sets the frame
+ * time above which a frame is logged and kept as a slow frame.
+ * @param disp the display
+ */
+void frame_stats_attach(lv_display_t *disp);
+
+/**
+ * @brief lv_timer_handler() with the time spent in timers recorded
+ * @description Run loops call this instead of lv_timer_handler(). Handler
+ * calls whose timers, not counting the refresh, take longer than a refresh
+ * period are counted as overruns.
+ * @return the time to the next timer execution, as lv_timer_handler()
+ */
+uint32_t frame_stats_timer_handler(void);
+
+/**
+ * @brief Set a callback receiving every rendered frame, e.g. to collect samples
+ * @param cb the callback, NULL for none
+ */
+void frame_stats_set_frame_cb(frame_stats_frame_cb_t cb);
+
+/**
+ * @brief Record input handed to LVGL, for touch-to-pixel latency
+ * @description The next rendered frame ends the latency of the oldest
+ * input recorded since the previous one. Call on the LVGL thread.
+ * @param timestamp_us the kernel timestamp of the input, CLOCK_MONOTONIC
+ */
+void frame_stats_input(uint64_t timestamp_us);
+
+/**
+ * @brief Record the pixels a frame flushed, from backends tracking damage
+ * @param pixels the damaged pixel count of the frame
+ */
+void frame_stats_damage(uint32_t pixels);
+
+/**
+ * @brief Print the frame time histogram, phase totals, slow frames,
+ * touch-to-pixel latency and damage
+ */
+void frame_stats_dump(void);
+
+/**
+ * @brief Show or hide the HUD on the system layer
+ * @param visible true to show it
+ */
+void frame_stats_hud_set_visible(bool visible);
+
+/**
+ * @brief Toggle the HUD
+ */
+void frame_stats_hud_toggle(void);
+
+/**
+ * @brief Set the callback providing extra HUD lines
+ * @param cb the callback, NULL for none
+ */
+void frame_stats_hud_set_extra_cb(frame_stats_hud_cb_t cb);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*FRAME_STATS_H*/
@@ -2,7 +2,7 @@
  *
  * @file evdev.c
  *
- * The lib evdev driver
+ * The evdev pointer driver
  *
  * Based on the original file from the repository
  *
@@ -10,38 +10,101 @@
  *   compilation
  *   Author: EDGEMTech Ltd, Erik Tagirov (erik.tagirov@edgemtech.ch)
  *
+ * - Read the device on its own thread
+ *
  * Copyright (c) 2025 EDGEMTech Ltd.
  *
+ * A dedicated thread blocks on the input device and turns every SYN_REPORT
+ * into a sample carrying the kernel timestamp of the report. Samples are
+ * queued and an eventfd wakes the LVGL run loop, which reads the pointer
+ * right away and readies the display refresh. Input is therefore neither
+ * delayed by the indev read period nor by a busy LVGL thread, and the
+ * timestamps feed the touch-to-pixel latency of frame_stats.
+ *
+ * Without LV_LINUX_EVDEV_POINTER_DEVICE the first touchscreen or mouse in
+ * /dev/input is used. The thread watches /dev/input with inotify, so a
+ * device plugged in later, or unplugged and plugged back, is picked up.
+ *
  */
 
 /*********************
  *      INCLUDES
  *********************/
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <dirent.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <linux/input.h>
 
 #include "lvgl/lvgl.h"
 #if LV_USE_EVDEV
 #include "lvgl/src/core/lv_global.h"
 #include "../backends.h"
+#include "../event_loop.h"
+#include "../frame_stats.h"
 
 /*********************
  *      DEFINES
  *********************/
 
+#define INPUT_DIR "/dev/input"
+
+#define QUEUE_LEN 256
+#define READ_BATCH 64
+#define MIN_FRAME_MS 16    /* input readies the refresh at most this often */
+#define RESCAN_MS 1000     /* device discovery period without inotify */
+
+#define BITS_PER_LONG (8 * sizeof(unsigned long))
+#define NLONGS(n) (((n) + BITS_PER_LONG - 1) / BITS_PER_LONG)
+#define TEST_BIT(bits, n) (((bits)[(n) / BITS_PER_LONG] >> ((n) % BITS_PER_LONG)) & 1)
+
 /**********************
  *      TYPEDEFS
  **********************/
 
+/* The pointer state at one SYN_REPORT */
+typedef struct {
+    int32_t x;              /* device coordinates, or motion for relative devices */
+    int32_t y;
+    bool rel;
+    bool pressed;
+    uint64_t timestamp_us;  /* kernel timestamp, CLOCK_MONOTONIC */
+} evdev_sample_t;
+
+typedef struct {
+    int32_t min;
+    int32_t max;
+} axis_range_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 
+static lv_indev_t *init_pointer_evdev(lv_display_t *display);
+static void read_cb(lv_indev_t *indev, lv_indev_data_t *data);
 static void indev_deleted_cb(lv_event_t *e);
-static void discovery_cb(lv_indev_t *indev, lv_evdev_type_t type, void *user_data);
 static void set_mouse_cursor_icon(lv_indev_t *indev, lv_display_t *display);
-static lv_indev_t *init_pointer_evdev(lv_display_t *display);
+static int32_t map_axis(int32_t v, axis_range_t range, int32_t res);
+
+static void *input_thread(void *arg);
+static int open_pointer_device(void);
+static int open_device(const char *path);
+static bool is_pointer_device(int fd);
+static bool read_device(int fd);
+static void handle_event(const struct input_event *ev);
+static void queue_push(const evdev_sample_t *sample);
+static uint64_t now_us(void);
 
 /**********************
  *  STATIC VARIABLES
@@ -49,6 +112,29 @@ static lv_indev_t *init_pointer_evdev(lv_display_t *display);
 
 static char *backend_name = "EVDEV";
 
+/* Shared with the input thread */
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static evdev_sample_t queue[QUEUE_LEN];
+static uint32_t queue_head;
+static uint32_t queue_count;
+static axis_range_t range_x;
+static axis_range_t range_y;
+static int notify_fd = -1;          /* eventfd the run loop waits on */
+static const char *device_path;     /* NULL: discover */
+
+/* LVGL thread */
+static lv_display_t *pointer_display;
+static lv_point_t point;
+static lv_indev_state_t state = LV_INDEV_STATE_RELEASED;
+static uint32_t last_ready_tick;
+static lv_obj_t *cursor_obj;
+
+/* Input thread */
+static evdev_sample_t current;
+static bool current_changed;
+static bool dropping;               /* after SYN_DROPPED, until the next report */
+static int mt_slot;
+
 /**********************
  *      MACROS
  **********************/
@@ -81,48 +167,138 @@ int backend_init_evdev(backend_t *backend)
  **********************/
 
 /*
- * Remove cursor icon
+ * Initialize a pointer device read by the input thread
  *
- * @description When the indev is deleted remove the mouse cursor icon
- * @note called by the LVGL evdev driver
- * @param e the deletion event
+ * Enables a pointer (touchscreen/mouse) input device
+ * Use 'evtest' to find the correct input device. /dev/input/by-id/ is recommended if possible
+ * Use /dev/input/by-id/my-mouse-or-touchscreen or /dev/input/eventX
+ *
+ * If LV_LINUX_EVDEV_POINTER_DEVICE is not set, the first pointer device found is used
+ *
+ * @param display the LVGL display
+ *
+ * @return input device
  */
-static void indev_deleted_cb(lv_event_t *e)
+static lv_indev_t *init_pointer_evdev(lv_display_t *display)
 {
-    if(LV_GLOBAL_DEFAULT()->deinit_in_progress) return;
-    lv_obj_t *cursor_obj = lv_event_get_user_data(e);
-    lv_obj_delete(cursor_obj);
-}
+    pthread_attr_t attr;
+    pthread_t thread;
+    lv_indev_t *indev;
+
+    device_path = getenv("LV_LINUX_EVDEV_POINTER_DEVICE");
+    if (device_path == NULL) {
+        LV_LOG_USER("Using evdev automatic discovery.");
+    }
+
+    notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (notify_fd < 0) {
+        LV_LOG_ERROR("eventfd failed: %s", strerror(errno));
+        return NULL;
+    }
+
+    pointer_display = display;
+    indev = lv_indev_create();
+    lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_read_cb(indev, read_cb);
+    lv_indev_set_display(indev, display);
+
+    /* Read when the thread signals samples instead of on the indev read timer */
+    if (event_loop_add_indev(indev, notify_fd) < 0) {
+        LV_LOG_WARN("Polling the evdev queue");
+    }
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&thread, &attr, input_thread, NULL) != 0) {
+        LV_LOG_ERROR("Failed to start the input thread");
+        pthread_attr_destroy(&attr);
+        lv_indev_delete(indev);
+        close(notify_fd);
+        notify_fd = -1;
+        return NULL;
+    }
+    pthread_attr_destroy(&attr);
 
+    return indev;
+}
 
 /*
- * Set cursor icon
+ * Hand the queued samples to LVGL, one per call
  *
- * @description Once the input device is discovered set the mouse cursor icon
- * @note called by the LVGL evdev driver
  * @param indev the input device
- * @param type the type of the input device
- * @param user_data the user data
+ * @param data the pointer state to fill
  */
-static void discovery_cb(lv_indev_t *indev, lv_evdev_type_t type, void *user_data)
+static void read_cb(lv_indev_t *indev, lv_indev_data_t *data)
 {
-    LV_LOG_USER("new '%s' device discovered", type == LV_EVDEV_TYPE_REL ? "REL" :
-                                              type == LV_EVDEV_TYPE_ABS ? "ABS" :
-                                              type == LV_EVDEV_TYPE_KEY ? "KEY" :
-                                              "unknown");
+    evdev_sample_t sample;
+    axis_range_t rx;
+    axis_range_t ry;
+    uint64_t count;
+    bool have;
+    int32_t hor_res = lv_display_get_horizontal_resolution(pointer_display);
+    int32_t ver_res = lv_display_get_vertical_resolution(pointer_display);
+
+    /* Samples queued after this are signaled again */
+    if (read(notify_fd, &count, sizeof(count)) < 0) {
+        /* EAGAIN: nothing signaled since the last read */
+    }
+
+    pthread_mutex_lock(&queue_lock);
+    have = queue_count > 0;
+    if (have) {
+        sample = queue[queue_head];
+        queue_head = (queue_head + 1) % QUEUE_LEN;
+        queue_count--;
+        data->continue_reading = queue_count > 0;
+    }
+    rx = range_x;
+    ry = range_y;
+    pthread_mutex_unlock(&queue_lock);
+
+    if (have) {
+        if (sample.rel) {
+            point.x = LV_CLAMP(0, point.x + sample.x, hor_res - 1);
+            point.y = LV_CLAMP(0, point.y + sample.y, ver_res - 1);
+            if (cursor_obj == NULL) {
+                set_mouse_cursor_icon(indev, pointer_display);
+            }
+        } else {
+            point.x = map_axis(sample.x, rx, hor_res);
+            point.y = map_axis(sample.y, ry, ver_res);
+        }
+        state = sample.pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
 
-    lv_display_t *disp = user_data;
-    lv_indev_set_display(indev, disp);
+        frame_stats_input(sample.timestamp_us);
 
-    if(type == LV_EVDEV_TYPE_REL) {
-        set_mouse_cursor_icon(indev, disp);
+        /* Show the result without waiting out the refresh period */
+        if (lv_tick_elaps(last_ready_tick) >= MIN_FRAME_MS) {
+            lv_timer_ready(lv_display_get_refr_timer(pointer_display));
+            last_ready_tick = lv_tick_get();
+        }
     }
+
+    data->point = point;
+    data->state = state;
+}
+
+/*
+ * Remove cursor icon
+ *
+ * @description When the indev is deleted remove the mouse cursor icon
+ * @param e the deletion event
+ */
+static void indev_deleted_cb(lv_event_t *e)
+{
+    if(LV_GLOBAL_DEFAULT()->deinit_in_progress) return;
+    lv_obj_t *obj = lv_event_get_user_data(e);
+    lv_obj_delete(obj);
+    cursor_obj = NULL;
 }
 
 /*
  * Set cursor icon
  *
- * @description Enables a pointer (touchscreen/mouse) input device
+ * @description Shown once a relative (mouse) device moves the pointer
  * @param display the display on which to create
  * @param indev the input device to set the cursor on
  */
@@ -130,47 +306,365 @@ static void set_mouse_cursor_icon(lv_indev_t *indev, lv_display_t *display)
 {
     /* Set the cursor icon */
     LV_IMAGE_DECLARE(mouse_cursor_icon);
-    lv_obj_t *cursor_obj = lv_image_create(lv_display_get_screen_active(display));
+    cursor_obj = lv_image_create(lv_display_get_screen_active(display));
     lv_image_set_src(cursor_obj, &mouse_cursor_icon);
     lv_indev_set_cursor(indev, cursor_obj);
 
     /* delete the mouse cursor icon if the device is removed */
     lv_indev_add_event_cb(indev, indev_deleted_cb, LV_EVENT_DELETE, cursor_obj);
+}
+
+/*
+ * Scale an absolute axis to the display resolution
+ */
+static int32_t map_axis(int32_t v, axis_range_t range, int32_t res)
+{
+    if (range.max <= range.min) {
+        return v;
+    }
 
+    return lv_map(v, range.min, range.max, 0, res - 1);
 }
 
 /*
- * Initialize a mouse pointer device
+ * The input thread
  *
- * Enables a pointer (touchscreen/mouse) input device
- * Use 'evtest' to find the correct input device. /dev/input/by-id/ is recommended if possible
- * Use /dev/input/by-id/my-mouse-or-touchscreen or /dev/input/eventX
+ * @description Waits on the device and on /dev/input changes. A device that
+ * fails to read is closed, releasing the pointer, and rediscovered later.
+ */
+static void *input_thread(void *arg)
+{
+    struct pollfd fds[2];
+    int dev_fd = -1;
+    int watch_fd;
+    int nfds;
+    int timeout;
+    char buf[4096];
+    evdev_sample_t release;
+
+    LV_UNUSED(arg);
+
+    watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch_fd >= 0 && inotify_add_watch(watch_fd, INPUT_DIR, IN_CREATE | IN_ATTRIB) < 0) {
+        close(watch_fd);
+        watch_fd = -1;
+    }
+    if (watch_fd < 0) {
+        fprintf(stderr, "evdev: cannot watch %s, rescanning every %d ms\n", INPUT_DIR, RESCAN_MS);
+    }
+
+    for (;;) {
+        if (dev_fd < 0) {
+            dev_fd = open_pointer_device();
+        }
+
+        nfds = 0;
+        if (dev_fd >= 0) {
+            fds[nfds].fd = dev_fd;
+            fds[nfds].events = POLLIN;
+            nfds++;
+        }
+        if (watch_fd >= 0) {
+            fds[nfds].fd = watch_fd;
+            fds[nfds].events = POLLIN;
+            nfds++;
+        }
+        timeout = (dev_fd < 0 && watch_fd < 0) ? RESCAN_MS : -1;
+
+        if (poll(fds, nfds, timeout) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "evdev: poll failed: %s\n", strerror(errno));
+            break;
+        }
+
+        /* Directory changes only matter while there is no device */
+        if (watch_fd >= 0) {
+            while (read(watch_fd, buf, sizeof(buf)) > 0) {
+            }
+        }
+
+        if (dev_fd >= 0 && fds[0].revents != 0 && !read_device(dev_fd)) {
+            fprintf(stderr, "evdev: input device lost\n");
+            close(dev_fd);
+            dev_fd = -1;
+
+            memset(&release, 0, sizeof(release));
+            release.x = current.rel ? 0 : current.x;
+            release.y = current.rel ? 0 : current.y;
+            release.rel = current.rel;
+            release.timestamp_us = now_us();
+            queue_push(&release);
+            current.pressed = false;
+        }
+    }
+
+    if (watch_fd >= 0) {
+        close(watch_fd);
+    }
+    return NULL;
+}
+
+/*
+ * Open the configured device, or the first pointer device in /dev/input
  *
- * If LV_LINUX_EVDEV_POINTER_DEVICE is not set, automatic evdev disovery will start
+ * @return the device fd, -1 if there is none
+ */
+static int open_pointer_device(void)
+{
+    char path[300];
+    struct dirent *entry;
+    DIR *dir;
+    int fd = -1;
+
+    if (device_path != NULL) {
+        return open_device(device_path);
+    }
+
+    dir = opendir(INPUT_DIR);
+    if (dir == NULL) {
+        return -1;
+    }
+
+    while (fd < 0 && (entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, "event", 5) != 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", INPUT_DIR, entry->d_name);
+        fd = open_device(path);
+    }
+
+    closedir(dir);
+    return fd;
+}
+
+/*
+ * Open a device if it is a pointer, with timestamps on CLOCK_MONOTONIC
  *
- * @param display the LVGL display
+ * @param path the device node
+ * @return the device fd, -1 on error or if it is not a pointer
+ */
+static int open_device(const char *path)
+{
+    struct input_absinfo abs_x;
+    struct input_absinfo abs_y;
+    int clock = CLOCK_MONOTONIC;
+    int fd;
+
+    fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    if (!is_pointer_device(fd)) {
+        close(fd);
+        return -1;
+    }
+
+    /* Comparable with the clock frame_stats timestamps frames with */
+    if (ioctl(fd, EVIOCSCLOCKID, &clock) < 0) {
+        fprintf(stderr, "evdev: %s: cannot select CLOCK_MONOTONIC, latency is not measured\n", path);
+    }
+
+    memset(&abs_x, 0, sizeof(abs_x));
+    memset(&abs_y, 0, sizeof(abs_y));
+    if (ioctl(fd, EVIOCGABS(ABS_X), &abs_x) < 0) {
+        ioctl(fd, EVIOCGABS(ABS_MT_POSITION_X), &abs_x);
+    }
+    if (ioctl(fd, EVIOCGABS(ABS_Y), &abs_y) < 0) {
+        ioctl(fd, EVIOCGABS(ABS_MT_POSITION_Y), &abs_y);
+    }
+
+    pthread_mutex_lock(&queue_lock);
+    range_x.min = abs_x.minimum;
+    range_x.max = abs_x.maximum;
+    range_y.min = abs_y.minimum;
+    range_y.max = abs_y.maximum;
+    pthread_mutex_unlock(&queue_lock);
+
+    memset(&current, 0, sizeof(current));
+    current_changed = false;
+    dropping = false;
+    mt_slot = 0;
+
+    fprintf(stderr, "evdev: using %s\n", path);
+    return fd;
+}
+
+/*
+ * A touchscreen reports absolute positions and a touch or button, a mouse
+ * relative motion and a button
+ */
+static bool is_pointer_device(int fd)
+{
+    unsigned long abs_bits[NLONGS(ABS_CNT)];
+    unsigned long rel_bits[NLONGS(REL_CNT)];
+    unsigned long key_bits[NLONGS(KEY_CNT)];
+    bool has_abs;
+    bool has_rel;
+    bool has_button;
+
+    memset(abs_bits, 0, sizeof(abs_bits));
+    memset(rel_bits, 0, sizeof(rel_bits));
+    memset(key_bits, 0, sizeof(key_bits));
+
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(key_bits)), key_bits) < 0) {
+        return false;
+    }
+    ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(abs_bits)), abs_bits);
+    ioctl(fd, EVIOCGBIT(EV_REL, sizeof(rel_bits)), rel_bits);
+
+    has_abs = TEST_BIT(abs_bits, ABS_X) || TEST_BIT(abs_bits, ABS_MT_POSITION_X);
+    has_rel = TEST_BIT(rel_bits, REL_X) && TEST_BIT(rel_bits, REL_Y);
+    has_button = TEST_BIT(key_bits, BTN_TOUCH) || TEST_BIT(key_bits, BTN_LEFT);
+
+    return (has_abs || has_rel) && has_button;
+}
+
+/*
+ * Read everything the device has
  *
- * @return input device
+ * @return false if the device is gone or failing
  */
-static lv_indev_t *init_pointer_evdev(lv_display_t *display)
+static bool read_device(int fd)
 {
-    const char *input_device = "/dev/input/by-path/platform-xhci-hcd.0-usb-0:1:1.0-event";
+    struct input_event events[READ_BATCH];
+    ssize_t n;
+    ssize_t i;
 
-    if (input_device == NULL) {
-        LV_LOG_USER("Using evdev automatic discovery.");
-        lv_evdev_discovery_start(discovery_cb, display);
-        return NULL;
+    for (;;) {
+        n = read(fd, events, sizeof(events));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN;
+        }
+        if (n == 0) {
+            return false;
+        }
+
+        for (i = 0; i < n / (ssize_t)sizeof(events[0]); i++) {
+            handle_event(&events[i]);
+        }
     }
+}
 
-    lv_indev_t *indev = lv_evdev_create(LV_INDEV_TYPE_POINTER, input_device);
+/*
+ * Accumulate the pointer state and queue it at every SYN_REPORT
+ */
+static void handle_event(const struct input_event *ev)
+{
+    if (ev->type == EV_SYN) {
+        if (ev->code == SYN_DROPPED) {
+            /* The kernel buffer overflowed: skip to the next full report */
+            dropping = true;
+        } else if (ev->code == SYN_REPORT) {
+            if (!dropping && current_changed) {
+                current.timestamp_us = (uint64_t)ev->input_event_sec * 1000000u + ev->input_event_usec;
+                queue_push(&current);
+                if (current.rel) {
+                    current.x = 0;
+                    current.y = 0;
+                }
+            }
+            dropping = false;
+            current_changed = false;
+        }
+        return;
+    }
 
-    if (indev == NULL) {
-        return NULL;
+    if (dropping) {
+        return;
     }
 
-    lv_indev_set_display(indev, display);
+    switch (ev->type) {
+    case EV_ABS:
+        /* Multitouch devices: follow the first contact only */
+        if (ev->code == ABS_MT_SLOT) {
+            mt_slot = ev->value;
+        } else if (ev->code == ABS_X || (ev->code == ABS_MT_POSITION_X && mt_slot == 0)) {
+            current.x = ev->value;
+            current.rel = false;
+            current_changed = true;
+        } else if (ev->code == ABS_Y || (ev->code == ABS_MT_POSITION_Y && mt_slot == 0)) {
+            current.y = ev->value;
+            current.rel = false;
+            current_changed = true;
+        } else if (ev->code == ABS_MT_TRACKING_ID && mt_slot == 0) {
+            current.pressed = ev->value >= 0;
+            current_changed = true;
+        }
+        break;
+    case EV_REL:
+        if (ev->code == REL_X) {
+            current.x += ev->value;
+            current.rel = true;
+            current_changed = true;
+        } else if (ev->code == REL_Y) {
+            current.y += ev->value;
+            current.rel = true;
+            current_changed = true;
+        }
+        break;
+    case EV_KEY:
+        if (ev->code == BTN_TOUCH || ev->code == BTN_LEFT) {
+            current.pressed = ev->value != 0;
+            current_changed = true;
+        }
+        break;
+    default:
+        break;
+    }
+}
 
-    //set_mouse_cursor_icon(indev, display);
-    return indev;
+/*
+ * Queue a sample and wake the run loop
+ *
+ * @description When LVGL falls behind by a full queue, motion is folded
+ * into the newest sample, keeping its older timestamp; a press or release
+ * drops the oldest sample instead.
+ */
+static void queue_push(const evdev_sample_t *sample)
+{
+    uint64_t one = 1;
+    evdev_sample_t *last;
+
+    pthread_mutex_lock(&queue_lock);
+
+    if (queue_count == QUEUE_LEN) {
+        last = &queue[(queue_head + queue_count - 1) % QUEUE_LEN];
+        if (last->pressed == sample->pressed && last->rel == sample->rel) {
+            if (sample->rel) {
+                last->x += sample->x;
+                last->y += sample->y;
+            } else {
+                last->x = sample->x;
+                last->y = sample->y;
+            }
+            pthread_mutex_unlock(&queue_lock);
+            return;
+        }
+        queue_head = (queue_head + 1) % QUEUE_LEN;
+        queue_count--;
+    }
+
+    queue[(queue_head + queue_count) % QUEUE_LEN] = *sample;
+    queue_count++;
+
+    pthread_mutex_unlock(&queue_lock);
+
+    if (write(notify_fd, &one, sizeof(one)) < 0) {
+        /* EAGAIN: the counter is saturated, the loop is awake anyway */
+    }
+}
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
 }
 #endif /*#if LV_USE_EVDEV*/
@@ -0,0 +1,262 @@
+/**
+ * @file refresh_governor.c
+ *
+ * Idle refresh rate and display blanking
+ *
+ * A timer samples the display inactivity time and the running animations
+ * and moves the display between three states: active (the refresh timer at
+ * LV_DEF_REFR_PERIOD), idle (a longer refresh period) and blanked (the
+ * refresh timer paused and the panel powered down by the backend; a press
+ * wakes it). Screen content keeps being invalidated while idle or blanked;
+ * it is drawn at the next refresh.
+ *
+ * The check timer is armed for the next deadline (the idle or the blank
+ * timeout) rather than polling, so a quiet display doesn't wake the event
+ * loop. Only while the idle timeout has passed with animations running is
+ * it re-checked every CHECK_PERIOD; the display is refreshing then anyway.
+ * Leaving idle is seen at the refresh that draws the change.
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "simulator_util.h"
+#include "refresh_governor.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define CHECK_PERIOD 100 /* ms, while waiting for animations to end */
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef enum {
+    GOVERNOR_ACTIVE,
+    GOVERNOR_IDLE,
+    GOVERNOR_BLANKED
+} governor_state_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static void check_timer_cb(lv_timer_t *timer);
+static void refr_start_cb(lv_event_t *e);
+static void indev_pressed_cb(lv_event_t *e);
+static void schedule_check(void);
+static void set_state(governor_state_t new_state);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+static lv_display_t *display;
+static refresh_governor_blank_cb_t blank_cb;
+static lv_timer_t *check_timer;
+static governor_state_t state = GOVERNOR_ACTIVE;
+static bool enabled = true;
+
+/* Configuration, from the environment */
+static uint32_t idle_ms;
+static uint32_t idle_refr_period;
+static uint32_t blank_ms;
+
+static const char *state_names[] = { "active", "idle", "blanked" };
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void refresh_governor_attach(lv_display_t *disp, refresh_governor_blank_cb_t cb)
+{
+    lv_indev_t *indev;
+
+    LV_ASSERT_NULL(disp);
+
+    idle_ms = (uint32_t)atoi(getenv_default("LV_SIM_IDLE_MS", "10000"));
+    idle_refr_period = (uint32_t)atoi(getenv_default("LV_SIM_IDLE_REFR_PERIOD", "250"));
+    blank_ms = (uint32_t)atoi(getenv_default("LV_SIM_BLANK_TIMEOUT_S", "300")) * 1000;
+
+    if (idle_refr_period < LV_DEF_REFR_PERIOD) {
+        idle_refr_period = LV_DEF_REFR_PERIOD;
+    }
+
+    display = disp;
+    blank_cb = cb;
+    check_timer = lv_timer_create(check_timer_cb, CHECK_PERIOD, NULL);
+    lv_display_add_event_cb(disp, refr_start_cb, LV_EVENT_REFR_START, NULL);
+    schedule_check();
+
+    /* Display backends like SDL create their input devices with the display */
+    indev = lv_indev_get_next(NULL);
+    while (indev != NULL) {
+        refresh_governor_add_indev(indev);
+        indev = lv_indev_get_next(indev);
+    }
+}
+
+void refresh_governor_add_indev(lv_indev_t *indev)
+{
+    LV_ASSERT_NULL(indev);
+
+    if (display == NULL) {
+        return; /* not attached: the display keeps the full rate */
+    }
+
+    lv_indev_add_event_cb(indev, indev_pressed_cb, LV_EVENT_PRESSED, NULL);
+}
+
+void refresh_governor_set_enabled(bool en)
+{
+    enabled = en;
+    if (display == NULL) {
+        return;
+    }
+    if (!enabled) {
+        set_state(GOVERNOR_ACTIVE);
+    }
+    schedule_check();
+}
+
+bool refresh_governor_is_blanked(void)
+{
+    return state == GOVERNOR_BLANKED;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void check_timer_cb(lv_timer_t *timer)
+{
+    uint32_t inactive;
+
+    LV_UNUSED(timer);
+
+    if (!enabled) {
+        return;
+    }
+
+    inactive = lv_display_get_inactive_time(display);
+
+    if (blank_cb != NULL && blank_ms > 0 && inactive >= blank_ms) {
+        set_state(GOVERNOR_BLANKED);
+    } else if (idle_ms > 0 && inactive >= idle_ms && lv_anim_count_running() == 0) {
+        set_state(GOVERNOR_IDLE);
+    } else {
+        set_state(GOVERNOR_ACTIVE);
+    }
+
+    schedule_check();
+}
+
+/**
+ * While idle, input from a device that isn't added and animations started
+ * by the application show up as a refresh: go back to the full rate
+ */
+static void refr_start_cb(lv_event_t *e)
+{
+    LV_UNUSED(e);
+
+    if (!enabled || state != GOVERNOR_IDLE) {
+        return;
+    }
+
+    if (lv_anim_count_running() > 0 || lv_display_get_inactive_time(display) < idle_ms) {
+        set_state(GOVERNOR_ACTIVE);
+        schedule_check();
+    }
+}
+
+/**
+ * A press restores the full rate without waiting for the next check
+ */
+static void indev_pressed_cb(lv_event_t *e)
+{
+    lv_indev_t *indev = lv_event_get_target(e);
+
+    if (state == GOVERNOR_BLANKED) {
+        /* The user could not see what they touched */
+        lv_indev_wait_release(indev);
+    }
+
+    set_state(GOVERNOR_ACTIVE);
+    schedule_check();
+}
+
+/**
+ * Arm the check timer for the next timeout, measured from the last input.
+ * Past the idle timeout the display is only kept active by animations, so
+ * check again shortly. Nothing is left to check while blanked.
+ */
+static void schedule_check(void)
+{
+    uint32_t inactive = lv_display_get_inactive_time(display);
+    uint32_t next = UINT32_MAX;
+
+    if (!enabled || state == GOVERNOR_BLANKED) {
+        lv_timer_pause(check_timer);
+        return;
+    }
+
+    if (state == GOVERNOR_ACTIVE && idle_ms > 0) {
+        next = inactive < idle_ms ? idle_ms - inactive : CHECK_PERIOD;
+    }
+    if (blank_cb != NULL && blank_ms > 0) {
+        next = LV_MIN(next, inactive < blank_ms ? blank_ms - inactive : CHECK_PERIOD);
+    }
+
+    if (next == UINT32_MAX) {
+        lv_timer_pause(check_timer);
+        return;
+    }
+
+    lv_timer_set_period(check_timer, next);
+    lv_timer_reset(check_timer);
+    lv_timer_resume(check_timer);
+}
+
+static void set_state(governor_state_t new_state)
+{
+    lv_timer_t *refr_timer = lv_display_get_refr_timer(display);
+
+    if (new_state == state) {
+        return;
+    }
+
+    if (state == GOVERNOR_BLANKED) {
+        if (blank_cb != NULL) {
+            blank_cb(display, false);
+        }
+        lv_timer_resume(refr_timer);
+    }
+
+    switch (new_state) {
+    case GOVERNOR_ACTIVE:
+        lv_timer_set_period(refr_timer, LV_DEF_REFR_PERIOD);
+        lv_timer_ready(refr_timer);
+        break;
+    case GOVERNOR_IDLE:
+        lv_timer_set_period(refr_timer, idle_refr_period);
+        break;
+    case GOVERNOR_BLANKED:
+        lv_timer_pause(refr_timer);
+        blank_cb(display, true);
+        break;
+    }
+
+    LV_LOG_INFO("Display %s", state_names[new_state]);
+    state = new_state;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file refresh_governor.h
+ *
+ * Idle refresh rate and display blanking
+ *
+ */
+
+#ifndef REFRESH_GOVERNOR_H
+#define REFRESH_GOVERNOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include "lvgl/lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/* Powers a display down (blank = true) or back up, see display_backend_t */
+typedef void (*refresh_governor_blank_cb_t)(lv_display_t *disp, bool blank);
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * @brief Govern the refresh rate of a display
+ * @description Runs the display at LV_DEF_REFR_PERIOD while it is touched
+ * or animating. After LV_SIM_IDLE_MS (default 10000, 0 never) without input
+ * or running animations the refresh period becomes LV_SIM_IDLE_REFR_PERIOD
+ * (default 250 ms). After LV_SIM_BLANK_TIMEOUT_S (default 300, 0 never)
+ * without input, rendering stops and the display is blanked through
+ * `blank_cb`; the other LVGL timers keep running. A touch restores the full
+ * rate at once, and the touch that unblanks the display is not delivered
+ * to the widgets under it.
+ * @param disp the display
+ * @param blank_cb powers the display down and up, NULL if the backend
+ * cannot, in which case the display is never blanked
+ */
+void refresh_governor_attach(lv_display_t *disp, refresh_governor_blank_cb_t blank_cb);
+
+/**
+ * @brief Restore the full rate as soon as an input device is pressed
+ * @description Input devices existing at attach time are added by
+ * refresh_governor_attach(). Input from others restores the full rate at
+ * the next refresh it causes, but can't wake a blanked display.
+ * @param indev the input device
+ */
+void refresh_governor_add_indev(lv_indev_t *indev);
+
+/**
+ * @brief Enable or disable the governor, e.g. while benchmarking
+ * @param enabled false keeps the display at the full rate and unblanked
+ */
+void refresh_governor_set_enabled(bool enabled);
+
+/**
+ * @brief Check whether the display is blanked
+ * @return true if blanked
+ */
+bool refresh_governor_is_blanked(void);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*REFRESH_GOVERNOR_H*/
@@ -0,0 +1,185 @@
+/*
+ * log_view.c
+ * Virtualized log view. The object reports the height of all lines as its
+ * content size, so LVGL scrolls it like any other container, but only the
+ * lines intersecting the clip area are fetched and drawn from the
+ * LV_EVENT_DRAW_MAIN callback. There are no child labels and no text
+ * buffer holding the whole log.
+ *
+ * Fetched lines are kept in a small cache keyed by sequence number. A line
+ * never changes once it has a number, so a cached line stays valid until
+ * its slot is reused; the cache holds more lines than fit on a screen.
+ */
+
+#include "src/log_view.h"
+#include <string.h>
+
+/* ---------------- Config ---------------- */
+
+#define CACHE_LINES 64 /* power of two, more than the rows on screen */
+
+/* ---------------- Data ---------------- */
+
+typedef struct {
+    uint64_t seq;
+    bool valid;
+    char text[LOG_VIEW_LINE_LEN];
+} cached_line_t;
+
+typedef struct {
+    const lv_font_t* font;
+    int32_t line_h;
+    log_view_fetch_cb_t fetch;
+    void* user_data;
+    uint64_t first;
+    uint64_t next;
+    cached_line_t cache[CACHE_LINES];
+} log_view_t;
+
+/* ---------------- Lines ---------------- */
+
+static const char* line_text(log_view_t* lv, uint64_t seq) {
+    cached_line_t* c = &lv->cache[seq & (CACHE_LINES - 1)];
+    if (c->valid && c->seq == seq) return c->text;
+
+    c->seq = seq;
+    c->valid = true;
+    if (!lv->fetch(seq, c->text, sizeof(c->text), lv->user_data)) {
+        c->text[0] = '\0';
+        return c->text;
+    }
+    /* One record is one row */
+    for (char* p = c->text; *p; p++) {
+        if (*p == '\n' || *p == '\r' || *p == '\t') *p = ' ';
+    }
+    return c->text;
+}
+
+static int32_t line_count(const log_view_t* lv) {
+    return (int32_t)(lv->next - lv->first);
+}
+
+/* ---------------- Events ---------------- */
+
+static void log_view_draw_cb(lv_event_t* e) {
+    lv_obj_t* obj = lv_event_get_current_target(e);
+    lv_layer_t* layer = lv_event_get_layer(e);
+    log_view_t* lv = (log_view_t*)lv_obj_get_user_data(obj);
+    if (!lv || lv->next == lv->first) return;
+
+    lv_area_t coords;
+    lv_obj_get_content_coords(obj, &coords);
+    int32_t top = coords.y1 - lv_obj_get_scroll_y(obj); /* y of the first line */
+
+    /* Visit only the rows that intersect the area being redrawn */
+    const lv_area_t* clip = &layer->_clip_area;
+    int32_t row_first = LV_MAX(0, (clip->y1 - top) / lv->line_h);
+    int32_t row_last = LV_MIN(line_count(lv) - 1, (clip->y2 - top) / lv->line_h);
+
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    dsc.font = lv->font;
+    dsc.color = lv_obj_get_style_text_color(obj, LV_PART_MAIN);
+    dsc.opa = LV_OPA_COVER;
+    dsc.flag = LV_TEXT_FLAG_EXPAND; /* cut long lines, don't wrap them */
+
+    for (int32_t row = row_first; row <= row_last; row++) {
+        lv_area_t area = coords;
+        area.y1 = top + row * lv->line_h;
+        area.y2 = area.y1 + lv->line_h - 1;
+        /* The text is drawn later in the frame; the cache keeps it alive */
+        dsc.text = line_text(lv, lv->first + (uint64_t)row);
+        lv_draw_label(layer, &dsc, &area);
+    }
+}
+
+static void log_view_self_size_cb(lv_event_t* e) {
+    lv_obj_t* obj = lv_event_get_current_target(e);
+    log_view_t* lv = (log_view_t*)lv_obj_get_user_data(obj);
+    lv_point_t* p = lv_event_get_param(e);
+    if (!lv) return;
+    p->y = LV_MAX(p->y, line_count(lv) * lv->line_h);
+}
+
+static void log_view_delete_cb(lv_event_t* e) {
+    lv_obj_t* obj = lv_event_get_current_target(e);
+    log_view_t* lv = (log_view_t*)lv_obj_get_user_data(obj);
+    lv_obj_set_user_data(obj, NULL);
+    lv_free(lv);
+}
+
+/* ---------------- Public API ---------------- */
+
+lv_obj_t* log_view_create(lv_obj_t* parent, const lv_font_t* font,
+                          log_view_fetch_cb_t fetch, void* user_data) {
+    log_view_t* lv = lv_malloc(sizeof(log_view_t));
+    LV_ASSERT_NULL(lv);
+    if (!lv) return NULL;
+    memset(lv, 0, sizeof(*lv));
+    lv->font = font;
+    lv->line_h = lv_font_get_line_height(font);
+    lv->fetch = fetch;
+    lv->user_data = user_data;
+
+    lv_obj_t* obj = lv_obj_create(parent);
+    lv_obj_set_scroll_dir(obj, LV_DIR_VER);
+    lv_obj_set_user_data(obj, lv);
+    lv_obj_add_event_cb(obj, log_view_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+    lv_obj_add_event_cb(obj, log_view_self_size_cb, LV_EVENT_GET_SELF_SIZE, NULL);
+    lv_obj_add_event_cb(obj, log_view_delete_cb, LV_EVENT_DELETE, NULL);
+    return obj;
+}
+
+void log_view_set_range(lv_obj_t* obj, uint64_t first, uint64_t next) {
+    log_view_t* lv = (log_view_t*)lv_obj_get_user_data(obj);
+    if (!lv || next < first) return;
+    if (first == lv->first && next == lv->next) return;
+
+    if (first > lv->next || next < lv->next || first < lv->first) {
+        /* Not a continuation of what we have: start over at the end */
+        log_view_clear(obj);
+        lv->first = first;
+        lv->next = next;
+        lv_obj_refresh_self_size(obj);
+        lv_obj_scroll_to_y(obj, LV_COORD_MAX, LV_ANIM_OFF);
+        return;
+    }
+
+    bool following = lv_obj_get_scroll_bottom(obj) <= lv->line_h / 2;
+    int32_t dropped = (int32_t)(first - lv->first);
+    int32_t old_count = line_count(lv);
+    lv->first = first;
+    lv->next = next;
+    lv_obj_refresh_self_size(obj);
+
+    if (following) {
+        lv_obj_scroll_to_y(obj, LV_COORD_MAX, LV_ANIM_OFF);
+        lv_obj_invalidate(obj);
+        return;
+    }
+
+    if (dropped > 0) {
+        /* Keep the same lines under the finger */
+        int32_t y = lv_obj_get_scroll_y(obj) - dropped * lv->line_h;
+        lv_obj_scroll_to_y(obj, LV_MAX(0, y), LV_ANIM_OFF);
+        lv_obj_invalidate(obj);
+        return;
+    }
+
+    /* Appended below the visible rows: only the new rows can show */
+    lv_area_t area;
+    lv_obj_get_content_coords(obj, &area);
+    area.y1 += old_count * lv->line_h - lv_obj_get_scroll_y(obj);
+    if (area.y1 <= area.y2) lv_obj_invalidate_area(obj, &area);
+}
+
+void log_view_clear(lv_obj_t* obj) {
+    log_view_t* lv = (log_view_t*)lv_obj_get_user_data(obj);
+    if (!lv) return;
+    for (uint32_t i = 0; i < CACHE_LINES; i++) lv->cache[i].valid = false;
+    lv->first = 0;
+    lv->next = 0;
+    lv_obj_refresh_self_size(obj);
+    lv_obj_scroll_to_y(obj, 0, LV_ANIM_OFF);
+    lv_obj_invalidate(obj);
+}
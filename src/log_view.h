@@ -0,0 +1,42 @@
+#pragma once
+/* log_view.h */
+#ifndef LOG_VIEW_H
+#define LOG_VIEW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lvgl/lvgl.h"
+
+/* Longest line shown; longer lines are cut */
+#define LOG_VIEW_LINE_LEN 128
+
+/* Copy line `seq` into `buf` (at most `len` bytes with the NUL). Returns
+ * false if the source no longer holds that line.
+ */
+typedef bool (*log_view_fetch_cb_t)(uint64_t seq, char* buf, size_t len, void* user_data);
+
+/* Create a scrollable log view. Lines are numbered by sequence number and
+ * pulled from `fetch` only when they scroll into view, so the log is never
+ * copied or laid out as a whole. Text colour and background come from the
+ * object's style.
+ */
+lv_obj_t* log_view_create(lv_obj_t* parent, const lv_font_t* font,
+                          log_view_fetch_cb_t fetch, void* user_data);
+
+/* Lines `first` up to `next - 1` exist. New lines at the end are appended
+ * and followed if the view was scrolled to the end; lines dropped from the
+ * start do not move what is on screen. A range that doesn't continue the
+ * previous one (the source restarted) clears the view.
+ */
+void log_view_set_range(lv_obj_t* view, uint64_t first, uint64_t next);
+
+/* Forget all lines, e.g. when the view is pointed at another source */
+void log_view_clear(lv_obj_t* view);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* LOG_VIEW_H */
@@ -27,6 +27,7 @@
 // #include "lvgl/demos/lv_demos.h"
 #include "src/moisture.h"
 #include "src/server.h"
+#include "src/bench.h"
 
 #include "src/lib/driver_backends.h"
 #include "src/lib/simulator_util.h"
@@ -41,6 +42,15 @@ static void print_usage(void);
  * has specified one on the command line */
 static char *selected_backend;
 
+/* set by -g: time the moisture track redraw and exit */
+static bool run_track_benchmark;
+
+/* set by -G: time full dashboard frames and exit */
+static bool run_frame_benchmark;
+
+/* set by -S: scripted benchmark scenarios to run, then exit */
+static char *bench_scenarios;
+
 /* Global simulator settings, defined in lv_linux_backend.c */
 extern simulator_settings_t settings;
 
@@ -62,9 +72,13 @@ static void print_lvgl_version(void)
  */
 static void print_usage(void)
 {
-    fprintf(stdout, "\nlvglsim [-V] [-B] [-b backend_name] [-W window_width] [-H window_height]\n\n");
+    fprintf(stdout, "\nlvglsim [-V] [-B] [-g] [-G] [-S scenarios] [-b backend_name] [-W window_width] [-H window_height]\n\n");
     fprintf(stdout, "-V print LVGL version\n");
     fprintf(stdout, "-B list supported backends\n");
+    fprintf(stdout, "-g benchmark the moisture track redraw and exit\n");
+    fprintf(stdout, "-G benchmark full dashboard frames and exit\n");
+    fprintf(stdout, "-S run scripted benchmark scenarios and exit: all, or a comma separated list of\n"
+                    "   steady, scroll, slider, popups, replay:<evdev recording>\n");
 }
 
 /**
@@ -88,7 +102,7 @@ static void configure_simulator(int argc, char **argv)
     settings.window_height = atoi(env_h ? env_h : "320");
 
     /* Parse the command-line options. */
-    while ((opt = getopt (argc, argv, "b:fmW:H:BVh")) != -1) {
+    while ((opt = getopt (argc, argv, "b:fmW:H:BVgGS:h")) != -1) {
         switch (opt) {
         case 'h':
             print_usage();
@@ -102,6 +116,15 @@ static void configure_simulator(int argc, char **argv)
             driver_backends_print_supported();
             exit(EXIT_SUCCESS);
             break;
+        case 'g':
+            run_track_benchmark = true;
+            break;
+        case 'G':
+            run_frame_benchmark = true;
+            break;
+        case 'S':
+            bench_scenarios = strdup(optarg);
+            break;
         case 'b':
             if (driver_backends_is_supported(optarg) == 0) {
                 die("error no such backend: %s\n", optarg);
@@ -144,13 +167,29 @@ int main(int argc, char **argv)
         die("Failed to initialize display backend");
     }
 
-    /* Enable for EVDEV support */
+    /* Enable for EVDEV support - the headless backend takes no input */
 #if LV_USE_EVDEV
-    if (driver_backends_init_backend("EVDEV") == -1) {
+    if ((selected_backend == NULL || strcmp(selected_backend, "HEADLESS") != 0) &&
+        driver_backends_init_backend("EVDEV") == -1) {
         die("Failed to initialize evdev");
     }
 #endif
 
+    if (run_track_benchmark) {
+        moisture_benchmark_track_redraw(2000);
+        return 0;
+    }
+
+    if (run_frame_benchmark) {
+        ui_moisture_dashboard_absolute();
+        moisture_benchmark_frame(300);
+        return 0;
+    }
+
+    if (bench_scenarios != NULL) {
+        return bench_run(bench_scenarios);
+    }
+
     /*Create a Demo*/
     // lv_demo_widgets();
     // LV_LOG_INFO("Pixel before scaling R=%d G=%d B=%d", 1, 2, 3);
@@ -0,0 +1,278 @@
+/*
+ * modal.c
+ * Pooled modal dialogs. Every dialog is built the first time it is shown
+ * and afterwards only hidden and shown again, so opening one costs a flag
+ * change and a label update instead of a widget tree, a keyboard or a few
+ * dozen local style properties. The looks shared by all dialogs live in
+ * static styles initialized once.
+ *
+ * Dialogs are placed on the top layer, above whichever screen is loaded.
+ * While one is open the screen under it is hidden and replaced by a dimmed
+ * snapshot taken when the dialog opened. A hidden screen is neither
+ * invalidated nor drawn, so a frame behind a dialog only redraws what
+ * changed on the dialog, over an opaque image rather than alpha blending a
+ * translucent layer over live content. If the snapshot can't be allocated
+ * the dialog falls back to a translucent backdrop.
+ */
+
+#include "src/modal.h"
+
+/* ---------------- Config ---------------- */
+
+#define CARD_COLOR 0x2B2B2B
+#define CARD_RADIUS 16
+#define CARD_SHADOW 40
+#define BUTTON_HEIGHT 56
+
+/* ---------------- Styles ---------------- */
+
+static lv_style_t style_card;
+static lv_style_t style_content;
+static lv_style_t style_footer;
+static lv_style_t style_button;
+static lv_style_t style_layer;
+static bool styles_initialized = false;
+
+static void init_styles(void) {
+    if (styles_initialized) return;
+    styles_initialized = true;
+
+    lv_style_init(&style_card);
+    lv_style_set_bg_color(&style_card, lv_color_hex(CARD_COLOR));
+    lv_style_set_bg_opa(&style_card, LV_OPA_COVER);
+    lv_style_set_radius(&style_card, CARD_RADIUS);
+    lv_style_set_border_width(&style_card, 0);
+    lv_style_set_shadow_width(&style_card, CARD_SHADOW);
+
+    lv_style_init(&style_content);
+    lv_style_set_pad_top(&style_content, 24);
+    lv_style_set_pad_bottom(&style_content, 24);
+    lv_style_set_pad_left(&style_content, 32);
+    lv_style_set_pad_right(&style_content, 32);
+    lv_style_set_pad_row(&style_content, 8);
+    lv_style_set_text_align(&style_content, LV_TEXT_ALIGN_LEFT);
+
+    lv_style_init(&style_footer);
+    lv_style_set_width(&style_footer, LV_PCT(100));
+    lv_style_set_height(&style_footer, LV_SIZE_CONTENT);
+    lv_style_set_pad_left(&style_footer, 32);
+    lv_style_set_pad_right(&style_footer, 32);
+    lv_style_set_pad_top(&style_footer, 12);
+    lv_style_set_pad_bottom(&style_footer, 16);
+    lv_style_set_pad_column(&style_footer, 16);
+
+    lv_style_init(&style_button);
+    lv_style_set_height(&style_button, BUTTON_HEIGHT);
+    lv_style_set_pad_left(&style_button, 28);
+    lv_style_set_pad_right(&style_button, 28);
+    lv_style_set_radius(&style_button, 10);
+    lv_style_set_text_color(&style_button, lv_color_white());
+
+    lv_style_init(&style_layer);
+    lv_style_set_bg_color(&style_layer, lv_color_hex(0x000000));
+    lv_style_set_border_width(&style_layer, 0);
+    lv_style_set_radius(&style_layer, 0);
+    lv_style_set_pad_all(&style_layer, 0);
+}
+
+void modal_style_card(lv_obj_t* card) {
+    init_styles();
+    lv_obj_add_style(card, &style_card, 0);
+}
+
+void modal_style_button(lv_obj_t* btn, uint32_t color) {
+    init_styles();
+    lv_obj_add_style(btn, &style_button, 0);
+    lv_obj_set_style_bg_color(btn, lv_color_hex(color), 0);
+}
+
+/* ---------------- Backdrop ---------------- */
+
+static lv_draw_buf_t* backdrop_buf;
+static lv_obj_t* backdrop_img;
+static lv_obj_t* frozen_scr; /* hidden under the snapshot, NULL when none */
+static uint32_t open_count;
+
+/* Darken an RGB565 buffer in place, as if `dim` black were blended over it */
+static void dim_rgb565(lv_draw_buf_t* buf, lv_opa_t dim) {
+    uint16_t rb[32];
+    uint16_t g[64];
+    uint32_t keep = LV_OPA_COVER - dim;
+    for (uint32_t i = 0; i < 32; i++) rb[i] = (uint16_t)((i * keep + 127) / 255);
+    for (uint32_t i = 0; i < 64; i++) g[i] = (uint16_t)((i * keep + 127) / 255);
+
+    for (uint32_t y = 0; y < buf->header.h; y++) {
+        uint16_t* px = (uint16_t*)(buf->data + y * buf->header.stride);
+        for (uint32_t x = 0; x < buf->header.w; x++) {
+            uint16_t c = px[x];
+            px[x] = (uint16_t)((rb[c >> 11] << 11) | (g[(c >> 5) & 0x3F] << 5) | rb[c & 0x1F]);
+        }
+    }
+}
+
+/* Hide the active screen behind a dimmed snapshot of itself */
+static bool freeze_screen(lv_opa_t dim) {
+    lv_obj_t* scr = lv_screen_active();
+    lv_obj_update_layout(scr);
+    int32_t w = lv_obj_get_width(scr);
+    int32_t h = lv_obj_get_height(scr);
+
+    if (backdrop_buf && ((int32_t)backdrop_buf->header.w != w || (int32_t)backdrop_buf->header.h != h)) {
+        lv_draw_buf_destroy(backdrop_buf);
+        backdrop_buf = NULL;
+    }
+    if (!backdrop_buf) {
+        backdrop_buf = lv_draw_buf_create(w, h, LV_COLOR_FORMAT_RGB565, 0);
+        if (!backdrop_buf) return false;
+    }
+    if (lv_snapshot_take_to_draw_buf(scr, LV_COLOR_FORMAT_RGB565, backdrop_buf) != LV_RESULT_OK) {
+        return false;
+    }
+    dim_rgb565(backdrop_buf, dim);
+    lv_image_cache_drop(backdrop_buf);
+
+    if (!backdrop_img) {
+        backdrop_img = lv_image_create(lv_layer_top());
+        lv_obj_set_pos(backdrop_img, 0, 0);
+    }
+    lv_image_set_src(backdrop_img, backdrop_buf);
+    lv_obj_remove_flag(backdrop_img, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_move_foreground(backdrop_img);
+
+    lv_obj_add_flag(scr, LV_OBJ_FLAG_HIDDEN);
+    frozen_scr = scr;
+    return true;
+}
+
+static void thaw_screen(void) {
+    if (!frozen_scr) return;
+    lv_obj_add_flag(backdrop_img, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_remove_flag(frozen_scr, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_invalidate(frozen_scr);
+    frozen_scr = NULL;
+}
+
+/* ---------------- Layers ---------------- */
+
+/* A layer's dim level is kept in its user data; the style opacity is only
+ * used when the layer is not over a snapshot. */
+static lv_opa_t layer_dim(lv_obj_t* layer) {
+    return (lv_opa_t)(uintptr_t)lv_obj_get_user_data(layer);
+}
+
+lv_obj_t* modal_layer_create(lv_opa_t dim) {
+    init_styles();
+    lv_obj_t* layer = lv_obj_create(lv_layer_top());
+    lv_obj_remove_style_all(layer);
+    lv_obj_add_style(layer, &style_layer, 0);
+    lv_obj_set_user_data(layer, (void*)(uintptr_t)dim);
+    lv_obj_set_size(layer, LV_PCT(100), LV_PCT(100));
+    lv_obj_add_flag(layer, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_HIDDEN);
+    lv_obj_remove_flag(layer, LV_OBJ_FLAG_SCROLLABLE);
+    return layer;
+}
+
+void modal_layer_show(lv_obj_t* layer) {
+    if (lv_obj_has_flag(layer, LV_OBJ_FLAG_HIDDEN)) {
+        /* The first dialog freezes the screen; stacked ones dim what's below */
+        bool frozen = (open_count++ == 0) && freeze_screen(layer_dim(layer));
+        lv_obj_set_style_bg_opa(layer, frozen ? LV_OPA_TRANSP : layer_dim(layer), 0);
+        lv_obj_remove_flag(layer, LV_OBJ_FLAG_HIDDEN);
+    }
+    lv_obj_move_foreground(layer);
+}
+
+void modal_layer_hide(lv_obj_t* layer) {
+    if (lv_obj_has_flag(layer, LV_OBJ_FLAG_HIDDEN)) return;
+    lv_obj_add_flag(layer, LV_OBJ_FLAG_HIDDEN);
+    if (open_count > 0 && --open_count == 0) thaw_screen();
+}
+
+/* ---------------- Message Dialogs ---------------- */
+
+static void confirm_clicked_cb(lv_event_t* e) {
+    modal_t* m = (modal_t*)lv_event_get_user_data(e);
+    modal_close(m);
+    if (m->spec->confirm_cb) m->spec->confirm_cb();
+}
+
+static void dismiss_clicked_cb(lv_event_t* e) {
+    modal_close((modal_t*)lv_event_get_user_data(e));
+}
+
+static void build(modal_t* m) {
+    const modal_spec_t* s = m->spec;
+
+    /* The message box puts itself on a backdrop on the top layer */
+    lv_obj_t* mbox = lv_msgbox_create(NULL);
+    m->backdrop = lv_obj_get_parent(mbox);
+    lv_obj_add_flag(m->backdrop, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_set_style_bg_color(m->backdrop, lv_color_hex(0x000000), 0);
+    lv_obj_set_user_data(m->backdrop, (void*)(uintptr_t)LV_OPA_50);
+
+    lv_obj_add_style(mbox, &style_card, 0);
+    lv_obj_set_size(mbox, s->width, s->height);
+    lv_obj_center(mbox);
+    if (s->border_width > 0) {
+        lv_obj_set_style_border_width(mbox, s->border_width, 0);
+        lv_obj_set_style_border_color(mbox, lv_color_hex(s->border_color), 0);
+    }
+
+    lv_obj_t* content = lv_msgbox_get_content(mbox);
+    lv_obj_add_style(content, &style_content, 0);
+    lv_obj_set_flex_flow(content, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_flex_align(content, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START);
+
+    if (s->title) {
+        lv_obj_t* title = lv_label_create(content);
+        lv_label_set_text_static(title, s->title);
+        lv_obj_set_style_text_font(title, &lv_font_montserrat_20, 0);
+        lv_obj_set_style_text_color(title, lv_color_hex(s->title_color), 0);
+    }
+
+    m->body = lv_label_create(content);
+    lv_label_set_text_static(m->body, s->text);
+    lv_obj_set_style_text_font(m->body, s->text_font, 0);
+    lv_obj_set_style_text_color(m->body, lv_color_hex(s->text_color), 0);
+    if (s->wrap_text) {
+        /* Wrap inside the card so the box doesn't need a vertical scrollbar */
+        lv_obj_set_width(m->body, LV_PCT(100));
+        lv_label_set_long_mode(m->body, LV_LABEL_LONG_MODE_WRAP);
+    } else {
+        lv_label_set_long_mode(m->body, LV_LABEL_LONG_CLIP);
+    }
+
+    if (s->confirm_text) {
+        lv_obj_t* confirm = lv_msgbox_add_footer_button(mbox, s->confirm_text);
+        modal_style_button(confirm, s->confirm_color);
+        lv_obj_add_event_cb(confirm, confirm_clicked_cb, LV_EVENT_CLICKED, m);
+    }
+    lv_obj_t* dismiss = lv_msgbox_add_footer_button(mbox, s->dismiss_text);
+    modal_style_button(dismiss, 0x555555);
+    lv_obj_add_event_cb(dismiss, dismiss_clicked_cb, LV_EVENT_CLICKED, m);
+
+    lv_obj_t* footer = lv_obj_get_parent(dismiss);
+    lv_obj_add_style(footer, &style_footer, 0);
+    lv_obj_set_flex_flow(footer, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(footer, LV_FLEX_ALIGN_END, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+}
+
+void modal_show(modal_t* m, const char* text) {
+    if (!m->backdrop) {
+        init_styles();
+        build(m);
+    }
+
+    if (!text) text = m->spec->text;
+    if (lv_label_get_text(m->body) != text) lv_label_set_text_static(m->body, text);
+
+    modal_layer_show(m->backdrop);
+}
+
+void modal_close(modal_t* m) {
+    if (m->backdrop) modal_layer_hide(m->backdrop);
+}
+
+bool modal_is_open(const modal_t* m) {
+    return m->backdrop && !lv_obj_has_flag(m->backdrop, LV_OBJ_FLAG_HIDDEN);
+}
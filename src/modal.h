@@ -0,0 +1,70 @@
+#pragma once
+/* modal.h */
+#ifndef MODAL_H
+#define MODAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lvgl/lvgl.h"
+
+/* What a message dialog looks like and does. Colours are 0xRRGGBB. With
+ * `confirm_text` set the footer has a confirm and a dismiss button and
+ * `confirm_cb` runs when confirm is pressed; otherwise it has only the
+ * dismiss button. The dialog is closed before the callback runs.
+ */
+typedef struct {
+    int32_t width;
+    int32_t height;
+    int32_t border_width;      /* 0 for none */
+    uint32_t border_color;
+    const char* title;         /* NULL for none */
+    uint32_t title_color;
+    const char* text;          /* default body, see modal_show() */
+    const lv_font_t* text_font;
+    uint32_t text_color;
+    bool wrap_text;            /* wrap the body instead of clipping it */
+    const char* confirm_text;
+    uint32_t confirm_color;
+    const char* dismiss_text;
+    void (*confirm_cb)(void);
+} modal_spec_t;
+
+/* One message dialog. Keep it in static storage, initialized with
+ * MODAL_INIT(&spec); the widgets are built on first show and then only
+ * hidden and shown again.
+ */
+typedef struct {
+    const modal_spec_t* spec;
+    lv_obj_t* backdrop;
+    lv_obj_t* body;
+} modal_t;
+
+#define MODAL_INIT(spec_ptr) { .spec = (spec_ptr), .backdrop = NULL, .body = NULL }
+
+/* Show the dialog over everything else. `text` replaces the body and must
+ * stay valid while the dialog is shown; NULL shows the spec's text.
+ */
+void modal_show(modal_t* m, const char* text);
+
+void modal_close(modal_t* m);
+bool modal_is_open(const modal_t* m);
+
+/* A hidden full-screen container on the top layer, dimmed by `dim`, that
+ * swallows clicks. Custom dialogs build their content in it once and use
+ * modal_layer_show() / modal_layer_hide() afterwards.
+ */
+lv_obj_t* modal_layer_create(lv_opa_t dim);
+void modal_layer_show(lv_obj_t* layer);
+void modal_layer_hide(lv_obj_t* layer);
+
+/* The card and footer button looks shared by all dialogs */
+void modal_style_card(lv_obj_t* card);
+void modal_style_button(lv_obj_t* btn, uint32_t color);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* MODAL_H */
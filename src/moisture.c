@@ -6,13 +6,21 @@
 #include <strings.h>
 #include "src/flash.h"
 #include "src/moisture.h"
+#include "src/moisture_bar.h"
+#include "src/modal.h"
+#include "src/log_view.h"
+#include "src/tile_grid.h"
 #include "src/server.h"
+#include "src/lib/event_loop.h"
+#include "src/lib/frame_stats.h"
 #include <pthread.h>
+#include <time.h>
 
 /* ---------------- Config ---------------- */
 
-#define MAX_PLOTS 20
+#define MAX_PLOTS 4096
 #define VISIBLE_SLOTS 4
+#define POOL_SLOTS (VISIBLE_SLOTS + 1) /* a scrolled carousel shows part of one more */
 #define ANIM_TIME 300
 
 /* Screen & Layout Constants for 1280x800 */
@@ -36,8 +44,26 @@
 #define BUTTON_SIZE 80
 #define BUTTON_MARGIN 20
 
+/* Carousel */
+#define CAROUSEL_BLEED 8    /* room around the slots for the mode outline */
+#define CAROUSEL_WIDTH (TOTAL_GROUP_WIDTH + 2 * CAROUSEL_BLEED)
+#define CAROUSEL_HEIGHT (SLOT_HEIGHT + 2 * CAROUSEL_BLEED)
+#define DRAG_THRESHOLD 10   /* px of travel before a press becomes a swipe */
+#define KINETIC_GAIN 8      /* release velocity (px per indev read) -> throw */
+#define SCROLL_SPEED 4000   /* px/s for programmatic scrolls */
+#define SCRUBBER_HEIGHT 16
+
+/* Overview */
+#define OVERVIEW_TILE_SIZE 48
+#define OVERVIEW_TILE_GAP 6
+#define OVERVIEW_NEAR_BAND 10     /* % above threshold still shown as a warning */
+#define OVERVIEW_STALE_MS 60000   /* no reading for this long is a fault */
+#define APPLY_IDLE_PERIOD 1000    /* new data runs the apply timer at once; this only ages tiles */
+
 /* Persistence Config: store per-user file under $HOME for consistent restarts */
 #define SAVE_MAGIC 0x4D445031 /* 'MDP1' */
+#define SAVE_VERSION 2
+#define SAVE_V1_PLOTS 20 /* version 1 always stored this many records */
 
 static void get_save_file_path(char *out, size_t out_len) {
     const char *home = getenv("HOME");
@@ -60,34 +86,68 @@ typedef struct {
 /* Runtime-only per-plot output state for D0 (not persisted) */
 static int plot_output_state[MAX_PLOTS];
 
-/* File Header Structure for Save/Load */
+/* Runtime-only lv_tick of each plot's last sensor reading, 0 = none yet */
+static uint32_t plot_last_update[MAX_PLOTS];
+
+/* File Header Structure for Save/Load. The plot records follow the header
+ * back to back: version 1 padded them to SAVE_V1_PLOTS, version 2 writes
+ * exactly plot_count, so both load by reading the first plot_count. */
 typedef struct {
     int32_t magic;
     int32_t version;
     int32_t plot_count;
     int32_t plot_name_counter;
-    plot_data_t plots[MAX_PLOTS];
 } plots_file_t;
 
 static plot_data_t all_plots[MAX_PLOTS];
 static int plot_count = 0;
 static int plot_name_counter = 0; /* Persistent counter for naming */
-static int scroll_offset = 0;
+static int32_t scroll_px = 0; /* carousel scroll position, 0 = first plot at the left */
 
 /* ---------------- Visual Handles ---------------- */
 
+/* Per-slot dirty flags. A slot remembers what it last pushed to its widgets
+ * and only touches the properties whose flag is set, so an unchanged slot
+ * costs no style, label or layout work and invalidates nothing. */
+#define SLOT_DIRTY_VALUE     (1u << 0) /* moisture: bar level (+ percent label) */
+#define SLOT_DIRTY_THRESHOLD (1u << 1) /* bar marker (+ slider/label in edit mode) */
+#define SLOT_DIRTY_NAME      (1u << 2) /* name label text */
+#define SLOT_DIRTY_MODE      (1u << 3) /* edit/delete/rename visuals */
+#define SLOT_DIRTY_ALL       (SLOT_DIRTY_VALUE | SLOT_DIRTY_THRESHOLD | SLOT_DIRTY_NAME | SLOT_DIRTY_MODE)
+
+/* Visual mode bits as seen by a slot */
+#define SLOT_MODE_EDIT   (1 << 0)
+#define SLOT_MODE_DELETE (1 << 1)
+#define SLOT_MODE_RENAME (1 << 2)
+
 typedef struct {
     lv_obj_t* container;
-    lv_obj_t* cover;
-    lv_obj_t* top_line;
+    lv_obj_t* bar; /* track, gradient, level and threshold marker */
     lv_obj_t* label_percent;
     lv_obj_t* label_name;
     lv_obj_t* slider;
+    int data_idx; /* plot currently bound to this view, -1 if none */
+
+    /* Last state applied to the widgets above */
+    bool shown;
+    int shown_mode;
+    int32_t shown_moisture;
+    int32_t shown_threshold;
+    char shown_name[32];
 } slot_handles_t;
 
-static slot_handles_t slots_storage[VISIBLE_SLOTS + 1];
-static slot_handles_t* ui_slots[VISIBLE_SLOTS];
-static slot_handles_t* spare_slot;
+/* Modes are object states resolved against the shared styles below, so a
+ * mode switch is a state flip instead of a rewrite of local style values. */
+#define SLOT_STATE_DELETE LV_STATE_USER_1 /* on the slot container */
+#define SLOT_STATE_RENAME LV_STATE_USER_2 /* on the slot container */
+#define SLOT_STATE_EDIT   LV_STATE_USER_3 /* on the percent label */
+
+/* Recycled slot views. Plot i is always drawn by slots_storage[i % POOL_SLOTS];
+ * at most POOL_SLOTS consecutive plots intersect the viewport, so the views
+ * never collide and the widget count does not grow with plot_count. */
+static slot_handles_t slots_storage[POOL_SLOTS];
+static lv_obj_t* carousel;  /* clipping viewport holding the slot views */
+static lv_obj_t* scrubber;  /* jump-to-page slider under the carousel */
 
 static lv_obj_t* btn_edit;
 static lv_obj_t* btn_edit_label;
@@ -96,6 +156,8 @@ static lv_obj_t* btn_del;
 static lv_obj_t* btn_rename;
 static lv_obj_t* btn_left;
 static lv_obj_t* btn_right;
+static lv_obj_t* btn_overview;
+static lv_obj_t* btn_overview_back;
 
 /* Modes */
 static bool edit_mode = false;
@@ -103,43 +165,20 @@ static bool delete_mode = false;
 static bool rename_mode = false;
 static bool is_animating = false;
 
+/* Swipe State */
+static bool carousel_dragging = false; /* also swallows the click that ends a swipe */
+static lv_point_t drag_start_point;
+static int32_t drag_start_px = 0;
+static int32_t drag_velocity = 0;
+static bool carousel_frozen = false; /* a snapshot slide owns the viewport */
+
 /* Interaction State */
 static int pending_delete_idx = -1;
 static int pending_rename_idx = -1;
-static lv_obj_t* rename_mbox = NULL;
+static lv_obj_t* rename_layer = NULL;
 static lv_obj_t* rename_ta = NULL;
 static lv_obj_t* rename_kb = NULL;
 
-/* ---------------- Gradients ---------------- */
-
-static lv_grad_dsc_t g_top;
-static lv_grad_dsc_t g_btm;
-static bool grads_initialized = false;
-
-static void init_gradients(void) {
-    if (grads_initialized) return;
-
-    g_top.dir = LV_GRAD_DIR_VER;
-    g_top.stops_count = 2;
-    g_top.stops[0].color = lv_color_hex(0x00FF55);
-    g_top.stops[0].opa = LV_OPA_COVER;
-    g_top.stops[0].frac = 0;
-    g_top.stops[1].color = lv_color_hex(0xFFFF00);
-    g_top.stops[1].opa = LV_OPA_COVER;
-    g_top.stops[1].frac = 255;
-
-    g_btm.dir = LV_GRAD_DIR_VER;
-    g_btm.stops_count = 2;
-    g_btm.stops[0].color = lv_color_hex(0xFFFF00);
-    g_btm.stops[0].opa = LV_OPA_COVER;
-    g_btm.stops[0].frac = 0;
-    g_btm.stops[1].color = lv_color_hex(0xFF0000);
-    g_btm.stops[1].opa = LV_OPA_COVER;
-    g_btm.stops[1].frac = 255;
-
-    grads_initialized = true;
-}
-
 /* ---------------- Persistence ---------------- */
 
 static void save_plots_to_disk(void) {
@@ -151,15 +190,12 @@ static void save_plots_to_disk(void) {
     plots_file_t disk;
     memset(&disk, 0, sizeof(disk));
     disk.magic = SAVE_MAGIC;
-    disk.version = 1;
+    disk.version = SAVE_VERSION;
     disk.plot_count = plot_count;
     disk.plot_name_counter = plot_name_counter;
 
-    for (int i = 0; i < MAX_PLOTS; i++) {
-        if (i < plot_count) disk.plots[i] = all_plots[i];
-    }
-
     fwrite(&disk, sizeof(disk), 1, f);
+    fwrite(all_plots, sizeof(plot_data_t), plot_count, f);
     fclose(f);
 }
 
@@ -171,19 +207,25 @@ static bool load_plots_from_disk(void) {
 
     plots_file_t disk;
     size_t n = fread(&disk, sizeof(disk), 1, f);
-    fclose(f);
+    if (n != 1 || disk.magic != SAVE_MAGIC) {
+        fclose(f);
+        return false;
+    }
+
+    int max_count = (disk.version == 1) ? SAVE_V1_PLOTS : MAX_PLOTS;
+    if ((disk.version != 1 && disk.version != SAVE_VERSION) ||
+        disk.plot_count < 0 || disk.plot_count > max_count) {
+        fclose(f);
+        return false;
+    }
 
-    if (n != 1) return false;
-    if (disk.magic != SAVE_MAGIC || disk.version != 1) return false;
-    if (disk.plot_count < 0 || disk.plot_count > MAX_PLOTS) return false;
+    n = fread(all_plots, sizeof(plot_data_t), disk.plot_count, f);
+    fclose(f);
+    if (n != (size_t)disk.plot_count) return false;
 
     plot_count = disk.plot_count;
     plot_name_counter = disk.plot_name_counter;
 
-    for (int i = 0; i < plot_count; i++) {
-        all_plots[i] = disk.plots[i];
-    }
-
     return true;
 }
 
@@ -209,6 +251,7 @@ static void add_new_plot(const char *sensor_mac) {
     p->sim_step = 0;
     /* default output state = off */
     plot_output_state[id] = 0;
+    plot_last_update[id] = 0;
 
     plot_count++;
 }
@@ -285,10 +328,8 @@ static void moisture_retry_pending_timer_cb(lv_timer_t *t) {
 
 /* Public API: add a new plot bound to a sensor MAC string */
 static void refresh_dashboard(void); /* forward declaration so callers above can use it */
-/* Forward declarations for debug-popup helpers added below */
+/* Forward declaration for the debug popup added below */
 static void create_debug_popup(int data_idx);
-static void debug_msgbox_ok_cb(lv_event_t* e);
-static void debug_overlay_close_cb(lv_event_t* e);
 int moisture_add_plot_for_sensor(const char *sensor_mac) {
     if (plot_count >= MAX_PLOTS) return -1;
 
@@ -332,84 +373,107 @@ int moisture_add_plot_for_sensor(const char *sensor_mac) {
  * lets the LVGL timer apply it to the UI.
  */
 
-static lv_coord_t get_slot_x(int index) {
-    return START_X + (index * SLOT_SPACING);
+/* Viewport x of a plot's slot at the current scroll position */
+static lv_coord_t get_slot_x(int data_idx) {
+    return CAROUSEL_BLEED + (data_idx * SLOT_SPACING) - scroll_px;
+}
+
+static int32_t carousel_max_scroll(void) {
+    int extra = plot_count - VISIBLE_SLOTS;
+    return (extra > 0) ? (int32_t)extra * SLOT_SPACING : 0;
 }
 
-static lv_coord_t get_slot_y(int index) {
-    // Removed the staggering effect for cleaner large UI
-    return START_Y;
+static int carousel_page_count(void) {
+    return (plot_count + VISIBLE_SLOTS - 1) / VISIBLE_SLOTS;
 }
 
 static void refresh_dashboard(void);
 static void toggle_delete_mode(void);
 static void toggle_rename_mode(void);
+static void overview_sync(void);
 
 /* ---------------- Visual Updates ---------------- */
 
+static int current_slot_mode(void) {
+    int mode = 0;
+    if (edit_mode) mode |= SLOT_MODE_EDIT;
+    if (delete_mode) mode |= SLOT_MODE_DELETE;
+    else if (rename_mode) mode |= SLOT_MODE_RENAME;
+    return mode;
+}
+
+/* Compare the data against what the slot currently shows */
+static uint32_t slot_dirty_flags(const slot_handles_t* h, const plot_data_t* data, int mode) {
+    if (!h->shown) return SLOT_DIRTY_ALL;
+
+    uint32_t dirty = 0;
+    if (h->shown_mode != mode) dirty |= SLOT_DIRTY_MODE;
+    if (h->shown_moisture != data->moisture) dirty |= SLOT_DIRTY_VALUE;
+    if (h->shown_threshold != data->threshold) dirty |= SLOT_DIRTY_THRESHOLD;
+    if (strncmp(h->shown_name, data->name, sizeof(h->shown_name)) != 0) dirty |= SLOT_DIRTY_NAME;
+    return dirty;
+}
+
 static void fill_slot_with_data(slot_handles_t* h, const plot_data_t* data) {
     if (!data) {
-        lv_obj_add_flag(h->container, LV_OBJ_FLAG_HIDDEN);
+        if (!lv_obj_has_flag(h->container, LV_OBJ_FLAG_HIDDEN)) {
+            lv_obj_add_flag(h->container, LV_OBJ_FLAG_HIDDEN);
+        }
+        h->shown = false;
         return;
     }
-    lv_obj_clear_flag(h->container, LV_OBJ_FLAG_HIDDEN);
-
-    int32_t track_h = TRACK_HEIGHT;
-    int32_t track_y = TRACK_Y_OFFSET;
 
-    /* --- VISUAL MODE HANDLING --- */
-    if (delete_mode) {
-        lv_obj_set_style_outline_width(h->container, 5, 0);
-        lv_obj_set_style_outline_color(h->container, lv_color_hex(0xFF5555), 0);
-        lv_obj_set_style_outline_pad(h->container, 0, 0);
-        lv_obj_set_style_bg_color(h->container, lv_color_hex(0x442222), 0);
-        lv_obj_set_style_text_color(h->label_name, lv_color_hex(0xFF9999), 0);
-    }
-    else if (rename_mode) {
-        lv_obj_set_style_outline_width(h->container, 5, 0);
-        lv_obj_set_style_outline_color(h->container, lv_color_hex(0x00FF00), 0);
-        lv_obj_set_style_outline_pad(h->container, 0, 0);
-        lv_obj_set_style_bg_color(h->container, lv_color_hex(0x224422), 0);
-        lv_obj_set_style_text_color(h->label_name, lv_color_hex(0x99FF99), 0);
-    }
-    else {
-        lv_obj_set_style_outline_width(h->container, 0, 0);
-        lv_obj_set_style_bg_color(h->container, lv_color_hex(0x2B2B2B), 0);
-        lv_obj_set_style_text_color(h->label_name, lv_color_white(), 0);
+    int mode = current_slot_mode();
+    uint32_t dirty = slot_dirty_flags(h, data, mode);
+    if (lv_obj_has_flag(h->container, LV_OBJ_FLAG_HIDDEN)) {
+        lv_obj_clear_flag(h->container, LV_OBJ_FLAG_HIDDEN);
     }
+    if (dirty == 0) return;
 
-    lv_label_set_text(h->label_name, data->name);
+    bool is_edit = (mode & SLOT_MODE_EDIT) != 0;
 
-    if (edit_mode) {
-        lv_label_set_text_fmt(h->label_percent, "%d%%", (int)data->threshold);
-        lv_obj_set_style_text_color(h->label_percent, lv_color_hex(0xFF5555), 0);
-        lv_obj_clear_flag(h->slider, LV_OBJ_FLAG_HIDDEN);
-        if (lv_slider_get_value(h->slider) != data->threshold) {
-            lv_slider_set_value(h->slider, data->threshold, LV_ANIM_OFF);
+    /* --- VISUAL MODE HANDLING --- */
+    if (dirty & SLOT_DIRTY_MODE) {
+        /* The name label inherits its text color from the container state */
+        lv_obj_set_state(h->container, SLOT_STATE_DELETE, (mode & SLOT_MODE_DELETE) != 0);
+        lv_obj_set_state(h->container, SLOT_STATE_RENAME,
+                         (mode & SLOT_MODE_RENAME) && !(mode & SLOT_MODE_DELETE));
+        lv_obj_set_state(h->label_percent, SLOT_STATE_EDIT, is_edit);
+
+        if (is_edit) {
+            lv_obj_clear_flag(h->slider, LV_OBJ_FLAG_HIDDEN);
         }
-    }
-    else {
-        lv_label_set_text_fmt(h->label_percent, "%d%%", (int)data->moisture);
-        lv_obj_set_style_text_color(h->label_percent, lv_color_white(), 0);
-        lv_obj_add_flag(h->slider, LV_OBJ_FLAG_HIDDEN);
+        else {
+            lv_obj_add_flag(h->slider, LV_OBJ_FLAG_HIDDEN);
+        }
+        /* The percent label switches between moisture and threshold */
+        dirty |= is_edit ? SLOT_DIRTY_THRESHOLD : SLOT_DIRTY_VALUE;
     }
 
-    int val = data->moisture;
-    if (val < 0) val = 0; if (val > 100) val = 100;
+    if (dirty & SLOT_DIRTY_NAME) {
+        lv_label_set_text(h->label_name, data->name);
+    }
 
-    int cover_percent = 100 - val;
-    if (cover_percent > 0) {
-        lv_obj_set_height(h->cover, LV_PCT(cover_percent));
-        lv_obj_clear_flag(h->cover, LV_OBJ_FLAG_HIDDEN);
+    if (dirty & SLOT_DIRTY_VALUE) {
+        if (!is_edit) lv_label_set_text_fmt(h->label_percent, "%d%%", (int)data->moisture);
+        moisture_bar_set_value(h->bar, data->moisture);
     }
-    else {
-        lv_obj_set_height(h->cover, 0);
-        lv_obj_add_flag(h->cover, LV_OBJ_FLAG_HIDDEN);
+
+    if (dirty & SLOT_DIRTY_THRESHOLD) {
+        if (is_edit) {
+            lv_label_set_text_fmt(h->label_percent, "%d%%", (int)data->threshold);
+            if (lv_slider_get_value(h->slider) != data->threshold) {
+                lv_slider_set_value(h->slider, data->threshold, LV_ANIM_OFF);
+            }
+        }
+        moisture_bar_set_threshold(h->bar, data->threshold);
     }
 
-    /* Update Threshold Line */
-    int32_t line_px_from_bottom = (track_h * data->threshold) / 100;
-    lv_obj_set_y(h->top_line, track_y + track_h - line_px_from_bottom - 3);
+    h->shown = true;
+    h->shown_mode = mode;
+    h->shown_moisture = data->moisture;
+    h->shown_threshold = data->threshold;
+    snprintf(h->shown_name, sizeof(h->shown_name), "%s", data->name);
 }
 
 /* ---------------- Button Fade Helpers ---------------- */
@@ -451,345 +515,169 @@ static void update_button_visibility(lv_obj_t* btn, bool show) {
     }
 }
 
-static void refresh_dashboard(void) {
-    for (int i = 0; i < VISIBLE_SLOTS; i++) {
-        int data_idx = scroll_offset + i;
-        if (data_idx < plot_count) {
-            fill_slot_with_data(ui_slots[i], &all_plots[data_idx]);
-        }
-        else {
-            fill_slot_with_data(ui_slots[i], NULL);
+/* Bind the view pool to the plots under the viewport for the current
+ * scroll_px. Only views whose plot changed or whose data is dirty do any
+ * widget work; everything off-screen stays hidden. */
+static void layout_carousel(void) {
+    if (carousel_frozen) return; /* views are rebound when the slide lands */
+
+    /* floor(scroll_px / SLOT_SPACING); scroll_px dips below 0 while rubber-banding */
+    int first = (scroll_px >= 0) ? (scroll_px / SLOT_SPACING)
+                                 : -((-scroll_px + SLOT_SPACING - 1) / SLOT_SPACING);
+
+    for (int v = 0; v < POOL_SLOTS; v++) {
+        slot_handles_t* h = &slots_storage[v];
+        int data_idx = first + (((v - first) % POOL_SLOTS) + POOL_SLOTS) % POOL_SLOTS;
+        lv_coord_t x = get_slot_x(data_idx);
+        bool visible = data_idx >= 0 && data_idx < plot_count &&
+                       x < CAROUSEL_WIDTH && x + SLOT_WIDTH > 0;
+
+        if (!visible) {
+            h->data_idx = -1;
+            fill_slot_with_data(h, NULL);
+            continue;
         }
+        h->data_idx = data_idx;
+        lv_obj_set_x(h->container, x);
+        fill_slot_with_data(h, &all_plots[data_idx]);
     }
+}
 
-    bool show_left = (scroll_offset > 0);
-    bool show_right = (scroll_offset + VISIBLE_SLOTS < plot_count);
-
-    update_button_visibility(btn_left, show_left);
-    update_button_visibility(btn_right, show_right);
+static void refresh_dashboard(void) {
+    layout_carousel();
+
+    int32_t max_scroll = carousel_max_scroll();
+    update_button_visibility(btn_left, scroll_px > 0);
+    update_button_visibility(btn_right, scroll_px < max_scroll);
+
+    /* Keep the scrubber on the current page unless the user is dragging it */
+    int pages = carousel_page_count();
+    if (pages > 1) {
+        int32_t page_px = VISIBLE_SLOTS * SLOT_SPACING;
+        int page = (scroll_px >= max_scroll) ? pages - 1 : (scroll_px + page_px / 2) / page_px;
+        if (page < 0) page = 0;
+        lv_obj_clear_flag(scrubber, LV_OBJ_FLAG_HIDDEN);
+        lv_slider_set_range(scrubber, 0, pages - 1);
+        if (!lv_obj_has_state(scrubber, LV_STATE_PRESSED)) {
+            lv_slider_set_value(scrubber, page, LV_ANIM_OFF);
+        }
+    }
+    else {
+        lv_obj_add_flag(scrubber, LV_OBJ_FLAG_HIDDEN);
+    }
 }
 
 /* ---------------- Reset Logic ---------------- */
 
-static void reset_confirm_event_cb(lv_event_t* e) {
-    lv_obj_t* btn = lv_event_get_target(e);
-    lv_obj_t* mbox = (lv_obj_t*)lv_event_get_user_data(e);
-    lv_obj_t* label = lv_obj_get_child(btn, 0);
-    const char* txt = lv_label_get_text(label);
-
-    if (txt && strcmp(txt, "Yes") == 0) {
-        plot_count = 0;
-        plot_name_counter = 0;
-        scroll_offset = 0;
-        /* Re-create Defaults */
-        add_new_plot(NULL); add_new_plot(NULL); add_new_plot(NULL); add_new_plot(NULL);
-        all_plots[0].threshold = 80; all_plots[0].moisture = 50;
-        all_plots[0].sim_target = 50; all_plots[0].sim_step = 0;
-        all_plots[1].threshold = 20; all_plots[1].moisture = 80;
-        all_plots[1].sim_target = 80; all_plots[1].sim_step = 1;
-        all_plots[2].threshold = 95; all_plots[2].moisture = 100;
-        all_plots[2].sim_target = 100; all_plots[2].sim_step = 0;
-        all_plots[3].threshold = 50; all_plots[3].moisture = 10;
-        all_plots[3].sim_target = 10; all_plots[3].sim_step = 1;
+static void reset_confirmed(void) {
+    plot_count = 0;
+    plot_name_counter = 0;
+    scroll_px = 0;
+    /* Re-create Defaults */
+    add_new_plot(NULL); add_new_plot(NULL); add_new_plot(NULL); add_new_plot(NULL);
+    all_plots[0].threshold = 80; all_plots[0].moisture = 50;
+    all_plots[0].sim_target = 50; all_plots[0].sim_step = 0;
+    all_plots[1].threshold = 20; all_plots[1].moisture = 80;
+    all_plots[1].sim_target = 80; all_plots[1].sim_step = 1;
+    all_plots[2].threshold = 95; all_plots[2].moisture = 100;
+    all_plots[2].sim_target = 100; all_plots[2].sim_step = 0;
+    all_plots[3].threshold = 50; all_plots[3].moisture = 10;
+    all_plots[3].sim_target = 10; all_plots[3].sim_step = 1;
+
+    if (delete_mode) toggle_delete_mode();
+    if (rename_mode) toggle_rename_mode();
+    refresh_dashboard();
+    save_plots_to_disk();
+}
 
-        if (delete_mode) toggle_delete_mode();
-        if (rename_mode) toggle_rename_mode();
-        refresh_dashboard();
-        save_plots_to_disk();
-    }
-    lv_msgbox_close(mbox);
-}
-
-static void create_reset_popup(void)
-{
-    lv_obj_t* mbox = lv_msgbox_create(NULL);
-    lv_obj_set_size(mbox, 520, 260);
-    lv_obj_center(mbox);
-
-    lv_obj_set_style_bg_color(mbox, lv_color_hex(0x2B2B2B), 0);
-    lv_obj_set_style_bg_opa(mbox, LV_OPA_COVER, 0);
-    lv_obj_set_style_radius(mbox, 16, 0);
-    lv_obj_set_style_border_color(mbox, lv_color_hex(0xFF5555), 0);
-    lv_obj_set_style_border_width(mbox, 3, 0);
-    lv_obj_set_style_shadow_width(mbox, 40, 0);
-
-    /* ---------- TEXT CONTENT ---------- */
-    lv_obj_t* content = lv_msgbox_get_content(mbox);
-    lv_obj_set_flex_flow(content, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_flex_align(content,
-        LV_FLEX_ALIGN_START,
-        LV_FLEX_ALIGN_START,
-        LV_FLEX_ALIGN_START);
-
-    lv_obj_set_style_pad_top(content, 24, 0);
-    lv_obj_set_style_pad_bottom(content, 24, 0);
-    lv_obj_set_style_pad_left(content, 32, 0);
-    lv_obj_set_style_pad_right(content, 32, 0);
-    lv_obj_set_style_pad_row(content, 8, 0);
-
-    lv_obj_t* title = lv_label_create(content);
-    lv_label_set_text(title, "FACTORY RESET");
-    lv_obj_set_style_text_font(title, &lv_font_montserrat_20, 0);
-    lv_obj_set_style_text_color(title, lv_color_hex(0xFF5555), 0);
-
-    lv_obj_t* txt = lv_label_create(content);
-    lv_label_set_text(txt, "Delete ALL plots and reset to default settings?");
-    lv_obj_set_style_text_color(txt, lv_color_white(), 0);
-    lv_obj_set_style_text_align(txt, LV_TEXT_ALIGN_LEFT, 0);
-    lv_obj_set_style_text_font(txt, &lv_font_montserrat_20, 0);
-
-    /* make sure it does not wrap */
-    lv_label_set_long_mode(txt, LV_LABEL_LONG_CLIP);
-    lv_obj_set_size(mbox, 560, 260);
-
-
-    /* ---------- FOOTER BUTTONS ---------- */
-    lv_obj_t* btn_yes = lv_msgbox_add_footer_button(mbox, "Yes");
-    lv_obj_t* btn_no = lv_msgbox_add_footer_button(mbox, "No");
-
-    lv_obj_t* footer = lv_obj_get_parent(btn_yes);
-    lv_obj_set_size(footer, LV_PCT(100), LV_SIZE_CONTENT);
-    lv_obj_set_style_pad_left(footer, 32, 0);
-    lv_obj_set_style_pad_right(footer, 32, 0);
-    lv_obj_set_style_pad_top(footer, 12, 0);
-    lv_obj_set_style_pad_bottom(footer, 16, 0);
-    lv_obj_set_style_pad_column(footer, 16, 0);
-    lv_obj_set_flex_flow(footer, LV_FLEX_FLOW_ROW);
-    lv_obj_set_flex_align(footer,
-        LV_FLEX_ALIGN_END,
-        LV_FLEX_ALIGN_CENTER,
-        LV_FLEX_ALIGN_CENTER);
-
-    lv_obj_set_height(btn_yes, 56);
-    lv_obj_set_style_pad_left(btn_yes, 28, 0);
-    lv_obj_set_style_pad_right(btn_yes, 28, 0);
-    lv_obj_set_style_radius(btn_yes, 10, 0);
-    lv_obj_set_style_bg_color(btn_yes, lv_color_hex(0xFF0000), 0);
-    lv_obj_set_style_text_color(btn_yes, lv_color_white(), 0);
-
-    lv_obj_set_height(btn_no, 56);
-    lv_obj_set_style_pad_left(btn_no, 28, 0);
-    lv_obj_set_style_pad_right(btn_no, 28, 0);
-    lv_obj_set_style_radius(btn_no, 10, 0);
-    lv_obj_set_style_bg_color(btn_no, lv_color_hex(0x555555), 0);
-    lv_obj_set_style_text_color(btn_no, lv_color_white(), 0);
-
-    lv_obj_add_event_cb(btn_yes, reset_confirm_event_cb, LV_EVENT_CLICKED, mbox);
-    lv_obj_add_event_cb(btn_no, reset_confirm_event_cb, LV_EVENT_CLICKED, mbox);
+static const modal_spec_t reset_spec = {
+    .width = 560, .height = 260,
+    .border_width = 3, .border_color = 0xFF5555,
+    .title = "FACTORY RESET", .title_color = 0xFF5555,
+    .text = "Delete ALL plots and reset to default settings?",
+    .text_font = &lv_font_montserrat_20, .text_color = 0xFFFFFF,
+    .confirm_text = "Yes", .confirm_color = 0xFF0000,
+    .dismiss_text = "No",
+    .confirm_cb = reset_confirmed,
+};
+static modal_t reset_modal = MODAL_INIT(&reset_spec);
+
+static void create_reset_popup(void) {
+    modal_show(&reset_modal, NULL);
 }
 
 
 /* ---------------- Deletion Logic ---------------- */
 
-static void delete_confirm_event_cb(lv_event_t* e) {
-    lv_obj_t* btn = lv_event_get_target(e);
-    lv_obj_t* mbox_ref = (lv_obj_t*)lv_event_get_user_data(e);
-    lv_obj_t* label = lv_obj_get_child(btn, 0);
-    const char* txt = lv_label_get_text(label);
-
-    if (txt && strcmp(txt, "Yes") == 0 && pending_delete_idx >= 0) {
-        for (int i = pending_delete_idx; i < plot_count - 1; i++) {
-            all_plots[i] = all_plots[i + 1];
-        }
-        plot_count--;
-        if (scroll_offset > 0 && scroll_offset > plot_count - VISIBLE_SLOTS) {
-            scroll_offset = (plot_count > VISIBLE_SLOTS) ? (plot_count - VISIBLE_SLOTS) : 0;
-        }
-        refresh_dashboard();
-        save_plots_to_disk();
+static void delete_confirmed(void) {
+    if (pending_delete_idx < 0) return;
+    for (int i = pending_delete_idx; i < plot_count - 1; i++) {
+        all_plots[i] = all_plots[i + 1];
+        plot_last_update[i] = plot_last_update[i + 1];
     }
-    lv_msgbox_close(mbox_ref);
+    plot_count--;
     pending_delete_idx = -1;
+    if (scroll_px > carousel_max_scroll()) scroll_px = carousel_max_scroll();
+    refresh_dashboard();
+    save_plots_to_disk();
 }
 
-static void create_delete_popup(int data_idx)
-{
+static const modal_spec_t delete_spec = {
+    .width = 520, .height = 260,
+    .title = "Delete Plot", .title_color = 0xFFFFFF,
+    .text = "Are you sure you want to delete this plot?",
+    .text_font = &lv_font_montserrat_20, .text_color = 0xCCCCCC,
+    .confirm_text = "Yes", .confirm_color = 0xFF5555,
+    .dismiss_text = "No",
+    .confirm_cb = delete_confirmed,
+};
+static modal_t delete_modal = MODAL_INIT(&delete_spec);
+
+static void create_delete_popup(int data_idx) {
     pending_delete_idx = data_idx;
-
-    lv_obj_t* mbox = lv_msgbox_create(NULL);
-    lv_obj_set_size(mbox, 520, 260);
-    lv_obj_center(mbox);
-
-    lv_obj_set_style_bg_color(mbox, lv_color_hex(0x2B2B2B), 0);
-    lv_obj_set_style_bg_opa(mbox, LV_OPA_COVER, 0);
-    lv_obj_set_style_radius(mbox, 16, 0);
-    lv_obj_set_style_border_width(mbox, 0, 0);
-    lv_obj_set_style_shadow_width(mbox, 40, 0);
-
-    /* CONTENT (title + text) */
-    lv_obj_t* content = lv_msgbox_get_content(mbox);
-    lv_obj_set_flex_flow(content, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_flex_align(content,
-        LV_FLEX_ALIGN_START,    /* vertical: top-down   */
-        LV_FLEX_ALIGN_START,    /* horizontal: left     */
-        LV_FLEX_ALIGN_START);
-
-    lv_obj_set_style_pad_top(content, 24, 0);
-    lv_obj_set_style_pad_bottom(content, 24, 0);
-    lv_obj_set_style_pad_left(content, 32, 0);
-    lv_obj_set_style_pad_right(content, 32, 0);
-    lv_obj_set_style_pad_row(content, 8, 0);
-
-    lv_obj_t* title_lbl = lv_label_create(content);
-    lv_label_set_text(title_lbl, "Delete Plot");
-    lv_obj_set_style_text_color(title_lbl, lv_color_white(), 0);
-    lv_obj_set_style_text_font(title_lbl, &lv_font_montserrat_20, 0);
-
-    lv_obj_t* txt = lv_label_create(content);
-    lv_label_set_text(txt, "Are you sure you want to delete this plot?");
-    lv_obj_set_style_text_font(txt, &lv_font_montserrat_20, 0);
-    lv_obj_set_style_text_color(txt, lv_color_hex(0xCCCCCC), 0);
-    lv_obj_set_style_text_align(txt, LV_TEXT_ALIGN_LEFT, 0);
-
-    /* FOOTER BUTTONS (msgbox built‑in row at bottom) */
-    lv_obj_t* btn_yes = lv_msgbox_add_footer_button(mbox, "Yes");
-    lv_obj_t* btn_no = lv_msgbox_add_footer_button(mbox, "No");
-
-    /* make the footer row fill width with side/bottom margins */
-    lv_obj_t* footer = lv_obj_get_parent(btn_yes);
-    lv_obj_set_size(footer, LV_PCT(100), LV_SIZE_CONTENT);
-    lv_obj_set_style_pad_left(footer, 32, 0);
-    lv_obj_set_style_pad_right(footer, 32, 0);
-    lv_obj_set_style_pad_top(footer, 12, 0);
-    lv_obj_set_style_pad_bottom(footer, 16, 0);
-    lv_obj_set_style_pad_column(footer, 16, 0);
-    lv_obj_set_flex_flow(footer, LV_FLEX_FLOW_ROW);
-    lv_obj_set_flex_align(footer,
-        LV_FLEX_ALIGN_END,      /* buttons right‑aligned */
-        LV_FLEX_ALIGN_CENTER,
-        LV_FLEX_ALIGN_CENTER);
-
-    lv_obj_set_height(btn_yes, 56);
-    lv_obj_set_style_pad_left(btn_yes, 28, 0);
-    lv_obj_set_style_pad_right(btn_yes, 28, 0);
-    lv_obj_set_style_radius(btn_yes, 10, 0);
-    lv_obj_set_style_bg_color(btn_yes, lv_color_hex(0xFF5555), 0);
-
-    lv_obj_set_height(btn_no, 56);
-    lv_obj_set_style_pad_left(btn_no, 28, 0);
-    lv_obj_set_style_pad_right(btn_no, 28, 0);
-    lv_obj_set_style_radius(btn_no, 10, 0);
-    lv_obj_set_style_bg_color(btn_no, lv_color_hex(0x555555), 0);
-
-    lv_obj_add_event_cb(btn_yes, delete_confirm_event_cb, LV_EVENT_CLICKED, mbox);
-    lv_obj_add_event_cb(btn_no, delete_confirm_event_cb, LV_EVENT_CLICKED, mbox);
+    modal_show(&delete_modal, NULL);
 }
 
 /* ---------------- Flash (Add) Confirmation Popup ---------------- */
 
-static void flash_confirm_event_cb(lv_event_t* e) {
-    lv_obj_t* btn = lv_event_get_target(e);
-    lv_obj_t* mbox_ref = (lv_obj_t*)lv_event_get_user_data(e);
-    lv_obj_t* label = lv_obj_get_child(btn, 0);
-    const char* txt = lv_label_get_text(label);
-
-    if (txt && strcmp(txt, "Yes") == 0) {
-        /* Immediate status so we know the callback fired */
-        moisture_flash_status_update("User confirmed flash: starting...");
-        /* Start flashing in background; UI shows further status via moisture_flash_status_update */
-        int rc = flash_flash_first_device_and_register();
-        if (rc != 0) {
-            moisture_flash_status_update("Failed to start flash thread");
-        }
+static void flash_confirmed(void) {
+    /* Immediate status so we know the callback fired */
+    moisture_flash_status_update("User confirmed flash: starting...");
+    /* Start flashing in background; UI shows further status via moisture_flash_status_update */
+    int rc = flash_all_devices_and_register();
+    if (rc != 0) {
+        moisture_flash_status_update("Failed to start flash thread");
     }
-    lv_msgbox_close(mbox_ref);
-}
-
-static void create_flash_popup(void)
-{
-    lv_obj_t* mbox = lv_msgbox_create(NULL);
-    lv_obj_set_size(mbox, 520, 260);
-    lv_obj_center(mbox);
-
-    lv_obj_set_style_bg_color(mbox, lv_color_hex(0x2B2B2B), 0);
-    lv_obj_set_style_bg_opa(mbox, LV_OPA_COVER, 0);
-    lv_obj_set_style_radius(mbox, 16, 0);
-    lv_obj_set_style_border_width(mbox, 0, 0);
-    lv_obj_set_style_shadow_width(mbox, 40, 0);
-
-    /* CONTENT (title + text) */
-    lv_obj_t* content = lv_msgbox_get_content(mbox);
-    lv_obj_set_flex_flow(content, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_flex_align(content,
-        LV_FLEX_ALIGN_START,    /* vertical: top-down   */
-        LV_FLEX_ALIGN_START,    /* horizontal: left     */
-        LV_FLEX_ALIGN_START);
-
-    lv_obj_set_style_pad_top(content, 24, 0);
-    lv_obj_set_style_pad_bottom(content, 24, 0);
-    lv_obj_set_style_pad_left(content, 32, 0);
-    lv_obj_set_style_pad_right(content, 32, 0);
-    lv_obj_set_style_pad_row(content, 8, 0);
-
-    lv_obj_t* title_lbl = lv_label_create(content);
-    lv_label_set_text(title_lbl, "Flash Arduino");
-    lv_obj_set_style_text_color(title_lbl, lv_color_white(), 0);
-    lv_obj_set_style_text_font(title_lbl, &lv_font_montserrat_20, 0);
-
-    lv_obj_t* txt = lv_label_create(content);
-    lv_label_set_text(txt, "Attach an Arduino (Nano 33 IoT) to the Pi via USB and press Yes to flash and register it.");
-    /* Limit width and enable wrapping so the popup doesn't require a vertical scrollbar */
-    lv_obj_set_width(txt, 456);
-    lv_label_set_long_mode(txt, LV_LABEL_LONG_MODE_WRAP);
-    lv_obj_set_style_text_font(txt, &lv_font_montserrat_18, 0);
-    lv_obj_set_style_text_color(txt, lv_color_hex(0xCCCCCC), 0);
-    lv_obj_set_style_text_align(txt, LV_TEXT_ALIGN_LEFT, 0);
-
-    /* FOOTER BUTTONS (msgbox built‑in row at bottom) */
-    lv_obj_t* btn_yes = lv_msgbox_add_footer_button(mbox, "Yes");
-    lv_obj_t* btn_no = lv_msgbox_add_footer_button(mbox, "No");
-
-    /* make the footer row fill width with side/bottom margins */
-    lv_obj_t* footer = lv_obj_get_parent(btn_yes);
-    lv_obj_set_size(footer, LV_PCT(100), LV_SIZE_CONTENT);
-    lv_obj_set_style_pad_left(footer, 32, 0);
-    lv_obj_set_style_pad_right(footer, 32, 0);
-    lv_obj_set_style_pad_top(footer, 12, 0);
-    lv_obj_set_style_pad_bottom(footer, 16, 0);
-    lv_obj_set_style_pad_column(footer, 16, 0);
-    lv_obj_set_flex_flow(footer, LV_FLEX_FLOW_ROW);
-    lv_obj_set_flex_align(footer,
-        LV_FLEX_ALIGN_END,      /* buttons right‑aligned */
-        LV_FLEX_ALIGN_CENTER,
-        LV_FLEX_ALIGN_CENTER);
-
-    lv_obj_set_height(btn_yes, 56);
-    lv_obj_set_style_pad_left(btn_yes, 28, 0);
-    lv_obj_set_style_pad_right(btn_yes, 28, 0);
-    lv_obj_set_style_radius(btn_yes, 10, 0);
-    lv_obj_set_style_bg_color(btn_yes, lv_color_hex(0x00AA00), 0);
-    lv_obj_set_style_text_color(btn_yes, lv_color_white(), 0);
-
-    lv_obj_set_height(btn_no, 56);
-    lv_obj_set_style_pad_left(btn_no, 28, 0);
-    lv_obj_set_style_pad_right(btn_no, 28, 0);
-    lv_obj_set_style_radius(btn_no, 10, 0);
-    lv_obj_set_style_bg_color(btn_no, lv_color_hex(0x555555), 0);
-    lv_obj_set_style_text_color(btn_no, lv_color_white(), 0);
-
-    lv_obj_add_event_cb(btn_yes, flash_confirm_event_cb, LV_EVENT_CLICKED, mbox);
-    lv_obj_add_event_cb(btn_no, flash_confirm_event_cb, LV_EVENT_CLICKED, mbox);
 }
 
-
+static const modal_spec_t flash_spec = {
+    .width = 520, .height = 260,
+    .title = "Flash Arduino", .title_color = 0xFFFFFF,
+    .text = "Attach one or more Arduinos (Nano 33 IoT) to the Pi via USB and press Yes to flash and register them.",
+    .text_font = &lv_font_montserrat_18, .text_color = 0xCCCCCC,
+    .wrap_text = true,
+    .confirm_text = "Yes", .confirm_color = 0x00AA00,
+    .dismiss_text = "No",
+    .confirm_cb = flash_confirmed,
+};
+static modal_t flash_modal = MODAL_INIT(&flash_spec);
+
+static void create_flash_popup(void) {
+    modal_show(&flash_modal, NULL);
+}
 
 
 /* ---------------- Rename Logic ---------------- */
 
 static void close_rename_popup(void) {
-    if (rename_mbox) {
-        lv_obj_delete(rename_mbox);
-        rename_mbox = NULL;
-        rename_ta = NULL;
-        rename_kb = NULL;
-    }
+    if (rename_layer) modal_layer_hide(rename_layer);
     pending_rename_idx = -1;
 }
 
 static void rename_kb_event_cb(lv_event_t* e) {
     lv_event_code_t code = lv_event_get_code(e);
     if (code == LV_EVENT_READY) {
-        if (pending_rename_idx >= 0 && rename_ta) {
+        if (pending_rename_idx >= 0) {
             const char* txt = lv_textarea_get_text(rename_ta);
             if (strlen(txt) > 0) {
                 snprintf(all_plots[pending_rename_idx].name, 32, "%s", txt);
@@ -806,215 +694,194 @@ static void rename_kb_event_cb(lv_event_t* e) {
 
 static void create_rename_popup(int data_idx) {
     pending_rename_idx = data_idx;
-    rename_mbox = lv_obj_create(lv_screen_active());
-    lv_obj_set_size(rename_mbox, LV_PCT(100), LV_PCT(100));
-    lv_obj_set_style_bg_color(rename_mbox, lv_color_hex(0x000000), 0);
-    lv_obj_set_style_bg_opa(rename_mbox, LV_OPA_70, 0);
-    lv_obj_set_style_border_width(rename_mbox, 0, 0);
-    lv_obj_add_flag(rename_mbox, LV_OBJ_FLAG_CLICKABLE);
-
-    rename_ta = lv_textarea_create(rename_mbox);
-    lv_textarea_set_one_line(rename_ta, true);
-    lv_textarea_set_text(rename_ta, all_plots[data_idx].name);
-    lv_textarea_set_max_length(rename_ta, 12);
-    lv_obj_align(rename_ta, LV_ALIGN_TOP_MID, 0, 100);
-    lv_obj_set_width(rename_ta, 400);
-    lv_obj_set_height(rename_ta, 60);
 
-    rename_kb = lv_keyboard_create(rename_mbox);
-    lv_keyboard_set_textarea(rename_kb, rename_ta);
-    lv_obj_add_event_cb(rename_kb, rename_kb_event_cb, LV_EVENT_ALL, NULL);
+    /* The text area and the keyboard are built once and kept hidden */
+    if (!rename_layer) {
+        rename_layer = modal_layer_create(LV_OPA_70);
+
+        rename_ta = lv_textarea_create(rename_layer);
+        lv_textarea_set_one_line(rename_ta, true);
+        lv_textarea_set_max_length(rename_ta, 12);
+        lv_obj_align(rename_ta, LV_ALIGN_TOP_MID, 0, 100);
+        lv_obj_set_width(rename_ta, 400);
+        lv_obj_set_height(rename_ta, 60);
+
+        rename_kb = lv_keyboard_create(rename_layer);
+        lv_keyboard_set_textarea(rename_kb, rename_ta);
+        lv_obj_add_event_cb(rename_kb, rename_kb_event_cb, LV_EVENT_ALL, NULL);
+
+        /* Make keyboard larger */
+        lv_obj_set_height(rename_kb, LV_PCT(50));
+    }
 
-    /* Make keyboard larger */
-    lv_obj_set_height(rename_kb, LV_PCT(50));
+    lv_textarea_set_text(rename_ta, all_plots[data_idx].name);
+    lv_keyboard_set_mode(rename_kb, LV_KEYBOARD_MODE_TEXT_LOWER);
+    modal_layer_show(rename_layer);
 
     lv_obj_send_event(rename_ta, LV_EVENT_FOCUSED, NULL);
 }
 
-static void debug_msgbox_ok_cb(lv_event_t* e) {
-    lv_obj_t* mbox = (lv_obj_t*)lv_event_get_user_data(e);
-    if (mbox) lv_msgbox_close(mbox);
+/* ---------------- Debug Output Popup ---------------- */
+
+static const modal_spec_t no_device_spec = {
+    .width = 480, .height = 200,
+    .text = "No device bound to this plot",
+    .text_font = &lv_font_montserrat_20, .text_color = 0xFFFFFF,
+    .dismiss_text = "OK",
+};
+static modal_t no_device_modal = MODAL_INIT(&no_device_spec);
+
+/* The device's log, built on first use. Lines are pulled from the server's
+ * log ring by sequence number as they scroll into view. */
+static struct {
+    lv_obj_t* layer;
+    lv_obj_t* log;
+    lv_obj_t* empty; /* placeholder while the device has said nothing */
+    lv_timer_t* tmr;
+    char mac[32];
+} debug_view;
+
+static bool debug_fetch_line(uint64_t seq, char* buf, size_t len, void* user_data) {
+    LV_UNUSED(user_data);
+    return server_get_log_line_for_mac(debug_view.mac, seq, buf, len) >= 0;
 }
 
-typedef struct {
-    lv_obj_t *overlay;
-    lv_obj_t *ta;
-    char mac[32];
-    lv_timer_t *tmr;
-} debug_ctx_t;
+/* Append whatever arrived since the last check */
+static void debug_refresh_cb(lv_timer_t* t) {
+    LV_UNUSED(t);
+    uint64_t first = 0, next = 0;
+    if (server_get_log_range_for_mac(debug_view.mac, &first, &next) != 0) first = next = 0;
+    log_view_set_range(debug_view.log, first, next);
+    if ((next == first) != lv_obj_has_flag(debug_view.empty, LV_OBJ_FLAG_HIDDEN)) return;
+    if (next == first) lv_obj_remove_flag(debug_view.empty, LV_OBJ_FLAG_HIDDEN);
+    else lv_obj_add_flag(debug_view.empty, LV_OBJ_FLAG_HIDDEN);
+}
 
-static void debug_refresh_cb(lv_timer_t *t) {
-    debug_ctx_t *ctx = (debug_ctx_t*)lv_timer_get_user_data(t);
-    if (!ctx || !ctx->ta) return;
-    char *buf = malloc(8192);
-    if (!buf) return;
-    int rc = server_get_live_text_for_mac(ctx->mac, buf, 8192);
-    if (rc > 0 && buf[0]) lv_textarea_set_text(ctx->ta, buf);
-    else lv_textarea_set_text(ctx->ta, "<no live output>");
-    free(buf);
+static void debug_close_event_cb(lv_event_t* e) {
+    LV_UNUSED(e);
+    lv_timer_pause(debug_view.tmr);
+    modal_layer_hide(debug_view.layer);
 }
 
-static void debug_overlay_close_cb(lv_event_t* e) {
-    debug_ctx_t *ctx = (debug_ctx_t*)lv_event_get_user_data(e);
-    if (!ctx) return;
-    if (ctx->tmr) lv_timer_del(ctx->tmr);
-    if (ctx->overlay) lv_obj_del(ctx->overlay);
-    free(ctx);
+static void build_debug_view(void) {
+    debug_view.layer = modal_layer_create(LV_OPA_50);
+
+    lv_obj_t* card = lv_obj_create(debug_view.layer);
+    modal_style_card(card);
+    lv_obj_set_size(card, 520, 380);
+    lv_obj_center(card);
+    lv_obj_set_flex_flow(card, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_flex_align(card, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START);
+    lv_obj_set_style_pad_all(card, 12, 0);
+
+    debug_view.log = log_view_create(card, &lv_font_montserrat_18, debug_fetch_line, NULL);
+    lv_obj_set_size(debug_view.log, 496, 300);
+    /* Black with white text to match a console-like view */
+    lv_obj_set_style_bg_color(debug_view.log, lv_color_hex(0x000000), 0);
+    lv_obj_set_style_bg_opa(debug_view.log, LV_OPA_COVER, 0);
+    lv_obj_set_style_text_color(debug_view.log, lv_color_white(), 0);
+    lv_obj_set_style_border_width(debug_view.log, 0, 0);
+
+    debug_view.empty = lv_label_create(debug_view.log);
+    lv_label_set_text_static(debug_view.empty, "<no live output>");
+    lv_obj_set_style_text_font(debug_view.empty, &lv_font_montserrat_18, 0);
+    lv_obj_set_style_text_color(debug_view.empty, lv_color_hex(0x888888), 0);
+
+    lv_obj_t* close_btn = lv_btn_create(card);
+    modal_style_button(close_btn, 0x555555);
+    lv_obj_set_size(close_btn, 140, 44);
+    lv_obj_t* lbl = lv_label_create(close_btn);
+    lv_label_set_text_static(lbl, "Close");
+    lv_obj_add_event_cb(close_btn, debug_close_event_cb, LV_EVENT_CLICKED, NULL);
+
+    /* Poll for new lines every 500ms while shown */
+    debug_view.tmr = lv_timer_create(debug_refresh_cb, 500, NULL);
+    lv_timer_pause(debug_view.tmr);
 }
 
 /* ---------------- Event Handlers ---------------- */
 
+static void sync_mode_buttons(void) {
+    lv_obj_set_state(btn_del, LV_STATE_CHECKED, delete_mode);
+    lv_obj_set_state(btn_rename, LV_STATE_CHECKED, rename_mode);
+}
+
 static void toggle_delete_mode(void) {
     delete_mode = !delete_mode;
-    if (delete_mode) {
-        rename_mode = false;
-        lv_obj_set_style_bg_color(btn_rename, lv_color_hex(0x2B2B2B), 0);
-        lv_obj_set_style_text_color(btn_rename, lv_color_white(), 0);
-        lv_obj_set_style_bg_color(btn_del, lv_color_hex(0xFF5555), 0);
-        lv_obj_set_style_text_color(btn_del, lv_color_white(), 0);
-    }
-    else {
-        lv_obj_set_style_bg_color(btn_del, lv_color_hex(0x2B2B2B), 0);
-        lv_obj_set_style_text_color(btn_del, lv_color_white(), 0);
-    }
+    if (delete_mode) rename_mode = false;
+    sync_mode_buttons();
     refresh_dashboard();
 }
 
 static void toggle_rename_mode(void) {
     rename_mode = !rename_mode;
-    if (rename_mode) {
-        delete_mode = false;
-        lv_obj_set_style_bg_color(btn_del, lv_color_hex(0x2B2B2B), 0);
-        lv_obj_set_style_text_color(btn_del, lv_color_white(), 0);
-        lv_obj_set_style_bg_color(btn_rename, lv_color_hex(0x00AA00), 0);
-        lv_obj_set_style_text_color(btn_rename, lv_color_white(), 0);
-    }
-    else {
-        lv_obj_set_style_bg_color(btn_rename, lv_color_hex(0x2B2B2B), 0);
-        lv_obj_set_style_text_color(btn_rename, lv_color_white(), 0);
-    }
+    if (rename_mode) delete_mode = false;
+    sync_mode_buttons();
     refresh_dashboard();
 }
 
-static void slot_click_event_cb(lv_event_t* e) {
-    lv_obj_t* target = lv_event_get_target(e);
-    int slot_idx = -1;
-
-    for (int i = 0; i < VISIBLE_SLOTS; i++) {
-        if (ui_slots[i]->container == target || ui_slots[i]->slider == target) {
-            slot_idx = i;
-            break;
+static slot_handles_t* slot_for_obj(lv_obj_t* obj) {
+    for (int i = 0; i < POOL_SLOTS; i++) {
+        if (slots_storage[i].container == obj || slots_storage[i].slider == obj) {
+            return &slots_storage[i];
         }
     }
-    if (slot_idx == -1) return;
+    return NULL;
+}
+
+static void slot_click_event_cb(lv_event_t* e) {
+    /* Releasing a swipe is not a tap on the slot under the finger */
+    if (carousel_dragging) return;
 
-    int data_idx = scroll_offset + slot_idx;
-    if (data_idx >= plot_count) return;
+    slot_handles_t* h = slot_for_obj(lv_event_get_target(e));
+    if (!h) return;
+
+    int data_idx = h->data_idx;
+    if (data_idx < 0 || data_idx >= plot_count) return;
 
     if (delete_mode) create_delete_popup(data_idx);
     else if (rename_mode) create_rename_popup(data_idx);
     else if (!edit_mode) create_debug_popup(data_idx);
 }
 
-/* Show debug output popup for a plot's sensor (non-modal overlay) */
+/* Show the live debug output of a plot's sensor */
 static void create_debug_popup(int data_idx) {
     if (data_idx < 0 || data_idx >= plot_count) return;
     const char *mac = all_plots[data_idx].sensor_mac;
     if (!mac || mac[0] == '\0') {
-        /* no device bound */
-        lv_obj_t* m = lv_msgbox_create(NULL);
-        lv_obj_set_size(m, 480, 200);
-        lv_obj_center(m);
-        lv_obj_t* content = lv_msgbox_get_content(m);
-        lv_obj_t* lbl = lv_label_create(content);
-        lv_label_set_text(lbl, "No device bound to this plot");
-        lv_obj_t* btn = lv_msgbox_add_footer_button(m, "OK");
-        lv_obj_add_event_cb(btn, debug_msgbox_ok_cb, LV_EVENT_CLICKED, m);
+        modal_show(&no_device_modal, NULL);
         return;
     }
 
-    /* Create a centered modal (same visual style as other popups) */
-    lv_obj_t* mbox = lv_obj_create(lv_screen_active());
-    lv_obj_set_size(mbox, 520, 380);
-    lv_obj_center(mbox);
-    lv_obj_set_style_bg_color(mbox, lv_color_hex(0x2B2B2B), 0);
-    lv_obj_set_style_bg_opa(mbox, LV_OPA_COVER, 0);
-    lv_obj_set_style_radius(mbox, 16, 0);
-    lv_obj_set_style_border_width(mbox, 0, 0);
-    lv_obj_set_style_shadow_width(mbox, 40, 0);
-
-    lv_obj_t* content = mbox; /* use mbox as container */
-    lv_obj_set_flex_flow(content, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_flex_align(content, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START);
-    lv_obj_set_style_pad_top(content, 12, 0);
-    lv_obj_set_style_pad_bottom(content, 12, 0);
-    lv_obj_set_style_pad_left(content, 12, 0);
-    lv_obj_set_style_pad_right(content, 12, 0);
-
-    lv_obj_t* ta = lv_textarea_create(content);
-    lv_obj_set_size(ta, 496, 300);
-    lv_obj_align(ta, LV_ALIGN_TOP_MID, 0, 16);
-    lv_obj_set_style_text_font(ta, &lv_font_montserrat_18, 0);
-    /* Make text area black with white text to match a console-like view */
-    lv_obj_set_style_bg_color(ta, lv_color_hex(0x000000), 0);
-    lv_obj_set_style_bg_opa(ta, LV_OPA_COVER, 0);
-    lv_obj_set_style_text_color(ta, lv_color_white(), 0);
-    lv_textarea_set_text(ta, "<loading...>");
-
-    lv_obj_t* close_btn = lv_btn_create(content);
-    lv_obj_set_size(close_btn, 140, 44);
-    lv_obj_align(close_btn, LV_ALIGN_BOTTOM_MID, 0, -8);
-    lv_obj_set_style_radius(close_btn, 10, 0);
-    lv_obj_set_style_bg_color(close_btn, lv_color_hex(0x555555), 0);
-    lv_obj_set_style_text_color(close_btn, lv_color_white(), 0);
-    lv_obj_t* lbl = lv_label_create(close_btn);
-    lv_label_set_text(lbl, "Close");
-
-    /* Create context for periodic refresh */
-    debug_ctx_t *ctx = malloc(sizeof(debug_ctx_t));
-    if (!ctx) {
-        lv_obj_del(mbox);
-        return;
+    if (!debug_view.layer) build_debug_view();
+    if (strcasecmp(debug_view.mac, mac) != 0) {
+        snprintf(debug_view.mac, sizeof(debug_view.mac), "%s", mac);
+        log_view_clear(debug_view.log);
     }
-    memset(ctx,0,sizeof(*ctx));
-    ctx->overlay = mbox;
-    ctx->ta = ta;
-    strncpy(ctx->mac, mac, sizeof(ctx->mac)-1);
-    ctx->mac[sizeof(ctx->mac)-1] = '\0';
+    modal_layer_show(debug_view.layer);
 
-    /* Create timer to refresh live text every 500ms */
-    ctx->tmr = lv_timer_create(debug_refresh_cb, 500, ctx);
-    /* Attach close handler with ctx so it can clean up */
-    lv_obj_add_event_cb(close_btn, debug_overlay_close_cb, LV_EVENT_CLICKED, ctx);
+    lv_timer_resume(debug_view.tmr);
+    lv_timer_ready(debug_view.tmr);
 }
 
 static void slider_event_cb(lv_event_t* e) {
     lv_obj_t* slider = lv_event_get_target(e);
     if (is_animating) return;
 
-    int slot_idx = -1;
-    for (int i = 0; i < VISIBLE_SLOTS; i++) {
-        if (ui_slots[i]->slider == slider) {
-            slot_idx = i;
-            break;
-        }
-    }
-    if (slot_idx == -1) return;
+    slot_handles_t* h = slot_for_obj(slider);
+    if (!h) return;
+
+    int data_idx = h->data_idx;
+    if (data_idx < 0 || data_idx >= plot_count) return;
 
     if (delete_mode || rename_mode) {
         /* If in a mode where slider interaction is forbidden, revert */
-        int data_idx = scroll_offset + slot_idx;
-        if (data_idx < plot_count) {
-            lv_slider_set_value(ui_slots[slot_idx]->slider, all_plots[data_idx].threshold, LV_ANIM_OFF);
-        }
+        lv_slider_set_value(h->slider, all_plots[data_idx].threshold, LV_ANIM_OFF);
         return;
     }
 
-    int data_idx = scroll_offset + slot_idx;
-    if (data_idx >= plot_count) return;
-
     all_plots[data_idx].threshold = lv_slider_get_value(slider);
-    fill_slot_with_data(ui_slots[slot_idx], &all_plots[data_idx]);
+    fill_slot_with_data(h, &all_plots[data_idx]);
     save_plots_to_disk();
     /* Push threshold to device if it has a MAC */
     if (all_plots[data_idx].sensor_mac[0] != '\0') {
@@ -1069,7 +936,7 @@ static void add_button_event_cb(lv_event_t* e) {
     if (lv_event_get_code(e) == LV_EVENT_CLICKED) {
         /* Show a confirmation popup instructing the user to attach an
          * Arduino. Pressing Yes will start the asynchronous flash/registration
-         * flow provided by `flash_flash_first_device_and_register()`.
+         * flow provided by `flash_all_devices_and_register()`.
          */
         create_flash_popup();
     }
@@ -1077,8 +944,10 @@ static void add_button_event_cb(lv_event_t* e) {
 
 /* ---------------- Animation + Scroll ---------------- */
 
-static void anim_x_cb(void* var, int32_t v) {
-    lv_obj_set_x((lv_obj_t*)var, v);
+static void anim_scroll_cb(void* var, int32_t v) {
+    (void)var;
+    scroll_px = v;
+    refresh_dashboard();
 }
 
 static void anim_ready_cb(lv_anim_t* a) {
@@ -1086,133 +955,209 @@ static void anim_ready_cb(lv_anim_t* a) {
     refresh_dashboard();
 }
 
-static void animate_slide(int direction) {
-    if (is_animating) return;
-    is_animating = true;
+/* Snapshot slide. A programmatic scroll renders the viewport once where it
+ * starts and once where it lands, hides the slot views and slides the two
+ * bitmaps, so a frame is two image blits rather than five slot trees. Long
+ * jumps travel at most one viewport on screen. */
+static lv_draw_buf_t* slide_buf[2]; /* [0] = from, [1] = to */
+static lv_obj_t* slide_img[2];
+static int32_t slide_from_px = 0;
+static int32_t slide_dist = 0;   /* scroll distance, signed */
+static int32_t slide_travel = 0; /* on-screen travel, 0..CAROUSEL_WIDTH */
+static int32_t slide_pos = 0;
+
+static bool take_viewport_snapshot(int i) {
+    if (!slide_buf[i]) {
+        slide_buf[i] = lv_draw_buf_create(CAROUSEL_WIDTH, CAROUSEL_HEIGHT, LV_COLOR_FORMAT_RGB565, 0);
+        if (!slide_buf[i]) return false;
+    }
+    lv_obj_update_layout(carousel);
+    if (lv_snapshot_take_to_draw_buf(carousel, LV_COLOR_FORMAT_RGB565, slide_buf[i]) != LV_RESULT_OK) {
+        return false;
+    }
+    lv_image_cache_drop(slide_buf[i]);
+    return true;
+}
 
-    /*
-       With 1280x800, we don't use Y staggering.
-       Everything moves purely horizontally.
-    */
-
-    lv_anim_t a_cb;
-    lv_anim_init(&a_cb);
-    lv_anim_set_exec_cb(&a_cb, anim_x_cb);
-    lv_anim_set_time(&a_cb, ANIM_TIME);
-    lv_anim_set_path_cb(&a_cb, lv_anim_path_ease_out);
-
-    if (direction == 1) { // Moving RIGHT (showing content from right)
-        scroll_offset++;
-
-        slot_handles_t* new_right_slot = spare_slot;
-        int new_data_idx = scroll_offset + 3;
-
-        fill_slot_with_data(new_right_slot, (new_data_idx < plot_count) ? &all_plots[new_data_idx] : NULL);
-
-        lv_coord_t start_x = get_slot_x(3) + SLOT_SPACING;
-        lv_obj_set_x(new_right_slot->container, start_x);
-        lv_obj_set_y(new_right_slot->container, START_Y);
-        lv_obj_set_style_opa(new_right_slot->container, 255, 0);
-        lv_obj_clear_flag(new_right_slot->container, LV_OBJ_FLAG_HIDDEN);
-
-        /* Animate Current Slots Left */
-        for (int i = 0; i < 4; i++) {
-            lv_anim_t a;
-            lv_anim_init(&a);
-            lv_anim_set_var(&a, ui_slots[i]->container);
-            lv_anim_set_values(&a, get_slot_x(i), get_slot_x(i) - SLOT_SPACING);
-            lv_anim_set_exec_cb(&a, anim_x_cb);
-            lv_anim_set_time(&a, ANIM_TIME);
-            lv_anim_set_path_cb(&a, lv_anim_path_ease_out);
-            lv_anim_start(&a);
-
-            if (i == 0) { // Fade out first slot
-                lv_anim_t f;
-                lv_anim_init(&f);
-                lv_anim_set_var(&f, ui_slots[i]->container);
-                lv_anim_set_values(&f, 255, 0);
-                lv_anim_set_exec_cb(&f, anim_opa_cb);
-                lv_anim_set_time(&f, ANIM_TIME);
-                lv_anim_start(&f);
-            }
-        }
+static void anim_slide_cb(void* var, int32_t v) {
+    (void)var;
+    int32_t dir = (slide_dist > 0) ? 1 : -1;
+    slide_pos = v;
+    lv_obj_set_x(slide_img[0], -dir * v);
+    lv_obj_set_x(slide_img[1], dir * (slide_travel - v));
+}
 
-        // Animate new slot in
-        lv_anim_set_var(&a_cb, new_right_slot->container);
-        lv_anim_set_values(&a_cb, start_x, get_slot_x(3));
-        lv_anim_set_completed_cb(&a_cb, anim_ready_cb);
-        lv_anim_start(&a_cb);
-
-        // Fade new slot in
-        lv_obj_set_style_opa(new_right_slot->container, 255, 0);
-
-        spare_slot = ui_slots[0];
-        ui_slots[0] = ui_slots[1];
-        ui_slots[1] = ui_slots[2];
-        ui_slots[2] = ui_slots[3];
-        ui_slots[3] = new_right_slot;
-
-    }
-    else { // Moving LEFT
-        scroll_offset--;
-
-        slot_handles_t* new_left_slot = spare_slot;
-        int new_data_idx = scroll_offset;
-
-        fill_slot_with_data(new_left_slot, &all_plots[new_data_idx]);
-
-        lv_coord_t start_x = get_slot_x(0) - SLOT_SPACING;
-        lv_obj_set_x(new_left_slot->container, start_x);
-        lv_obj_set_y(new_left_slot->container, START_Y);
-        lv_obj_set_style_opa(new_left_slot->container, 255, 0);
-        lv_obj_clear_flag(new_left_slot->container, LV_OBJ_FLAG_HIDDEN);
-
-        /* Animate Current Slots Right */
-        for (int i = 0; i < 4; i++) {
-            lv_anim_t a;
-            lv_anim_init(&a);
-            lv_anim_set_var(&a, ui_slots[i]->container);
-            lv_anim_set_values(&a, get_slot_x(i), get_slot_x(i) + SLOT_SPACING);
-            lv_anim_set_exec_cb(&a, anim_x_cb);
-            lv_anim_set_time(&a, ANIM_TIME);
-            lv_anim_set_path_cb(&a, lv_anim_path_ease_out);
-            lv_anim_start(&a);
-
-            if (i == 3) { // Fade out last slot
-                lv_anim_t f;
-                lv_anim_init(&f);
-                lv_anim_set_var(&f, ui_slots[i]->container);
-                lv_anim_set_values(&f, 255, 0);
-                lv_anim_set_exec_cb(&f, anim_opa_cb);
-                lv_anim_set_time(&f, ANIM_TIME);
-                lv_anim_start(&f);
-            }
+/* Swap the live views back in. A slide cut short stops where it was. */
+static void slide_finish(bool completed) {
+    if (!carousel_frozen) return;
+    if (!completed) {
+        lv_anim_delete(carousel, anim_slide_cb);
+        if (slide_travel > 0) {
+            scroll_px = slide_from_px + (int32_t)((int64_t)slide_dist * slide_pos / slide_travel);
         }
+    }
+    carousel_frozen = false;
+    is_animating = false;
+    lv_obj_add_flag(slide_img[0], LV_OBJ_FLAG_HIDDEN);
+    lv_obj_add_flag(slide_img[1], LV_OBJ_FLAG_HIDDEN);
+    refresh_dashboard();
+}
+
+static void anim_slide_ready_cb(lv_anim_t* a) {
+    (void)a;
+    slide_finish(true);
+}
+
+static bool carousel_slide_to(int32_t target) {
+    int32_t from = scroll_px;
+    if (!take_viewport_snapshot(0)) return false;
+
+    scroll_px = target;
+    layout_carousel();
+    if (!take_viewport_snapshot(1)) {
+        scroll_px = from;
+        layout_carousel();
+        return false;
+    }
+
+    slide_from_px = from;
+    slide_dist = target - from;
+    slide_travel = LV_MIN(LV_ABS(slide_dist), CAROUSEL_WIDTH);
+    for (int i = 0; i < 2; i++) {
+        lv_image_set_src(slide_img[i], slide_buf[i]);
+        lv_obj_clear_flag(slide_img[i], LV_OBJ_FLAG_HIDDEN);
+    }
+    for (int v = 0; v < POOL_SLOTS; v++) {
+        lv_obj_add_flag(slots_storage[v].container, LV_OBJ_FLAG_HIDDEN);
+    }
+    carousel_frozen = true;
+    is_animating = true;
+    anim_slide_cb(NULL, 0);
+    refresh_dashboard(); /* arrows and scrubber already show the destination */
+
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, carousel);
+    lv_anim_set_values(&a, 0, slide_travel);
+    lv_anim_set_exec_cb(&a, anim_slide_cb);
+    lv_anim_set_time(&a, lv_anim_speed_clamped(SCROLL_SPEED, ANIM_TIME, 3 * ANIM_TIME));
+    lv_anim_set_path_cb(&a, lv_anim_path_ease_out);
+    lv_anim_set_completed_cb(&a, anim_slide_ready_cb);
+    lv_anim_start(&a);
+    return true;
+}
+
+/* Stop any running scroll, leaving the live views where it got to */
+static void carousel_stop(void) {
+    slide_finish(false);
+    lv_anim_delete(carousel, anim_scroll_cb);
+    is_animating = false;
+}
+
+static int32_t snap_to_slot(int32_t px) {
+    int32_t half = SLOT_SPACING / 2;
+    return ((px >= 0) ? (px + half) : (px - half)) / SLOT_SPACING * SLOT_SPACING;
+}
 
-        lv_anim_set_var(&a_cb, new_left_slot->container);
-        lv_anim_set_values(&a_cb, start_x, get_slot_x(0));
-        lv_anim_set_completed_cb(&a_cb, anim_ready_cb);
-        lv_anim_start(&a_cb);
+/* Scroll the carousel to a pixel position, clamped to the content. A running
+ * scroll is retargeted from wherever it currently is. */
+static void carousel_scroll_to(int32_t target, bool anim) {
+    int32_t max_scroll = carousel_max_scroll();
+    if (target > max_scroll) target = max_scroll;
+    if (target < 0) target = 0;
 
-        spare_slot = ui_slots[3];
-        ui_slots[3] = ui_slots[2];
-        ui_slots[2] = ui_slots[1];
-        ui_slots[1] = ui_slots[0];
-        ui_slots[0] = new_left_slot;
+    carousel_stop();
+    if (!anim || target == scroll_px) {
+        scroll_px = target;
+        refresh_dashboard();
+        return;
     }
+    if (carousel_slide_to(target)) return;
+
+    /* No memory for the snapshots: scroll the live views instead */
+    is_animating = true;
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, carousel);
+    lv_anim_set_values(&a, scroll_px, target);
+    lv_anim_set_exec_cb(&a, anim_scroll_cb);
+    lv_anim_set_time(&a, lv_anim_speed_clamped(SCROLL_SPEED, ANIM_TIME, 3 * ANIM_TIME));
+    lv_anim_set_path_cb(&a, lv_anim_path_ease_out);
+    lv_anim_set_completed_cb(&a, anim_ready_cb);
+    lv_anim_start(&a);
+}
+
+/* Bring a plot into view, as the first slot of its page where possible */
+static void carousel_show_page(int page, bool anim) {
+    carousel_scroll_to((int32_t)page * VISIBLE_SLOTS * SLOT_SPACING, anim);
+}
+
+/* Runs after the indev has delivered the release and any click with it */
+static void carousel_drag_end_cb(void* user_data) {
+    LV_UNUSED(user_data);
+    carousel_dragging = false;
+}
+
+/* Swipe handling. Slot containers bubble their press events up here; the
+ * threshold sliders do not, so editing a threshold never scrolls. */
+static void carousel_event_cb(lv_event_t* e) {
+    lv_event_code_t code = lv_event_get_code(e);
+    lv_indev_t* indev = lv_indev_active();
+    if (!indev) return;
+
+    lv_point_t p;
+    lv_indev_get_point(indev, &p);
+
+    if (code == LV_EVENT_PRESSED) {
+        /* Catch the carousel mid-flight */
+        carousel_stop();
+        carousel_dragging = false;
+        drag_start_point = p;
+        drag_start_px = scroll_px;
+        drag_velocity = 0;
+    }
+    else if (code == LV_EVENT_PRESSING) {
+        int32_t dx = drag_start_point.x - p.x;
+        if (!carousel_dragging && LV_ABS(dx) < DRAG_THRESHOLD) return;
+        carousel_dragging = true;
+
+        lv_point_t vect;
+        lv_indev_get_vect(indev, &vect);
+        drag_velocity = (drag_velocity - vect.x) / 2;
+
+        /* Follow the finger, with resistance past either end */
+        int32_t target = drag_start_px + dx;
+        int32_t max_scroll = carousel_max_scroll();
+        if (target < 0) target /= 3;
+        else if (target > max_scroll) target = max_scroll + (target - max_scroll) / 3;
+
+        scroll_px = target;
+        refresh_dashboard();
+    }
+    else if (code == LV_EVENT_RELEASED || code == LV_EVENT_PRESS_LOST) {
+        if (!carousel_dragging) return;
+        /* Kinetic release: throw along the last velocity, land on a slot */
+        carousel_scroll_to(snap_to_slot(scroll_px + drag_velocity * KINETIC_GAIN), true);
+        /* The click that ends the swipe comes after RELEASED; clear the flag
+         * once it has been swallowed, or the next tap on a threshold slider
+         * (which doesn't press the carousel) would be swallowed too */
+        lv_async_call(carousel_drag_end_cb, NULL);
+    }
+}
+
+static void scrubber_event_cb(lv_event_t* e) {
+    carousel_show_page(lv_slider_get_value(lv_event_get_target(e)), true);
 }
 
 static void scroll_left_btn_cb(lv_event_t* e) {
     if (lv_event_get_code(e) == LV_EVENT_CLICKED) {
-        if (is_animating) return;
-        if (scroll_offset > 0) animate_slide(-1);
+        carousel_scroll_to(snap_to_slot(scroll_px) - VISIBLE_SLOTS * SLOT_SPACING, true);
     }
 }
 
 static void scroll_right_btn_cb(lv_event_t* e) {
     if (lv_event_get_code(e) == LV_EVENT_CLICKED) {
-        if (is_animating) return;
-        if (scroll_offset + VISIBLE_SLOTS < plot_count) animate_slide(1);
+        carousel_scroll_to(snap_to_slot(scroll_px) + VISIBLE_SLOTS * SLOT_SPACING, true);
     }
 }
 
@@ -1230,15 +1175,21 @@ typedef struct {
 } last_recv_entry_t;
 static last_recv_entry_t last_recv[MAX_PLOTS];
 static int last_recv_count = 0;
+static uint32_t ingest_total = 0; /* readings accepted, for the HUD rate */
 
 /* Flash status UI support (updated asynchronously by flash.c) */
 static pthread_mutex_t flash_status_mutex = PTHREAD_MUTEX_INITIALIZER;
 static char flash_status_buf[256] = {0};
 static lv_obj_t* flash_status_label = NULL; /* created during UI init */
 
+/* Both run on demand: worker threads call event_loop_wakeup() after
+ * filling a mailbox and moisture_wakeup_cb() makes the timers ready. */
+static lv_timer_t* flash_timer = NULL;
+static lv_timer_t* apply_timer = NULL;
+
 static void flash_status_async_cb(lv_timer_t* timer) {
-    (void)timer;
-    /* Runs on LVGL thread */
+    /* Runs on LVGL thread, once per wakeup */
+    lv_timer_pause(timer);
     pthread_mutex_lock(&flash_status_mutex);
     if (!flash_status_label) {
         pthread_mutex_unlock(&flash_status_mutex);
@@ -1264,20 +1215,73 @@ void moisture_flash_status_update(const char *status) {
         flash_status_buf[0] = '\0';
     }
     pthread_mutex_unlock(&flash_status_mutex);
+    if (status && status[0]) moisture_flash_log(status);
     /* schedule update on LVGL thread */
-    /* Also write a small log so users can `tail -f /tmp/flash.log` to see progress */
-    if (status && status[0]) {
-        FILE *lf = fopen("/tmp/flash.log", "a");
-        if (lf) {
-            fprintf(lf, "%s\n", status);
-            fclose(lf);
+    /* Do not call lv_async_call here; wake the LVGL thread and let its
+     * flash timer pick flash_status_buf up. This avoids cross-thread
+     * LVGL calls which can be fragile in some builds. */
+    event_loop_wakeup();
+}
+
+void moisture_flash_log(const char *line) {
+    /* A small log so users can `tail -f /tmp/flash.log` to see progress */
+    FILE *lf = fopen("/tmp/flash.log", "a");
+    if (lf) {
+        fprintf(lf, "%s\n", line);
+        fclose(lf);
+    }
+    /* Echo to stderr as well for easy terminal visibility */
+    fprintf(stderr, "FLASH: %s\n", line);
+}
+
+/* Plots requested from other threads (the flash thread registers new
+ * sensors). moisture_add_plot_for_sensor() refreshes the dashboard, so only
+ * the LVGL thread may call it; other threads queue the MAC here and the
+ * apply timer adds the plots. */
+typedef struct {
+    char mac[32]; /* empty string = unassigned plot */
+} plot_request_t;
+static pthread_mutex_t plot_request_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* Grows as needed, so a whole tray registering at once never loses one */
+static plot_request_t *plot_requests = NULL;
+static int plot_request_count = 0;
+static int plot_request_cap = 0;
+
+void moisture_request_plot_for_sensor(const char *sensor_mac) {
+    bool queued = false;
+    pthread_mutex_lock(&plot_request_mutex);
+    if (plot_request_count == plot_request_cap) {
+        int cap = plot_request_cap ? plot_request_cap * 2 : 16;
+        plot_request_t *grown = realloc(plot_requests, sizeof(*grown) * (size_t)cap);
+        if (grown) {
+            plot_requests = grown;
+            plot_request_cap = cap;
         }
-        /* Echo to stderr as well for easy terminal visibility */
-        fprintf(stderr, "FLASH: %s\n", status);
     }
-    /* Do not call lv_async_call here; the UI polls flash_status_buf via
-     * a periodic timer created during UI init. This avoids cross-thread
-     * LVGL calls which can be fragile in some builds. */
+    if (plot_request_count < plot_request_cap) {
+        plot_request_t *req = &plot_requests[plot_request_count++];
+        snprintf(req->mac, sizeof(req->mac), "%s", sensor_mac ? sensor_mac : "");
+        queued = true;
+    }
+    pthread_mutex_unlock(&plot_request_mutex);
+    if (queued) event_loop_wakeup();
+    else moisture_flash_status_update("Out of memory for plot registrations");
+}
+
+/* Runs on the LVGL thread. Takes the whole queue, so the lock isn't held
+ * while the plots are added. */
+static void apply_plot_requests(void) {
+    pthread_mutex_lock(&plot_request_mutex);
+    plot_request_t *pending = plot_requests;
+    int n = plot_request_count;
+    plot_requests = NULL;
+    plot_request_count = plot_request_cap = 0;
+    pthread_mutex_unlock(&plot_request_mutex);
+
+    for (int i = 0; i < n; i++) {
+        moisture_add_plot_for_sensor(pending[i].mac[0] ? pending[i].mac : NULL);
+    }
+    free(pending);
 }
 
 /* Smoothing alpha for EMA. Default chosen to be responsive but smooth. */
@@ -1311,6 +1315,7 @@ void moisture_receive_sensor_values(const sensor_reading_t *readings, size_t cou
         int moisture = voltage_to_percent(voltage);
         float newf = (float)moisture;
         if (!sensor_mac || sensor_mac[0] == '\0') continue;
+        ingest_total++;
 
         /* Update existing entry */
         int found = 0;
@@ -1335,6 +1340,8 @@ void moisture_receive_sensor_values(const sensor_reading_t *readings, size_t cou
         }
     }
     pthread_mutex_unlock(&last_recv_mutex);
+    /* Apply now rather than on the next timer slice */
+    event_loop_wakeup();
 }
 
 /* Use the batch API `moisture_receive_sensor_values()`; no single-item
@@ -1344,6 +1351,10 @@ void moisture_receive_sensor_values(const sensor_reading_t *readings, size_t cou
 static void moisture_apply_received_timer_cb(lv_timer_t* timer) {
     (void)timer;
     int changed = 0;
+    uint32_t now = lv_tick_get();
+    if (now == 0) now = 1; /* 0 means "never" in plot_last_update */
+
+    apply_plot_requests();
     pthread_mutex_lock(&last_recv_mutex);
     for (int j = 0; j < last_recv_count; j++) {
         if (!last_recv[j].updated) continue;
@@ -1355,6 +1366,7 @@ static void moisture_apply_received_timer_cb(lv_timer_t* timer) {
         for (int i = 0; i < plot_count; i++) {
             if (strncmp(all_plots[i].sensor_mac, mac, sizeof(all_plots[i].sensor_mac)) == 0) {
                 all_plots[i].moisture = moist_display;
+                plot_last_update[i] = now;
                 found = 1;
                 break;
             }
@@ -1363,6 +1375,7 @@ static void moisture_apply_received_timer_cb(lv_timer_t* timer) {
             int idx = moisture_add_plot_for_sensor(mac);
             if (idx >= 0) {
                 all_plots[idx].moisture = moist_display;
+                plot_last_update[idx] = now;
             }
         }
         /* After updating moisture, decide whether to toggle D0 on the device. */
@@ -1390,87 +1403,254 @@ static void moisture_apply_received_timer_cb(lv_timer_t* timer) {
     }
     pthread_mutex_unlock(&last_recv_mutex);
 
-    if (changed && !is_animating) {
+    if (changed) {
         refresh_dashboard();
         save_plots_to_disk();
     }
+    /* Also catches tiles going stale without new data */
+    overview_sync();
+}
+
+/* Extra performance HUD lines: sensor readings per second and what is
+ * still queued for the LVGL thread (readings, plot registrations) and for
+ * the devices (commands awaiting retry). */
+static void moisture_hud_cb(char* buf, size_t size) {
+    static uint32_t last_total = 0;
+    static uint32_t last_tick = 0;
+
+    pthread_mutex_lock(&last_recv_mutex);
+    uint32_t total = ingest_total;
+    int queued = 0;
+    for (int i = 0; i < last_recv_count; i++) queued += last_recv[i].updated ? 1 : 0;
+    pthread_mutex_unlock(&last_recv_mutex);
+
+    pthread_mutex_lock(&plot_request_mutex);
+    int requests = plot_request_count;
+    pthread_mutex_unlock(&plot_request_mutex);
+
+    uint32_t elapsed = last_tick ? lv_tick_elaps(last_tick) : 0;
+    double rate = elapsed ? (total - last_total) * 1000.0 / elapsed : 0.0;
+    last_total = total;
+    last_tick = lv_tick_get();
+
+    snprintf(buf, size, "ingest %.1f/s  queue %d+%d  retry %d",
+             rate, queued, requests, pending_cmds_count);
+}
+
+static void title_event_cb(lv_event_t* e) {
+    (void)e;
+    frame_stats_hud_toggle();
+}
+
+/* Runs on the LVGL thread after a worker thread filled a mailbox */
+static void moisture_wakeup_cb(void* user_data) {
+    (void)user_data;
+    if (apply_timer) lv_timer_ready(apply_timer);
+    if (flash_timer) {
+        lv_timer_resume(flash_timer);
+        lv_timer_ready(flash_timer);
+    }
+}
+
+/* ---------------- Styles ---------------- */
+
+/* One shared theme for every slot and corner button. Objects only hold
+ * references to these, never local style values. */
+static lv_style_t style_carousel;
+static lv_style_t style_slot;
+static lv_style_t style_slot_delete;   /* SLOT_STATE_DELETE */
+static lv_style_t style_slot_rename;   /* SLOT_STATE_RENAME */
+static lv_style_t style_slot_label;
+static lv_style_t style_percent_edit;  /* SLOT_STATE_EDIT */
+static lv_style_t style_slider_hidden; /* main + indicator */
+static lv_style_t style_slider_knob;
+static lv_style_t style_btn;
+static lv_style_t style_btn_delete_on; /* LV_STATE_CHECKED */
+static lv_style_t style_btn_rename_on; /* LV_STATE_CHECKED */
+static bool styles_initialized = false;
+
+static void init_styles(void) {
+    if (styles_initialized) return;
+    styles_initialized = true;
+
+    lv_style_init(&style_carousel);
+    lv_style_set_bg_color(&style_carousel, lv_color_hex(0x212121));
+    lv_style_set_bg_opa(&style_carousel, LV_OPA_COVER);
+
+    lv_style_init(&style_slot);
+    lv_style_set_bg_color(&style_slot, lv_color_hex(0x2B2B2B));
+    lv_style_set_bg_opa(&style_slot, LV_OPA_COVER);
+    lv_style_set_radius(&style_slot, 16);
+    lv_style_set_border_width(&style_slot, 0);
+    lv_style_set_pad_all(&style_slot, 0);
+    lv_style_set_outline_width(&style_slot, 0);
+    lv_style_set_outline_pad(&style_slot, 0);
+    lv_style_set_text_color(&style_slot, lv_color_white());
+
+    lv_style_init(&style_slot_delete);
+    lv_style_set_outline_width(&style_slot_delete, 5);
+    lv_style_set_outline_color(&style_slot_delete, lv_color_hex(0xFF5555));
+    lv_style_set_bg_color(&style_slot_delete, lv_color_hex(0x442222));
+    lv_style_set_text_color(&style_slot_delete, lv_color_hex(0xFF9999));
+
+    lv_style_init(&style_slot_rename);
+    lv_style_set_outline_width(&style_slot_rename, 5);
+    lv_style_set_outline_color(&style_slot_rename, lv_color_hex(0x00FF00));
+    lv_style_set_bg_color(&style_slot_rename, lv_color_hex(0x224422));
+    lv_style_set_text_color(&style_slot_rename, lv_color_hex(0x99FF99));
+
+    /* No text color here: labels inherit it from the container's state */
+    lv_style_init(&style_slot_label);
+    lv_style_set_text_font(&style_slot_label, &lv_font_montserrat_20);
+
+    lv_style_init(&style_percent_edit);
+    lv_style_set_text_color(&style_percent_edit, lv_color_hex(0xFF5555));
+
+    lv_style_init(&style_slider_hidden);
+    lv_style_set_bg_opa(&style_slider_hidden, LV_OPA_TRANSP);
+
+    lv_style_init(&style_slider_knob);
+    lv_style_set_bg_color(&style_slider_knob, lv_color_white());
+    lv_style_set_bg_opa(&style_slider_knob, LV_OPA_COVER);
+    lv_style_set_radius(&style_slider_knob, 8);
+    lv_style_set_pad_all(&style_slider_knob, 0);
+    lv_style_set_min_height(&style_slider_knob, 20);
+    lv_style_set_min_width(&style_slider_knob, TRACK_WIDTH + 10);
+
+    lv_style_init(&style_btn);
+    lv_style_set_bg_color(&style_btn, lv_color_hex(0x2B2B2B));
+    lv_style_set_bg_opa(&style_btn, LV_OPA_COVER);
+    lv_style_set_radius(&style_btn, 12);
+    lv_style_set_text_color(&style_btn, lv_color_white());
+
+    lv_style_init(&style_btn_delete_on);
+    lv_style_set_bg_color(&style_btn_delete_on, lv_color_hex(0xFF5555));
+
+    lv_style_init(&style_btn_rename_on);
+    lv_style_set_bg_color(&style_btn_rename_on, lv_color_hex(0x00AA00));
+}
+
+/* ---------------- Overview ---------------- */
+
+static lv_obj_t* dashboard_scr = NULL;
+static lv_obj_t* overview_scr = NULL;  /* created on first use */
+static lv_obj_t* overview_grid = NULL;
+
+static void plot_tile_state(int idx, tile_grid_tile_t* tile) {
+    const plot_data_t* p = &all_plots[idx];
+    uint32_t seen = plot_last_update[idx];
+
+    memset(tile, 0, sizeof(*tile));
+    tile->fault = (seen == 0 || lv_tick_elaps(seen) > OVERVIEW_STALE_MS);
+    tile->level = (uint8_t)LV_CLAMP(0, p->moisture, 100);
+    tile->marker = (uint8_t)LV_CLAMP(0, p->threshold, 100);
+    if (p->moisture < p->threshold) {
+        tile->color = lv_color_hex(0xFF5555); /* dry: output on */
+    }
+    else if (p->moisture < p->threshold + OVERVIEW_NEAR_BAND) {
+        tile->color = lv_color_hex(0xFFCC00);
+    }
+    else {
+        tile->color = lv_color_hex(0x00CC66);
+    }
+}
+
+/* Push every plot's state to the grid; unchanged tiles cost a compare */
+static void overview_sync(void) {
+    if (!overview_grid || lv_screen_active() != overview_scr) return;
+    tile_grid_set_count(overview_grid, plot_count);
+    for (int i = 0; i < plot_count; i++) {
+        tile_grid_tile_t tile;
+        plot_tile_state(i, &tile);
+        tile_grid_set_tile(overview_grid, i, &tile);
+    }
+}
+
+static void overview_grid_click_cb(lv_event_t* e) {
+    lv_indev_t* indev = lv_indev_active();
+    if (!indev) return;
+
+    lv_point_t p;
+    lv_indev_get_point(indev, &p);
+    int32_t idx = tile_grid_hit_test(lv_event_get_target(e), &p);
+    if (idx < 0 || idx >= plot_count) return;
+
+    /* Open the dashboard on the page holding this plot */
+    lv_screen_load(dashboard_scr);
+    carousel_show_page(idx / VISIBLE_SLOTS, false);
+}
+
+static void overview_back_btn_cb(lv_event_t* e) {
+    if (lv_event_get_code(e) == LV_EVENT_CLICKED) lv_screen_load(dashboard_scr);
+}
+
+static void create_overview_screen(void) {
+    overview_scr = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(overview_scr, lv_color_hex(0x212121), 0);
+    lv_obj_set_style_bg_opa(overview_scr, LV_OPA_COVER, 0);
+    lv_obj_set_scroll_dir(overview_scr, LV_DIR_VER);
+
+    lv_obj_t* title = lv_label_create(overview_scr);
+    lv_label_set_text(title, "Overview");
+    lv_obj_set_style_text_font(title, &lv_font_montserrat_20, 0);
+    lv_obj_set_style_text_color(title, lv_color_hex(0xA6A6A6), 0);
+    lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 20);
+
+    btn_overview_back = lv_btn_create(overview_scr);
+    lv_obj_set_size(btn_overview_back, BUTTON_SIZE, BUTTON_SIZE);
+    lv_obj_align(btn_overview_back, LV_ALIGN_TOP_LEFT, BUTTON_MARGIN, BUTTON_MARGIN);
+    lv_obj_add_style(btn_overview_back, &style_btn, 0);
+    lv_obj_add_event_cb(btn_overview_back, overview_back_btn_cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_t* lbl_back = lv_label_create(btn_overview_back);
+    lv_label_set_text(lbl_back, LV_SYMBOL_LEFT);
+    lv_obj_center(lbl_back);
+
+    /* Every plot as one tile, all drawn by one object */
+    overview_grid = tile_grid_create(overview_scr, OVERVIEW_TILE_SIZE, OVERVIEW_TILE_SIZE, OVERVIEW_TILE_GAP);
+    lv_obj_set_pos(overview_grid, BUTTON_MARGIN, 2 * BUTTON_MARGIN + BUTTON_SIZE);
+    lv_obj_set_width(overview_grid, SCREEN_WIDTH - 2 * BUTTON_MARGIN);
+    lv_obj_add_event_cb(overview_grid, overview_grid_click_cb, LV_EVENT_CLICKED, NULL);
+}
+
+static void overview_button_event_cb(lv_event_t* e) {
+    if (lv_event_get_code(e) != LV_EVENT_CLICKED) return;
+    if (!overview_scr) create_overview_screen();
+    lv_screen_load(overview_scr);
+    overview_sync();
 }
 
 /* ---------------- UI Construction ---------------- */
 
 static void init_single_slot(slot_handles_t* h, lv_obj_t* parent, lv_coord_t x, lv_coord_t y) {
+    h->shown = false; /* first fill applies every property */
+    h->data_idx = -1;
     h->container = lv_obj_create(parent);
     lv_obj_set_pos(h->container, x, y);
     lv_obj_set_size(h->container, SLOT_WIDTH, SLOT_HEIGHT);
-    lv_obj_set_style_bg_color(h->container, lv_color_hex(0x2B2B2B), 0);
-    lv_obj_set_style_bg_opa(h->container, LV_OPA_COVER, 0);
-    lv_obj_set_style_radius(h->container, 16, 0);
-    lv_obj_set_style_border_width(h->container, 0, 0);
-    lv_obj_set_style_pad_all(h->container, 0, 0);
+    lv_obj_add_style(h->container, &style_slot, 0);
+    lv_obj_add_style(h->container, &style_slot_delete, SLOT_STATE_DELETE);
+    lv_obj_add_style(h->container, &style_slot_rename, SLOT_STATE_RENAME);
     lv_obj_remove_flag(h->container, LV_OBJ_FLAG_SCROLLABLE);
     lv_obj_add_flag(h->container, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_flag(h->container, LV_OBJ_FLAG_EVENT_BUBBLE); /* swipes reach the carousel */
     lv_obj_add_event_cb(h->container, slot_click_event_cb, LV_EVENT_CLICKED, NULL);
 
     /* Percent Label */
     h->label_percent = lv_label_create(h->container);
-    lv_obj_set_style_text_color(h->label_percent, lv_color_white(), 0);
-    lv_obj_set_style_text_font(h->label_percent, &lv_font_montserrat_20, 0); /* Use standard large if available */
+    lv_obj_add_style(h->label_percent, &style_slot_label, 0);
+    lv_obj_add_style(h->label_percent, &style_percent_edit, SLOT_STATE_EDIT);
     lv_obj_align(h->label_percent, LV_ALIGN_TOP_MID, 0, 20);
 
-    /* Track & Gradient */
-    lv_obj_t* track = lv_obj_create(h->container);
-
+    /* Track, gradient, level and threshold marker in one object */
     // Centering the track: (SLOT_WIDTH - TRACK_WIDTH) / 2
     lv_coord_t track_x = (SLOT_WIDTH - TRACK_WIDTH) / 2;
 
-    lv_obj_set_pos(track, track_x, TRACK_Y_OFFSET);
-    lv_obj_set_size(track, TRACK_WIDTH, TRACK_HEIGHT);
-    lv_obj_set_style_bg_color(track, lv_color_hex(0x353535), 0);
-    lv_obj_set_style_bg_opa(track, LV_OPA_COVER, 0);
-    lv_obj_set_style_radius(track, 8, 0);
-    lv_obj_set_style_border_width(track, 0, 0);
-    lv_obj_set_style_pad_all(track, 0, 0);
-    lv_obj_remove_flag(track, LV_OBJ_FLAG_SCROLLABLE);
-
-    lv_obj_t* grad_top = lv_obj_create(track);
-    lv_obj_remove_style_all(grad_top);
-    lv_obj_set_size(grad_top, TRACK_WIDTH, (TRACK_HEIGHT / 2) + 2);  // Overlap
-    lv_obj_set_align(grad_top, LV_ALIGN_TOP_MID);
-    lv_obj_set_style_radius(grad_top, 0, 0);      // ← FIXED: No radius
-    lv_obj_set_style_bg_grad(grad_top, &g_top, 0);
-    lv_obj_set_style_bg_opa(grad_top, LV_OPA_COVER, 0);
-
-    lv_obj_t* grad_btm = lv_obj_create(track);
-    lv_obj_remove_style_all(grad_btm);
-    lv_obj_set_size(grad_btm, TRACK_WIDTH, (TRACK_HEIGHT / 2) + 2);  // Overlap
-    lv_obj_set_align(grad_btm, LV_ALIGN_BOTTOM_MID);
-    lv_obj_set_style_radius(grad_btm, 0, 0);      // ← FIXED: No radius
-    lv_obj_set_style_bg_grad(grad_btm, &g_btm, 0);
-    lv_obj_set_style_bg_opa(grad_btm, LV_OPA_COVER, 0);
-
-
-    /* Cover (Grey overlay) */
-    h->cover = lv_obj_create(track);
-    lv_obj_set_width(h->cover, TRACK_WIDTH);
-    lv_obj_set_align(h->cover, LV_ALIGN_TOP_MID);
-    lv_obj_set_style_bg_color(h->cover, lv_color_hex(0x353535), 0);
-    lv_obj_set_style_bg_opa(h->cover, LV_OPA_COVER, 0);
-    lv_obj_set_style_border_width(h->cover, 0, 0);
-    lv_obj_set_style_radius(h->cover, 0, 0);
-    lv_obj_remove_flag(h->cover, LV_OBJ_FLAG_SCROLLABLE);
-
-    /* Threshold Line */
-    h->top_line = lv_obj_create(h->container);
-    lv_obj_set_size(h->top_line, TRACK_WIDTH + 10, 6); // Slightly wider and thicker
-    lv_obj_set_x(h->top_line, track_x - 5);
-    lv_obj_set_style_bg_color(h->top_line, lv_color_hex(0xFF0000), 0);
-    lv_obj_set_style_bg_opa(h->top_line, LV_OPA_COVER, 0);
-    lv_obj_set_style_border_width(h->top_line, 0, 0);
+    h->bar = moisture_bar_create(h->container, TRACK_WIDTH, TRACK_HEIGHT);
+    moisture_bar_set_track_pos(h->bar, track_x, TRACK_Y_OFFSET);
 
     /* Name Label */
     h->label_name = lv_label_create(h->container);
-    lv_obj_set_style_text_color(h->label_name, lv_color_white(), 0);
-    lv_obj_set_style_text_font(h->label_name, &lv_font_montserrat_20, 0);
+    lv_obj_add_style(h->label_name, &style_slot_label, 0);
     lv_obj_align(h->label_name, LV_ALIGN_BOTTOM_MID, 0, -25);
 
     /* Slider (Invisible Interaction) */
@@ -1478,36 +1658,96 @@ static void init_single_slot(slot_handles_t* h, lv_obj_t* parent, lv_coord_t x,
     lv_obj_set_size(h->slider, TRACK_WIDTH, TRACK_HEIGHT);
     lv_obj_set_pos(h->slider, track_x, TRACK_Y_OFFSET);
     lv_slider_set_range(h->slider, 0, 100);
-    lv_obj_set_style_bg_opa(h->slider, LV_OPA_TRANSP, LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(h->slider, LV_OPA_TRANSP, LV_PART_INDICATOR);
+    lv_obj_add_style(h->slider, &style_slider_hidden, LV_PART_MAIN);
+    lv_obj_add_style(h->slider, &style_slider_hidden, LV_PART_INDICATOR);
 
     /* Knob Styling (Visible only in edit mode) */
-    lv_obj_set_style_bg_color(h->slider, lv_color_white(), LV_PART_KNOB);
-    lv_obj_set_style_bg_opa(h->slider, LV_OPA_COVER, LV_PART_KNOB);
-    lv_obj_set_style_radius(h->slider, 8, LV_PART_KNOB);
-    lv_obj_set_style_pad_all(h->slider, 0, LV_PART_KNOB);
-    lv_obj_set_style_min_height(h->slider, 20, LV_PART_KNOB);
-    lv_obj_set_style_min_width(h->slider, TRACK_WIDTH + 10, LV_PART_KNOB);
+    lv_obj_add_style(h->slider, &style_slider_knob, LV_PART_KNOB);
 
     lv_obj_add_flag(h->slider, LV_OBJ_FLAG_HIDDEN);
     lv_obj_add_event_cb(h->slider, slider_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
     lv_obj_add_event_cb(h->slider, slot_click_event_cb, LV_EVENT_CLICKED, NULL);
 }
 
+void moisture_benchmark_track_redraw(uint32_t iterations) {
+    moisture_bar_benchmark(TRACK_WIDTH, TRACK_HEIGHT, iterations);
+}
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void moisture_benchmark_frame(uint32_t iterations) {
+    lv_display_t* disp = lv_display_get_default();
+    if (!disp) return;
+    if (iterations == 0) iterations = 1;
+
+    lv_lock();
+    lv_obj_t* scr = lv_screen_active();
+
+    /* The first frame also pays for layout; keep it out of the average */
+    lv_obj_invalidate(scr);
+    lv_refr_now(disp);
+
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < iterations; i++) {
+        lv_obj_invalidate(scr);
+        lv_refr_now(disp);
+    }
+    double frame_ms = (double)(bench_now_ns() - start) / 1e6 / (double)iterations;
+    lv_unlock();
+
+    fprintf(stdout, "dashboard %dx%d, %u full redraws, %d software draw unit(s)\n",
+            (int)lv_display_get_horizontal_resolution(disp),
+            (int)lv_display_get_vertical_resolution(disp),
+            (unsigned)iterations, LV_DRAW_SW_DRAW_UNIT_CNT);
+    fprintf(stdout, "  %8.2f ms/frame (%.1f fps)\n", frame_ms, 1000.0 / frame_ms);
+}
+
+lv_obj_t* moisture_get_object(moisture_obj_t which, int plot_idx) {
+    lv_obj_t* obj = NULL;
+    switch (which) {
+        case MOISTURE_OBJ_EDIT_BUTTON: obj = btn_edit; break;
+        case MOISTURE_OBJ_ADD_BUTTON: obj = btn_add; break;
+        case MOISTURE_OBJ_DELETE_BUTTON: obj = btn_del; break;
+        case MOISTURE_OBJ_RENAME_BUTTON: obj = btn_rename; break;
+        case MOISTURE_OBJ_LEFT_BUTTON: obj = btn_left; break;
+        case MOISTURE_OBJ_RIGHT_BUTTON: obj = btn_right; break;
+        case MOISTURE_OBJ_OVERVIEW_BUTTON: obj = btn_overview; break;
+        case MOISTURE_OBJ_OVERVIEW_BACK: obj = btn_overview_back; break;
+        case MOISTURE_OBJ_SLOT:
+        case MOISTURE_OBJ_SLIDER:
+            for (int i = 0; i < POOL_SLOTS; i++) {
+                if (slots_storage[i].data_idx != plot_idx) continue;
+                obj = (which == MOISTURE_OBJ_SLOT) ? slots_storage[i].container : slots_storage[i].slider;
+                break;
+            }
+            break;
+    }
+    if (!obj || lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN)) return NULL;
+    return obj;
+}
+
 void ui_moisture_dashboard_absolute(void) {
     lv_obj_t* scr = lv_screen_active();
+    dashboard_scr = scr;
+    init_styles();
     lv_obj_set_style_bg_color(scr, lv_color_hex(0x212121), 0);
     lv_obj_set_style_bg_opa(scr, LV_OPA_COVER, 0);
     lv_obj_clear_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
 
-    init_gradients();
-
     /* Title */
     lv_obj_t* title = lv_label_create(scr);
     lv_label_set_text(title, "Moisture Data");
     lv_obj_set_style_text_font(title, &lv_font_montserrat_20, 0); // Ideally use larger font
     lv_obj_set_style_text_color(title, lv_color_hex(0xA6A6A6), 0);
     lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 20);
+    /* Long-press the title for the performance HUD */
+    lv_obj_add_flag(title, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(title, title_event_cb, LV_EVENT_LONG_PRESSED, NULL);
+    frame_stats_hud_set_extra_cb(moisture_hud_cb);
 
     /* Flashing status label (updated asynchronously by flash module) */
     flash_status_label = lv_label_create(scr);
@@ -1518,34 +1758,49 @@ void ui_moisture_dashboard_absolute(void) {
     lv_obj_add_flag(flash_status_label, LV_OBJ_FLAG_HIDDEN);
     /* Ensure status label is above other elements so it's visible */
     lv_obj_move_foreground(flash_status_label);
-    /* Create a periodic LVGL timer to pull status updates from the
+    /* Create an LVGL timer to pull status updates from the
      * flash_status_buf written by the flash thread. Using a timer avoids
      * calling LVGL async helpers from arbitrary threads which may be
-     * unsupported in some deployments. */
-    lv_timer_t *flash_timer = lv_timer_create_basic();
+     * unsupported in some deployments. It stays paused until a wakeup. */
+    flash_timer = lv_timer_create_basic();
     if (flash_timer) {
         lv_timer_set_period(flash_timer, 200);
         lv_timer_set_cb(flash_timer, flash_status_async_cb);
+        lv_timer_pause(flash_timer);
     }
 
     /* Load from Disk OR Create Defaults */
     bool loaded = load_plots_from_disk();
 
-    /* Slots Init */
-    init_single_slot(&slots_storage[0], scr, get_slot_x(0), START_Y);
-    init_single_slot(&slots_storage[1], scr, get_slot_x(1), START_Y);
-    init_single_slot(&slots_storage[2], scr, get_slot_x(2), START_Y);
-    init_single_slot(&slots_storage[3], scr, get_slot_x(3), START_Y);
-
-    /* Spare Slot (offscreen) */
-    init_single_slot(&slots_storage[4], scr, -500, 0);
-    lv_obj_add_flag(slots_storage[4].container, LV_OBJ_FLAG_HIDDEN);
+    /* Carousel viewport: clips the slot views and receives swipes */
+    carousel = lv_obj_create(scr);
+    lv_obj_remove_style_all(carousel);
+    lv_obj_add_style(carousel, &style_carousel, 0); /* opaque, so snapshots match the screen */
+    lv_obj_set_pos(carousel, START_X - CAROUSEL_BLEED, START_Y - CAROUSEL_BLEED);
+    lv_obj_set_size(carousel, CAROUSEL_WIDTH, CAROUSEL_HEIGHT);
+    lv_obj_remove_flag(carousel, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(carousel, carousel_event_cb, LV_EVENT_PRESSED, NULL);
+    lv_obj_add_event_cb(carousel, carousel_event_cb, LV_EVENT_PRESSING, NULL);
+    lv_obj_add_event_cb(carousel, carousel_event_cb, LV_EVENT_RELEASED, NULL);
+    lv_obj_add_event_cb(carousel, carousel_event_cb, LV_EVENT_PRESS_LOST, NULL);
+
+    /* Slot view pool, bound to plots by layout_carousel() */
+    for (int i = 0; i < POOL_SLOTS; i++) {
+        init_single_slot(&slots_storage[i], carousel, 0, CAROUSEL_BLEED);
+        lv_obj_add_flag(slots_storage[i].container, LV_OBJ_FLAG_HIDDEN);
+    }
+    for (int i = 0; i < 2; i++) {
+        slide_img[i] = lv_image_create(carousel);
+        lv_obj_set_pos(slide_img[i], 0, 0);
+        lv_obj_add_flag(slide_img[i], LV_OBJ_FLAG_HIDDEN);
+    }
 
-    ui_slots[0] = &slots_storage[0];
-    ui_slots[1] = &slots_storage[1];
-    ui_slots[2] = &slots_storage[2];
-    ui_slots[3] = &slots_storage[3];
-    spare_slot = &slots_storage[4];
+    /* Page scrubber, level with the bottom corner buttons */
+    scrubber = lv_slider_create(scr);
+    lv_obj_set_size(scrubber, TOTAL_GROUP_WIDTH, SCRUBBER_HEIGHT);
+    lv_obj_align(scrubber, LV_ALIGN_BOTTOM_MID, 0, -(BUTTON_MARGIN + (BUTTON_SIZE - SCRUBBER_HEIGHT) / 2));
+    lv_obj_add_flag(scrubber, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_add_event_cb(scrubber, scrubber_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
 
     /* Scroll Buttons */
     int scroll_btn_y = (SCREEN_HEIGHT - 200) / 2;
@@ -1553,9 +1808,7 @@ void ui_moisture_dashboard_absolute(void) {
     btn_left = lv_btn_create(scr);
     lv_obj_set_pos(btn_left, 20, scroll_btn_y);
     lv_obj_set_size(btn_left, 80, 200);
-    lv_obj_set_style_bg_color(btn_left, lv_color_hex(0x2B2B2B), 0);
-    lv_obj_set_style_bg_opa(btn_left, LV_OPA_COVER, 0);
-    lv_obj_set_style_radius(btn_left, 12, 0);
+    lv_obj_add_style(btn_left, &style_btn, 0);
     lv_obj_add_flag(btn_left, LV_OBJ_FLAG_HIDDEN);
     lv_obj_add_event_cb(btn_left, scroll_left_btn_cb, LV_EVENT_CLICKED, NULL);
     lv_obj_t* lbl_left = lv_label_create(btn_left);
@@ -1565,9 +1818,7 @@ void ui_moisture_dashboard_absolute(void) {
     btn_right = lv_btn_create(scr);
     lv_obj_set_pos(btn_right, SCREEN_WIDTH - 100, scroll_btn_y);
     lv_obj_set_size(btn_right, 80, 200);
-    lv_obj_set_style_bg_color(btn_right, lv_color_hex(0x2B2B2B), 0);
-    lv_obj_set_style_bg_opa(btn_right, LV_OPA_COVER, 0);
-    lv_obj_set_style_radius(btn_right, 12, 0);
+    lv_obj_add_style(btn_right, &style_btn, 0);
     lv_obj_add_flag(btn_right, LV_OBJ_FLAG_HIDDEN);
     lv_obj_add_event_cb(btn_right, scroll_right_btn_cb, LV_EVENT_CLICKED, NULL);
     lv_obj_t* lbl_right = lv_label_create(btn_right);
@@ -1580,22 +1831,29 @@ void ui_moisture_dashboard_absolute(void) {
     btn_add = lv_btn_create(scr);
     lv_obj_set_size(btn_add, BUTTON_SIZE, BUTTON_SIZE);
     lv_obj_align(btn_add, LV_ALIGN_TOP_RIGHT, -BUTTON_MARGIN, BUTTON_MARGIN);
-    lv_obj_set_style_radius(btn_add, 12, 0);
-    lv_obj_set_style_bg_color(btn_add, lv_color_hex(0x2B2B2B), 0);
-    lv_obj_set_style_bg_opa(btn_add, LV_OPA_COVER, 0);
+    lv_obj_add_style(btn_add, &style_btn, 0);
     lv_obj_add_flag(btn_add, LV_OBJ_FLAG_HIDDEN);
     lv_obj_add_event_cb(btn_add, add_button_event_cb, LV_EVENT_ALL, NULL);
     lv_obj_t* lbl_plus = lv_label_create(btn_add);
     lv_label_set_text(lbl_plus, LV_SYMBOL_PLUS);
     lv_obj_center(lbl_plus);
 
+    /* OVERVIEW BUTTON (Top Right, left of Add) */
+    btn_overview = lv_btn_create(scr);
+    lv_obj_set_size(btn_overview, BUTTON_SIZE, BUTTON_SIZE);
+    lv_obj_align(btn_overview, LV_ALIGN_TOP_RIGHT, -(2 * BUTTON_MARGIN + BUTTON_SIZE), BUTTON_MARGIN);
+    lv_obj_add_style(btn_overview, &style_btn, 0);
+    lv_obj_add_event_cb(btn_overview, overview_button_event_cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_t* lbl_overview = lv_label_create(btn_overview);
+    lv_label_set_text(lbl_overview, LV_SYMBOL_LIST);
+    lv_obj_center(lbl_overview);
+
     /* DELETE BUTTON (Top Left) */
     btn_del = lv_btn_create(scr);
     lv_obj_set_size(btn_del, BUTTON_SIZE, BUTTON_SIZE);
     lv_obj_align(btn_del, LV_ALIGN_TOP_LEFT, BUTTON_MARGIN, BUTTON_MARGIN);
-    lv_obj_set_style_radius(btn_del, 12, 0);
-    lv_obj_set_style_bg_color(btn_del, lv_color_hex(0x2B2B2B), 0);
-    lv_obj_set_style_bg_opa(btn_del, LV_OPA_COVER, 0);
+    lv_obj_add_style(btn_del, &style_btn, 0);
+    lv_obj_add_style(btn_del, &style_btn_delete_on, LV_STATE_CHECKED);
     lv_obj_add_flag(btn_del, LV_OBJ_FLAG_HIDDEN);
     lv_obj_add_event_cb(btn_del, delete_button_event_cb, LV_EVENT_ALL, NULL);
     lv_obj_t* lbl_minus = lv_label_create(btn_del);
@@ -1606,9 +1864,8 @@ void ui_moisture_dashboard_absolute(void) {
     btn_rename = lv_btn_create(scr);
     lv_obj_set_size(btn_rename, BUTTON_SIZE, BUTTON_SIZE);
     lv_obj_align(btn_rename, LV_ALIGN_BOTTOM_LEFT, BUTTON_MARGIN, -BUTTON_MARGIN);
-    lv_obj_set_style_radius(btn_rename, 12, 0);
-    lv_obj_set_style_bg_color(btn_rename, lv_color_hex(0x2B2B2B), 0);
-    lv_obj_set_style_bg_opa(btn_rename, LV_OPA_COVER, 0);
+    lv_obj_add_style(btn_rename, &style_btn, 0);
+    lv_obj_add_style(btn_rename, &style_btn_rename_on, LV_STATE_CHECKED);
     lv_obj_add_flag(btn_rename, LV_OBJ_FLAG_HIDDEN);
     lv_obj_add_event_cb(btn_rename, rename_button_event_cb, LV_EVENT_ALL, NULL);
     lv_obj_t* lbl_kb = lv_label_create(btn_rename);
@@ -1619,9 +1876,7 @@ void ui_moisture_dashboard_absolute(void) {
     btn_edit = lv_btn_create(scr);
     lv_obj_set_size(btn_edit, BUTTON_SIZE, BUTTON_SIZE);
     lv_obj_align(btn_edit, LV_ALIGN_BOTTOM_RIGHT, -BUTTON_MARGIN, -BUTTON_MARGIN);
-    lv_obj_set_style_radius(btn_edit, 12, 0);
-    lv_obj_set_style_bg_color(btn_edit, lv_color_hex(0x2B2B2B), 0);
-    lv_obj_set_style_bg_opa(btn_edit, LV_OPA_COVER, 0);
+    lv_obj_add_style(btn_edit, &style_btn, 0);
     lv_obj_add_event_cb(btn_edit, edit_button_event_cb, LV_EVENT_ALL, NULL);
     btn_edit_label = lv_label_create(btn_edit);
     lv_label_set_text(btn_edit_label, LV_SYMBOL_EDIT);
@@ -1639,9 +1894,10 @@ void ui_moisture_dashboard_absolute(void) {
     refresh_dashboard();
     /* Create LVGL timer that applies last-received external values to the UI.
      * This replaces the old simulation timer so the UI is driven only by
-     * data from attached devices.
+     * data from attached devices. Arriving data wakes it immediately.
      */
-    lv_timer_create(moisture_apply_received_timer_cb, 200, NULL);
+    apply_timer = lv_timer_create(moisture_apply_received_timer_cb, APPLY_IDLE_PERIOD, NULL);
+    event_loop_add_wakeup_cb(moisture_wakeup_cb, NULL);
     /* Timer to retry pending commands (threshold pushes) to devices that
      * haven't been seen yet. Runs every 5 seconds. */
     lv_timer_create(moisture_retry_pending_timer_cb, 5000, NULL);
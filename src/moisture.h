@@ -14,10 +14,16 @@ void ui_moisture_dashboard_absolute(void);
 
 /* Add a new plot that is associated with `sensor_mac`. If `sensor_mac` is NULL
  * or empty a unique mac-like id will be assigned automatically. Returns the
- * plot index (0-based) or -1 on failure.
+ * plot index (0-based) or -1 on failure. LVGL thread only: it refreshes the
+ * dashboard.
  */
 int moisture_add_plot_for_sensor(const char *sensor_mac);
 
+/* Thread-safe variant for worker threads: queue `sensor_mac` (NULL for an
+ * unassigned plot) and let the LVGL thread add it on its next update tick.
+ */
+void moisture_request_plot_for_sensor(const char *sensor_mac);
+
 typedef struct {
 	char mac[32];
 	float moisture;
@@ -25,8 +31,8 @@ typedef struct {
 
 /* Called by the network/flash code when new sensor readings arrive.
  * This function accepts an array of readings and records the last-received
- * data points. It does NOT update the UI directly. LVGL runs a timer that
- * applies the last received values to the UI at regular intervals.
+ * data points. It does NOT update the UI directly: it wakes the LVGL run
+ * loop, whose timer applies the last received values to the UI.
  */
 void moisture_receive_sensor_values(const sensor_reading_t *readings, size_t count);
 
@@ -41,6 +47,43 @@ void moisture_set_smoothing_alpha(float alpha);
  */
 void moisture_flash_status_update(const char *status);
 
+/* Append a line to the flash log (/tmp/flash.log and stderr) without
+ * changing the status text. Safe to call from any thread.
+ */
+void moisture_flash_log(const char *line);
+
+/* Print the average redraw time of one dashboard moisture track with and
+ * without the cached gradient image. Requires an initialized display.
+ */
+void moisture_benchmark_track_redraw(uint32_t iterations);
+
+/* Print the average time of a full-screen redraw of the dashboard, with the
+ * number of software draw units the build uses. Requires the dashboard to
+ * be created on an initialized display.
+ */
+void moisture_benchmark_frame(uint32_t iterations);
+
+/* Objects the scripted benchmark (src/bench.c) presses through a virtual
+ * pointer, so scenarios go through the same event handlers as a finger.
+ */
+typedef enum {
+	MOISTURE_OBJ_EDIT_BUTTON,
+	MOISTURE_OBJ_ADD_BUTTON,
+	MOISTURE_OBJ_DELETE_BUTTON,
+	MOISTURE_OBJ_RENAME_BUTTON,
+	MOISTURE_OBJ_LEFT_BUTTON,
+	MOISTURE_OBJ_RIGHT_BUTTON,
+	MOISTURE_OBJ_OVERVIEW_BUTTON,
+	MOISTURE_OBJ_OVERVIEW_BACK,
+	MOISTURE_OBJ_SLOT,   /* the slot showing plot `plot_idx` */
+	MOISTURE_OBJ_SLIDER, /* its threshold slider, shown in edit mode */
+} moisture_obj_t;
+
+/* The object, or NULL if it is hidden or, for a slot, not on screen.
+ * `plot_idx` is only used by MOISTURE_OBJ_SLOT and MOISTURE_OBJ_SLIDER.
+ */
+lv_obj_t *moisture_get_object(moisture_obj_t which, int plot_idx);
+
 /* No single-item convenience wrapper: use the batch API `moisture_receive_sensor_values`.
  * The server should pass an array of `sensor_reading_t` and the number of
  * elements. This keeps ownership and batching explicit.
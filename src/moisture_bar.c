@@ -0,0 +1,364 @@
+/*
+ * moisture_bar.c
+ * Single-object moisture bar used by the dashboard slots. The track, the
+ * two gradient halves, the grey cover above the current level and the red
+ * threshold marker are all painted from one LV_EVENT_DRAW_MAIN callback, so
+ * a slot needs one object (and one style resolution) instead of five.
+ *
+ * Value and threshold changes invalidate only the rows that actually change:
+ * the band between the old and new fill level, and the old and new marker
+ * rectangles.
+ *
+ * The gradient itself is rasterized once into an RGB565 image shared by all
+ * bars of the same track size; redraws blit that image instead of
+ * interpolating the gradient again (LV_CACHE_DEF_SIZE is 0, so LVGL would
+ * not keep it for us).
+ */
+
+#include "src/moisture_bar.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ---------------- Config ---------------- */
+
+#define TRACK_COLOR 0x353535
+#define MARKER_COLOR 0xFF0000
+
+/* ---------------- Data ---------------- */
+
+typedef struct {
+    int32_t value;     /* fill level, percent */
+    int32_t threshold; /* marker position, percent */
+} moisture_bar_t;
+
+/* ---------------- Gradients ---------------- */
+
+static lv_grad_dsc_t g_top;
+static lv_grad_dsc_t g_btm;
+static bool grads_initialized = false;
+
+/* Pre-rendered track gradient (both halves), RGB565 */
+static lv_image_dsc_t grad_img;
+static uint16_t* grad_img_buf = NULL;
+static bool use_grad_cache = true;
+
+static void init_gradients(void) {
+    if (grads_initialized) return;
+
+    g_top.dir = LV_GRAD_DIR_VER;
+    g_top.stops_count = 2;
+    g_top.stops[0].color = lv_color_hex(0x00FF55);
+    g_top.stops[0].opa = LV_OPA_COVER;
+    g_top.stops[0].frac = 0;
+    g_top.stops[1].color = lv_color_hex(0xFFFF00);
+    g_top.stops[1].opa = LV_OPA_COVER;
+    g_top.stops[1].frac = 255;
+
+    g_btm.dir = LV_GRAD_DIR_VER;
+    g_btm.stops_count = 2;
+    g_btm.stops[0].color = lv_color_hex(0xFFFF00);
+    g_btm.stops[0].opa = LV_OPA_COVER;
+    g_btm.stops[0].frac = 0;
+    g_btm.stops[1].color = lv_color_hex(0xFF0000);
+    g_btm.stops[1].opa = LV_OPA_COVER;
+    g_btm.stops[1].frac = 255;
+
+    grads_initialized = true;
+}
+
+/* Colour of row `y` of a `h` rows high track, same ramp as g_top/g_btm */
+static lv_color_t gradient_color_at(int32_t y, int32_t h) {
+    int32_t mid = h / 2;
+    const lv_grad_dsc_t* g = (y < mid) ? &g_top : &g_btm;
+    int32_t pos = (y < mid) ? y : y - mid;
+    int32_t len = (y < mid) ? mid : h - mid;
+    int32_t mix = (len > 1) ? (pos * 255) / (len - 1) : 0;
+    /* lv_color_mix(c1, c2, mix) gives c1 at mix 255 and c2 at 0 */
+    return lv_color_mix(g->stops[1].color, g->stops[0].color, (uint8_t)mix);
+}
+
+/* Rasterize the gradient for a `w` x `h` track. Every bar uses the same track
+ * size, so a single image serves them all; bars of any other size fall back
+ * to drawing the gradient directly. */
+static void init_gradient_image(int32_t w, int32_t h) {
+    if (grad_img_buf) return;
+
+    grad_img_buf = lv_malloc((size_t)w * (size_t)h * sizeof(uint16_t));
+    if (!grad_img_buf) return;
+
+    for (int32_t y = 0; y < h; y++) {
+        uint16_t px = lv_color_to_u16(gradient_color_at(y, h));
+        uint16_t* row = grad_img_buf + (size_t)y * (size_t)w;
+        for (int32_t x = 0; x < w; x++) row[x] = px;
+    }
+
+    memset(&grad_img, 0, sizeof(grad_img));
+    grad_img.header.magic = LV_IMAGE_HEADER_MAGIC;
+    grad_img.header.cf = LV_COLOR_FORMAT_RGB565;
+    grad_img.header.w = w;
+    grad_img.header.h = h;
+    grad_img.header.stride = w * sizeof(uint16_t);
+    grad_img.data_size = (uint32_t)(w * h * sizeof(uint16_t));
+    grad_img.data = (const uint8_t*)grad_img_buf;
+}
+
+static bool gradient_image_fits(const lv_area_t* track) {
+    return grad_img_buf && use_grad_cache &&
+           (int32_t)grad_img.header.w == lv_area_get_width(track) &&
+           (int32_t)grad_img.header.h == lv_area_get_height(track);
+}
+
+/* ---------------- Geometry ---------------- */
+
+static int32_t clamp_percent(int32_t v) {
+    if (v < 0) return 0;
+    if (v > 100) return 100;
+    return v;
+}
+
+/* Area of the track inside an object covering `coords` */
+static void track_from_coords(const lv_area_t* coords, lv_area_t* track) {
+    *track = *coords;
+    track->x1 += MOISTURE_BAR_MARKER_OVERHANG;
+    track->x2 -= MOISTURE_BAR_MARKER_OVERHANG;
+    track->y1 += MOISTURE_BAR_MARKER_HEIGHT / 2;
+    track->y2 -= MOISTURE_BAR_MARKER_HEIGHT / 2;
+}
+
+/* First row of the filled (gradient) part of the track */
+static int32_t fill_top_y(const lv_area_t* track, int32_t value) {
+    int32_t track_h = lv_area_get_height(track);
+    return track->y1 + (track_h * (100 - value)) / 100;
+}
+
+/* Area covered by the threshold marker of an object covering `coords` */
+static void marker_from_coords(const lv_area_t* coords, int32_t threshold, lv_area_t* marker) {
+    lv_area_t track;
+    track_from_coords(coords, &track);
+    int32_t track_h = lv_area_get_height(&track);
+    int32_t px_from_bottom = (track_h * threshold) / 100;
+
+    *marker = *coords;
+    marker->y1 = track.y1 + track_h - px_from_bottom - MOISTURE_BAR_MARKER_HEIGHT / 2;
+    marker->y2 = marker->y1 + MOISTURE_BAR_MARKER_HEIGHT - 1;
+}
+
+/* ---------------- Drawing ---------------- */
+
+static void draw_clipped_rect(lv_layer_t* layer, lv_draw_rect_dsc_t* dsc,
+                              const lv_area_t* coords, const lv_area_t* clip) {
+    lv_area_t clip_area;
+    if (!lv_area_intersect(&clip_area, clip, &layer->_clip_area)) return;
+
+    const lv_area_t clip_area_ori = layer->_clip_area;
+    layer->_clip_area = clip_area;
+    lv_draw_rect(layer, dsc, coords);
+    layer->_clip_area = clip_area_ori;
+}
+
+static void draw_clipped_image(lv_layer_t* layer, lv_draw_image_dsc_t* dsc,
+                               const lv_area_t* coords, const lv_area_t* clip) {
+    lv_area_t clip_area;
+    if (!lv_area_intersect(&clip_area, clip, &layer->_clip_area)) return;
+
+    const lv_area_t clip_area_ori = layer->_clip_area;
+    layer->_clip_area = clip_area;
+    lv_draw_image(layer, dsc, coords);
+    layer->_clip_area = clip_area_ori;
+}
+
+/* Paint a bar whose object covers `coords` */
+static void moisture_bar_draw(lv_layer_t* layer, const lv_area_t* coords, const moisture_bar_t* bar) {
+    lv_area_t track;
+    track_from_coords(coords, &track);
+    int32_t track_h = lv_area_get_height(&track);
+    int32_t fill_y = fill_top_y(&track, bar->value);
+
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_opa = LV_OPA_COVER;
+    dsc.radius = 0;
+
+    /* Cover: track colour above the current level */
+    if (fill_y > track.y1) {
+        lv_area_t cover = track;
+        cover.y2 = fill_y - 1;
+        dsc.bg_color = lv_color_hex(TRACK_COLOR);
+        lv_draw_rect(layer, &dsc, &cover);
+    }
+
+    /* Gradient: drawn at full size so the colour ramp stays fixed to the
+     * track, clipped to the filled part */
+    if (fill_y <= track.y2) {
+        lv_area_t fill = track;
+        fill.y1 = fill_y;
+
+        if (gradient_image_fits(&track)) {
+            lv_draw_image_dsc_t img_dsc;
+            lv_draw_image_dsc_init(&img_dsc);
+            img_dsc.src = &grad_img;
+            draw_clipped_image(layer, &img_dsc, &track, &fill);
+        }
+        else {
+            int32_t mid_y = track.y1 + track_h / 2;
+            lv_area_t top_half = track;
+            top_half.y2 = mid_y - 1;
+            lv_area_t btm_half = track;
+            btm_half.y1 = mid_y;
+
+            dsc.bg_grad = g_top;
+            draw_clipped_rect(layer, &dsc, &top_half, &fill);
+            dsc.bg_grad = g_btm;
+            draw_clipped_rect(layer, &dsc, &btm_half, &fill);
+        }
+    }
+
+    /* Threshold marker */
+    lv_area_t marker;
+    marker_from_coords(coords, bar->threshold, &marker);
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_opa = LV_OPA_COVER;
+    dsc.bg_color = lv_color_hex(MARKER_COLOR);
+    dsc.radius = MOISTURE_BAR_MARKER_HEIGHT / 2;
+    lv_draw_rect(layer, &dsc, &marker);
+}
+
+static void moisture_bar_draw_cb(lv_event_t* e) {
+    lv_obj_t* obj = lv_event_get_current_target(e);
+    lv_layer_t* layer = lv_event_get_layer(e);
+    moisture_bar_t* bar = (moisture_bar_t*)lv_obj_get_user_data(obj);
+    if (!bar) return;
+
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    moisture_bar_draw(layer, &coords, bar);
+}
+
+static void moisture_bar_delete_cb(lv_event_t* e) {
+    lv_obj_t* obj = lv_event_get_current_target(e);
+    moisture_bar_t* bar = (moisture_bar_t*)lv_obj_get_user_data(obj);
+    lv_obj_set_user_data(obj, NULL);
+    lv_free(bar);
+}
+
+/* ---------------- Public API ---------------- */
+
+lv_obj_t* moisture_bar_create(lv_obj_t* parent, int32_t track_w, int32_t track_h) {
+    init_gradients();
+    init_gradient_image(track_w, track_h);
+
+    moisture_bar_t* bar = lv_malloc(sizeof(moisture_bar_t));
+    LV_ASSERT_NULL(bar);
+    if (!bar) return NULL;
+    bar->value = 0;
+    bar->threshold = 0;
+
+    lv_obj_t* obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_set_size(obj, track_w + 2 * MOISTURE_BAR_MARKER_OVERHANG,
+                    track_h + MOISTURE_BAR_MARKER_HEIGHT);
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_user_data(obj, bar);
+    lv_obj_add_event_cb(obj, moisture_bar_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+    lv_obj_add_event_cb(obj, moisture_bar_delete_cb, LV_EVENT_DELETE, NULL);
+    return obj;
+}
+
+void moisture_bar_set_track_pos(lv_obj_t* obj, int32_t x, int32_t y) {
+    lv_obj_set_pos(obj, x - MOISTURE_BAR_MARKER_OVERHANG, y - MOISTURE_BAR_MARKER_HEIGHT / 2);
+}
+
+void moisture_bar_set_value(lv_obj_t* obj, int32_t value) {
+    moisture_bar_t* bar = (moisture_bar_t*)lv_obj_get_user_data(obj);
+    if (!bar) return;
+    value = clamp_percent(value);
+    if (bar->value == value) return;
+
+    /* Only the rows between the old and the new level change colour */
+    lv_area_t coords, track;
+    lv_obj_get_coords(obj, &coords);
+    track_from_coords(&coords, &track);
+    int32_t old_y = fill_top_y(&track, bar->value);
+    int32_t new_y = fill_top_y(&track, value);
+
+    lv_area_t band = track;
+    band.y1 = LV_MIN(old_y, new_y);
+    band.y2 = LV_MAX(old_y, new_y) - 1;
+    bar->value = value;
+    if (band.y2 >= band.y1) lv_obj_invalidate_area(obj, &band);
+}
+
+void moisture_bar_set_threshold(lv_obj_t* obj, int32_t threshold) {
+    moisture_bar_t* bar = (moisture_bar_t*)lv_obj_get_user_data(obj);
+    if (!bar) return;
+    threshold = clamp_percent(threshold);
+    if (bar->threshold == threshold) return;
+
+    lv_area_t coords, old_marker, new_marker;
+    lv_obj_get_coords(obj, &coords);
+    marker_from_coords(&coords, bar->threshold, &old_marker);
+    marker_from_coords(&coords, threshold, &new_marker);
+    bar->threshold = threshold;
+    lv_obj_invalidate_area(obj, &old_marker);
+    lv_obj_invalidate_area(obj, &new_marker);
+}
+
+/* ---------------- Benchmark ---------------- */
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Average time of one full bar redraw into `canvas`, in microseconds */
+static double bench_redraw_us(lv_obj_t* canvas, const lv_area_t* coords, uint32_t iterations) {
+    moisture_bar_t bar = { .value = 0, .threshold = 40 };
+    uint64_t start = now_ns();
+    for (uint32_t i = 0; i < iterations; i++) {
+        /* Vary the level so every pass paints cover and gradient */
+        bar.value = (int32_t)(i % 101);
+        lv_layer_t layer;
+        lv_canvas_init_layer(canvas, &layer);
+        moisture_bar_draw(&layer, coords, &bar);
+        lv_canvas_finish_layer(canvas, &layer);
+    }
+    return (double)(now_ns() - start) / 1000.0 / (double)iterations;
+}
+
+void moisture_bar_benchmark(int32_t track_w, int32_t track_h, uint32_t iterations) {
+    if (iterations == 0) iterations = 1;
+    init_gradients();
+    init_gradient_image(track_w, track_h);
+
+    int32_t w = track_w + 2 * MOISTURE_BAR_MARKER_OVERHANG;
+    int32_t h = track_h + MOISTURE_BAR_MARKER_HEIGHT;
+    lv_draw_buf_t* buf = lv_draw_buf_create(w, h, LV_COLOR_FORMAT_RGB565, 0);
+    if (!buf) {
+        fprintf(stderr, "moisture_bar_benchmark: out of memory\n");
+        return;
+    }
+    lv_obj_t* canvas = lv_canvas_create(lv_screen_active());
+    lv_canvas_set_draw_buf(canvas, buf);
+    lv_obj_add_flag(canvas, LV_OBJ_FLAG_HIDDEN);
+
+    /* The canvas layer's coordinates start at 0;0 */
+    lv_area_t coords = { 0, 0, w - 1, h - 1 };
+
+    bool saved = use_grad_cache;
+    use_grad_cache = false;
+    double grad_us = bench_redraw_us(canvas, &coords, iterations);
+    use_grad_cache = true;
+    double cached_us = bench_redraw_us(canvas, &coords, iterations);
+    use_grad_cache = saved;
+
+    fprintf(stdout, "moisture bar %dx%d, %u redraws (software renderer)\n",
+            (int)track_w, (int)track_h, (unsigned)iterations);
+    fprintf(stdout, "  gradient interpolation: %8.1f us/redraw\n", grad_us);
+    fprintf(stdout, "  cached RGB565 image:    %8.1f us/redraw\n", cached_us);
+
+    lv_obj_delete(canvas);
+    lv_draw_buf_destroy(buf);
+}
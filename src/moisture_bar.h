@@ -0,0 +1,45 @@
+#pragma once
+/* moisture_bar.h */
+#ifndef MOISTURE_BAR_H
+#define MOISTURE_BAR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lvgl/lvgl.h"
+
+/* The threshold marker is wider and taller than the track it sits on; the
+ * widget reserves this much room around the track so the marker can be
+ * drawn without extending past the object's coordinates.
+ */
+#define MOISTURE_BAR_MARKER_OVERHANG 5
+#define MOISTURE_BAR_MARKER_HEIGHT 6
+
+/* Create a moisture bar: track, two-stop gradient fill, grey cover above the
+ * current level and the threshold marker, all drawn by a single object. The
+ * object is sized for a `track_w` x `track_h` track plus the marker margins;
+ * position it with `moisture_bar_set_track_pos()`.
+ */
+lv_obj_t* moisture_bar_create(lv_obj_t* parent, int32_t track_w, int32_t track_h);
+
+/* Place the bar so its track's top-left corner lands on (x, y) in the parent */
+void moisture_bar_set_track_pos(lv_obj_t* bar, int32_t x, int32_t y);
+
+/* Set the fill level / threshold marker in percent (clamped to 0..100).
+ * Only the band between the old and new position is invalidated.
+ */
+void moisture_bar_set_value(lv_obj_t* bar, int32_t value);
+void moisture_bar_set_threshold(lv_obj_t* bar, int32_t threshold);
+
+/* Time full redraws of a `track_w` x `track_h` bar on the software renderer,
+ * once with gradient interpolation and once with the cached gradient image,
+ * and print the average per redraw to stdout. Needs an initialized display.
+ */
+void moisture_bar_benchmark(int32_t track_w, int32_t track_h, uint32_t iterations);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* MOISTURE_BAR_H */
@@ -16,24 +16,21 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <sys/eventfd.h>
 
 static pthread_t server_thread;
 static int server_running = 0;
 
 /* ---- File-scope mapping & helpers ---- */
 static pthread_mutex_t maps_mutex = PTHREAD_MUTEX_INITIALIZER;
-/* Per-mac mapping + small ring buffer of recent debug lines */
+/* Per-mac mapping; each device also gets a small ring of recent debug lines */
 #define SERVER_MAP_MAX 32
 #define SERVER_LOG_LINES 64
-#define SERVER_LOG_LINE_LEN 128
 /* Live text buffer length per device (shows recent serial output). */
 #define SERVER_LIVE_BUFSZ 8192
 struct mac_ip_map_entry {
     char mac[32];
     struct sockaddr_in addr;
-    char logs[SERVER_LOG_LINES][SERVER_LOG_LINE_LEN];
-    int log_head; /* next write index */
-    int log_count; /* number of stored lines (<= SERVER_LOG_LINES) */
     /* live serial buffer (rolling tail) */
     char live_text[SERVER_LIVE_BUFSZ];
     size_t live_len;
@@ -41,6 +38,25 @@ struct mac_ip_map_entry {
 } maps[SERVER_MAP_MAX];
 static int maps_count = 0;
 
+/* Debug line rings, one per maps[] entry at the same index. They have their
+ * own lock so readers never wait for packet handling, only for the copy of
+ * a single line into a ring. */
+static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t log_cond = PTHREAD_COND_INITIALIZER;
+struct device_log {
+    char mac[32];
+    server_log_record_t ring[SERVER_LOG_LINES];
+    int head; /* next write index */
+    int count; /* number of stored lines (<= SERVER_LOG_LINES) */
+    uint64_t lines; /* lines ever received, the number the next line gets */
+};
+static struct device_log device_logs[SERVER_MAP_MAX];
+static int device_logs_count = 0;
+static uint64_t log_last_seq = 0;
+#define SERVER_LOG_NOTIFY_MAX 8
+static int log_notify_fds[SERVER_LOG_NOTIFY_MAX];
+static int log_notify_count = 0;
+
 /* Serial reader thread state */
 static pthread_t serial_thread;
 static int serial_running = 0;
@@ -59,20 +75,96 @@ static void append_live_text(struct mac_ip_map_entry *e, const char *line) {
     e->live_len = l;
 }
 
-/* Helper to add log line to entry index */
+/* Helper to add log line to entry index. Called with maps_mutex held. */
 static void add_log_to_entry(int idx, const char *line) {
-    if (idx < 0 || idx >= maps_count) return;
+    if (idx < 0 || idx >= SERVER_MAP_MAX) return;
     struct mac_ip_map_entry *e = &maps[idx];
     if (!line) return;
-    /* store timestamped line, truncated */
-    strncpy(e->logs[e->log_head], line, SERVER_LOG_LINE_LEN-1);
-    e->logs[e->log_head][SERVER_LOG_LINE_LEN-1] = '\0';
-    e->log_head = (e->log_head + 1) % SERVER_LOG_LINES;
-    if (e->log_count < SERVER_LOG_LINES) e->log_count++;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    pthread_mutex_lock(&log_mutex);
+    /* Rings follow maps[]; entries created without a line get theirs now */
+    while (device_logs_count <= idx) {
+        struct device_log *dl = &device_logs[device_logs_count];
+        memcpy(dl->mac, maps[device_logs_count].mac, sizeof(dl->mac));
+        dl->head = 0; dl->count = 0; dl->lines = 0;
+        device_logs_count++;
+    }
+    struct device_log *dl = &device_logs[idx];
+    server_log_record_t *r = &dl->ring[dl->head];
+    r->seq = ++log_last_seq;
+    r->line = dl->lines++;
+    r->time_ms = (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+    memcpy(r->mac, dl->mac, sizeof(r->mac));
+    /* store line, truncated */
+    strncpy(r->text, line, SERVER_LOG_LINE_LEN-1);
+    r->text[SERVER_LOG_LINE_LEN-1] = '\0';
+    dl->head = (dl->head + 1) % SERVER_LOG_LINES;
+    if (dl->count < SERVER_LOG_LINES) dl->count++;
+
+    pthread_cond_broadcast(&log_cond);
+    uint64_t one = 1;
+    for (int i = 0; i < log_notify_count; ++i) {
+        ssize_t wr = write(log_notify_fds[i], &one, sizeof(one));
+        (void)wr; /* a full counter already means "readable" */
+    }
+    pthread_mutex_unlock(&log_mutex);
+
     /* also append to live buffer (serial-style) */
     append_live_text(e, line);
 }
 
+/* Ring of `mac`, or NULL; NULL mac is never found. Call with log_mutex held. */
+static struct device_log *find_device_log(const char *mac) {
+    if (!mac) return NULL;
+    for (int i = 0; i < device_logs_count; ++i) {
+        if (strcasecmp(device_logs[i].mac, mac) == 0) return &device_logs[i];
+    }
+    return NULL;
+}
+
+/* Stored record `i` of a ring, 0 being the oldest */
+static const server_log_record_t *ring_record(const struct device_log *dl, int i) {
+    return &dl->ring[(dl->head - dl->count + i + 2 * SERVER_LOG_LINES) % SERVER_LOG_LINES];
+}
+
+/* Index of the oldest stored record of `dl` newer than `after` (count if none) */
+static int ring_find_after(const struct device_log *dl, uint64_t after) {
+    int lo = 0, hi = dl->count;
+    while (lo < hi) { /* records are in seq order */
+        int mid = (lo + hi) / 2;
+        if (ring_record(dl, mid)->seq <= after) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+/* Copy records newer than `after` into out, merging the rings in seq order
+ * when dl is NULL. Call with log_mutex held. */
+static int copy_records_after(const struct device_log *dl, uint64_t after,
+                              server_log_record_t *out, int max) {
+    if (dl) {
+        int i = ring_find_after(dl, after);
+        int n = 0;
+        for (; i < dl->count && n < max; ++i) out[n++] = *ring_record(dl, i);
+        return n;
+    }
+
+    int pos[SERVER_MAP_MAX];
+    for (int d = 0; d < device_logs_count; ++d) pos[d] = ring_find_after(&device_logs[d], after);
+    int n = 0;
+    while (n < max) {
+        int best = -1;
+        for (int d = 0; d < device_logs_count; ++d) {
+            if (pos[d] >= device_logs[d].count) continue;
+            if (best < 0 || ring_record(&device_logs[d], pos[d])->seq < ring_record(&device_logs[best], pos[best])->seq) best = d;
+        }
+        if (best < 0) break;
+        out[n++] = *ring_record(&device_logs[best], pos[best]++);
+    }
+    return n;
+}
+
 
 
 static void *server_thread_fn(void *arg) {
@@ -164,7 +256,7 @@ static void *server_thread_fn(void *arg) {
                             strncpy(maps[maps_count].mac, firsttok, sizeof(maps[maps_count].mac)-1);
                             maps[maps_count].mac[sizeof(maps[maps_count].mac)-1] = '\0';
                             maps[maps_count].addr = src;
-                            maps[maps_count].log_head = 0; maps[maps_count].log_count = 0; maps[maps_count].live_len = 0; maps[maps_count].live_text[0] = '\0';
+                            maps[maps_count].live_len = 0; maps[maps_count].live_text[0] = '\0';
                             add_log_to_entry(maps_count, buf);
                             maps[maps_count].last_output_state = -1;
                             maps_count++;
@@ -222,8 +314,6 @@ static void *server_thread_fn(void *arg) {
                     maps[maps_count].mac[sizeof(maps[maps_count].mac)-1] = '\0';
                     maps[maps_count].addr = src;
                     /* init log state */
-                    maps[maps_count].log_head = 0;
-                    maps[maps_count].log_count = 0;
                     maps[maps_count].live_len = 0;
                     maps[maps_count].live_text[0] = '\0';
                     maps[maps_count].last_output_state = -1;
@@ -253,8 +343,6 @@ static void *server_thread_fn(void *arg) {
                         strncpy(maps[maps_count].mac, mac, sizeof(maps[maps_count].mac)-1);
                         maps[maps_count].mac[sizeof(maps[maps_count].mac)-1] = '\0';
                         maps[maps_count].addr = src;
-                        maps[maps_count].log_head = 0;
-                        maps[maps_count].log_count = 0;
                         maps_count++;
                     }
                     pthread_mutex_unlock(&maps_mutex);
@@ -312,20 +400,23 @@ int server_send_text_to_mac(const char *mac, const char *text) {
 
 int server_get_logs_for_mac(const char *mac, char *outbuf, size_t outbuflen) {
     if (!mac || !outbuf || outbuflen == 0) return -1;
-    pthread_mutex_lock(&maps_mutex);
-    int idx = -1;
-    for (int i = 0; i < maps_count; ++i) {
-        if (strcasecmp(maps[i].mac, mac) == 0) { idx = i; break; }
+    pthread_mutex_lock(&log_mutex);
+    struct device_log *dl = find_device_log(mac);
+    if (!dl) {
+        pthread_mutex_unlock(&log_mutex);
+        /* a device that has sent no debug line yet has an empty log */
+        pthread_mutex_lock(&maps_mutex);
+        int known = 0;
+        for (int i = 0; i < maps_count; ++i) if (strcasecmp(maps[i].mac, mac) == 0) { known = 1; break; }
+        pthread_mutex_unlock(&maps_mutex);
+        if (!known) return -1;
+        outbuf[0] = '\0';
+        return 0;
     }
-    if (idx < 0) { pthread_mutex_unlock(&maps_mutex); return -1; }
-    struct mac_ip_map_entry *e = &maps[idx];
-    /* Start from oldest entry: head - count */
-    int start = (e->log_head - e->log_count + SERVER_LOG_LINES) % SERVER_LOG_LINES;
     size_t used = 0;
-    for (int i = 0; i < e->log_count; ++i) {
-        int p = (start + i) % SERVER_LOG_LINES;
-        const char *ln = e->logs[p];
-        if (!ln || ln[0] == '\0') continue;
+    for (int i = 0; i < dl->count; ++i) {
+        const char *ln = ring_record(dl, i)->text;
+        if (ln[0] == '\0') continue;
         size_t l = strlen(ln);
         if (used + l + 2 >= outbuflen) break; /* leave room for newline + null */
         memcpy(outbuf + used, ln, l);
@@ -333,7 +424,7 @@ int server_get_logs_for_mac(const char *mac, char *outbuf, size_t outbuflen) {
         outbuf[used++] = '\n';
     }
     if (used == 0) outbuf[0] = '\0'; else outbuf[used-1] = '\0'; /* replace last '\n' with NUL */
-    pthread_mutex_unlock(&maps_mutex);
+    pthread_mutex_unlock(&log_mutex);
     return (int)used;
 }
 
@@ -355,6 +446,98 @@ int server_get_live_text_for_mac(const char *mac, char *outbuf, size_t outbuflen
     return (int)tocopy;
 }
 
+int server_get_log_range_for_mac(const char *mac, uint64_t *first, uint64_t *next) {
+    if (!mac || !first || !next) return -1;
+    pthread_mutex_lock(&log_mutex);
+    struct device_log *dl = find_device_log(mac);
+    *next = dl ? dl->lines : 0;
+    *first = dl ? dl->lines - (uint64_t)dl->count : 0;
+    pthread_mutex_unlock(&log_mutex);
+    return dl ? 0 : -1;
+}
+
+int server_get_log_line_for_mac(const char *mac, uint64_t line, char *outbuf, size_t outbuflen) {
+    if (!mac || !outbuf || outbuflen == 0) return -1;
+    pthread_mutex_lock(&log_mutex);
+    struct device_log *dl = find_device_log(mac);
+    /* Only the last `count` lines are still in the ring */
+    if (!dl || line >= dl->lines || dl->lines - line > (uint64_t)dl->count) {
+        pthread_mutex_unlock(&log_mutex);
+        return -1;
+    }
+    const char *text = ring_record(dl, dl->count - (int)(dl->lines - line))->text;
+    size_t l = strlen(text);
+    if (l >= outbuflen) l = outbuflen - 1;
+    memcpy(outbuf, text, l);
+    outbuf[l] = '\0';
+    pthread_mutex_unlock(&log_mutex);
+    return (int)l;
+}
+
+int server_log_read(const char *mac, uint64_t after, server_log_record_t *out, int max) {
+    if (!out || max <= 0) return -1;
+    pthread_mutex_lock(&log_mutex);
+    struct device_log *dl = find_device_log(mac);
+    int n = (mac && !dl) ? -1 : copy_records_after(dl, after, out, max);
+    pthread_mutex_unlock(&log_mutex);
+    return n;
+}
+
+int server_log_wait(const char *mac, uint64_t after, server_log_record_t *out, int max, int timeout_ms) {
+    if (!out || max <= 0) return -1;
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) { deadline.tv_sec++; deadline.tv_nsec -= 1000000000L; }
+
+    pthread_mutex_lock(&log_mutex);
+    int n = 0;
+    for (;;) {
+        /* The device may not have a ring yet; keep waiting for its first line */
+        struct device_log *dl = find_device_log(mac);
+        if (!mac || dl) n = copy_records_after(dl, after, out, max);
+        if (n > 0 || timeout_ms == 0) break;
+        int rc = (timeout_ms < 0) ? pthread_cond_wait(&log_cond, &log_mutex)
+                                  : pthread_cond_timedwait(&log_cond, &log_mutex, &deadline);
+        if (rc == ETIMEDOUT) break;
+    }
+    pthread_mutex_unlock(&log_mutex);
+    return n;
+}
+
+uint64_t server_log_last_seq(void) {
+    pthread_mutex_lock(&log_mutex);
+    uint64_t seq = log_last_seq;
+    pthread_mutex_unlock(&log_mutex);
+    return seq;
+}
+
+int server_log_subscribe(void) {
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) return -1;
+    pthread_mutex_lock(&log_mutex);
+    if (log_notify_count >= SERVER_LOG_NOTIFY_MAX) {
+        pthread_mutex_unlock(&log_mutex);
+        close(fd);
+        return -1;
+    }
+    log_notify_fds[log_notify_count++] = fd;
+    pthread_mutex_unlock(&log_mutex);
+    return fd;
+}
+
+void server_log_unsubscribe(int fd) {
+    pthread_mutex_lock(&log_mutex);
+    for (int i = 0; i < log_notify_count; ++i) {
+        if (log_notify_fds[i] != fd) continue;
+        log_notify_fds[i] = log_notify_fds[--log_notify_count];
+        close(fd);
+        break;
+    }
+    pthread_mutex_unlock(&log_mutex);
+}
+
 int server_get_output_state_for_mac(const char *mac) {
     if (!mac) return -1;
     pthread_mutex_lock(&maps_mutex);
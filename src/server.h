@@ -1,5 +1,6 @@
 #pragma once
 #include <stddef.h>
+#include <stdint.h>
 #ifndef SERVER_H
 #define SERVER_H
 
@@ -24,6 +25,21 @@ int server_send_cmd_to_mac(const char *mac, int activate);
  */
 int server_send_text_to_mac(const char *mac, const char *text);
 
+/* Longest debug line kept, including the NUL */
+#define SERVER_LOG_LINE_LEN 128
+
+/* One debug line. `seq` increases by one for every line the server
+ * receives, from any device, starting at 1; `line` counts the lines of
+ * this device only, starting at 0.
+ */
+typedef struct {
+    uint64_t seq;
+    uint64_t line;
+    int64_t time_ms; /* arrival, CLOCK_REALTIME */
+    char mac[32];
+    char text[SERVER_LOG_LINE_LEN];
+} server_log_record_t;
+
 /* Retrieve recent debug/UDP lines received from device `mac`.
  * `outbuf` is filled with newline-separated lines (up to `outbuflen-1`).
  * Returns number of bytes written or -1 if mac not found.
@@ -33,6 +49,39 @@ int server_get_logs_for_mac(const char *mac, char *outbuf, size_t outbuflen);
  * Returns number of bytes written or -1 if mac not found.
  */
 int server_get_live_text_for_mac(const char *mac, char *outbuf, size_t outbuflen);
+/* Line numbers (server_log_record_t.line) of `mac` still held: `*first`
+ * gets the oldest and `*next` the number the next line will get. Returns 0,
+ * or -1 if the device has sent no debug line yet.
+ */
+int server_get_log_range_for_mac(const char *mac, uint64_t *first, uint64_t *next);
+/* Copy the text of line number `line` from `mac` into `outbuf`. Returns
+ * number of bytes written, or -1 if the line is not held (anymore).
+ */
+int server_get_log_line_for_mac(const char *mac, uint64_t line, char *outbuf, size_t outbuflen);
+
+/* Copy up to `max` records with a sequence number greater than `after`
+ * into `out`, oldest first: from device `mac`, or from all devices if
+ * `mac` is NULL. Pass the last seq you got as `after` to read only what is
+ * new. With `mac` NULL, out[0].seq > after + 1 means records were dropped
+ * from the rings in between. seq is server-wide, so with a `mac` the other
+ * devices' records leave gaps anyway: compare the per-device `line` numbers
+ * instead (out[0].line > last line + 1, or server_get_log_range_for_mac()).
+ * Returns the number of records, or -1 if `mac` has sent no debug line yet.
+ * Readers only hold the log lock for the copy.
+ */
+int server_log_read(const char *mac, uint64_t after, server_log_record_t *out, int max);
+/* Like server_log_read(), but wait up to `timeout_ms` (-1 forever) for a
+ * record newer than `after`. Returns 0 on timeout.
+ */
+int server_log_wait(const char *mac, uint64_t after, server_log_record_t *out, int max, int timeout_ms);
+/* Sequence number of the newest record, 0 if none */
+uint64_t server_log_last_seq(void);
+/* A non-blocking eventfd that becomes readable whenever a record is added,
+ * for poll()/epoll based readers: read it to reset, then server_log_read().
+ * Returns -1 on error or when too many are open.
+ */
+int server_log_subscribe(void);
+void server_log_unsubscribe(int fd);
 /* Return last-known D0 output state for a device: 1=HIGH, 0=LOW, -1=unknown */
 int server_get_output_state_for_mac(const char *mac);
 
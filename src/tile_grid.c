@@ -0,0 +1,237 @@
+/*
+ * tile_grid.c
+ * Dense overview grid: one small tile per plot, all painted from a single
+ * LV_EVENT_DRAW_MAIN callback. Hundreds of tiles cost one object, and a
+ * redraw only visits the rows and columns that intersect the clip area.
+ *
+ * Tiles remember what they show; setting an unchanged tile is a no-op and a
+ * changed tile invalidates only its own rectangle.
+ */
+
+#include "src/tile_grid.h"
+#include <string.h>
+
+/* ---------------- Config ---------------- */
+
+#define TILE_BG_COLOR 0x2B2B2B
+#define TILE_FAULT_COLOR 0x3A3A3A
+#define TILE_FAULT_BORDER 0xFF5555
+#define TILE_MARKER_COLOR 0xFFFFFF
+#define TILE_RADIUS 6
+#define TILE_INSET 3 /* level bar inset from the tile edge */
+
+/* ---------------- Data ---------------- */
+
+typedef struct {
+    int32_t tile_w;
+    int32_t tile_h;
+    int32_t gap;
+    uint32_t count;
+    tile_grid_tile_t* tiles;
+} tile_grid_t;
+
+static const tile_grid_tile_t fault_tile = { .fault = true };
+
+/* ---------------- Geometry ---------------- */
+
+static int32_t grid_cols(lv_obj_t* obj, const tile_grid_t* grid) {
+    int32_t cols = (lv_obj_get_width(obj) + grid->gap) / (grid->tile_w + grid->gap);
+    return (cols > 0) ? cols : 1;
+}
+
+static int32_t grid_content_height(const tile_grid_t* grid, int32_t cols) {
+    if (grid->count == 0) return 0;
+    int32_t rows = ((int32_t)grid->count + cols - 1) / cols;
+    return rows * (grid->tile_h + grid->gap) - grid->gap;
+}
+
+/* Absolute area of tile `idx` in an object covering `coords` */
+static void tile_area(const lv_area_t* coords, const tile_grid_t* grid, int32_t cols,
+                      uint32_t idx, lv_area_t* area) {
+    int32_t col = (int32_t)idx % cols;
+    int32_t row = (int32_t)idx / cols;
+    area->x1 = coords->x1 + col * (grid->tile_w + grid->gap);
+    area->y1 = coords->y1 + row * (grid->tile_h + grid->gap);
+    area->x2 = area->x1 + grid->tile_w - 1;
+    area->y2 = area->y1 + grid->tile_h - 1;
+}
+
+static bool tile_equal(const tile_grid_tile_t* a, const tile_grid_tile_t* b) {
+    if (a->fault != b->fault) return false;
+    if (a->fault) return true; /* nothing else is drawn for a faulted tile */
+    return lv_color_eq(a->color, b->color) && a->level == b->level && a->marker == b->marker;
+}
+
+/* ---------------- Drawing ---------------- */
+
+static void tile_draw(lv_layer_t* layer, const lv_area_t* area, const tile_grid_tile_t* tile) {
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_opa = LV_OPA_COVER;
+    dsc.radius = TILE_RADIUS;
+
+    if (tile->fault) {
+        dsc.bg_color = lv_color_hex(TILE_FAULT_COLOR);
+        dsc.border_color = lv_color_hex(TILE_FAULT_BORDER);
+        dsc.border_width = 2;
+        dsc.border_opa = LV_OPA_COVER;
+        lv_draw_rect(layer, &dsc, area);
+        return;
+    }
+
+    dsc.bg_color = lv_color_hex(TILE_BG_COLOR);
+    lv_draw_rect(layer, &dsc, area);
+
+    lv_area_t inner = *area;
+    inner.x1 += TILE_INSET;
+    inner.x2 -= TILE_INSET;
+    inner.y1 += TILE_INSET;
+    inner.y2 -= TILE_INSET;
+    int32_t inner_h = lv_area_get_height(&inner);
+
+    /* Level, in the status colour */
+    int32_t level_h = (inner_h * LV_MIN(tile->level, 100)) / 100;
+    if (level_h > 0) {
+        lv_area_t level = inner;
+        level.y1 = inner.y2 - level_h + 1;
+        dsc.bg_color = tile->color;
+        dsc.radius = TILE_RADIUS / 2;
+        lv_draw_rect(layer, &dsc, &level);
+    }
+
+    /* Threshold tick */
+    lv_area_t marker = *area;
+    marker.y1 = inner.y2 - (inner_h * LV_MIN(tile->marker, 100)) / 100;
+    marker.y2 = marker.y1 + 1;
+    dsc.bg_color = lv_color_hex(TILE_MARKER_COLOR);
+    dsc.bg_opa = LV_OPA_80;
+    dsc.radius = 0;
+    lv_draw_rect(layer, &dsc, &marker);
+}
+
+static void tile_grid_draw_cb(lv_event_t* e) {
+    lv_obj_t* obj = lv_event_get_current_target(e);
+    lv_layer_t* layer = lv_event_get_layer(e);
+    tile_grid_t* grid = (tile_grid_t*)lv_obj_get_user_data(obj);
+    if (!grid || grid->count == 0) return;
+
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    int32_t cols = grid_cols(obj, grid);
+    int32_t pitch_x = grid->tile_w + grid->gap;
+    int32_t pitch_y = grid->tile_h + grid->gap;
+
+    /* Visit only the tiles that intersect the area being redrawn */
+    const lv_area_t* clip = &layer->_clip_area;
+    int32_t col_first = LV_MAX(0, (clip->x1 - coords.x1) / pitch_x);
+    int32_t col_last = LV_MIN(cols - 1, (clip->x2 - coords.x1) / pitch_x);
+    int32_t row_first = LV_MAX(0, (clip->y1 - coords.y1) / pitch_y);
+    int32_t row_last = (clip->y2 - coords.y1) / pitch_y;
+
+    for (int32_t row = row_first; row <= row_last; row++) {
+        for (int32_t col = col_first; col <= col_last; col++) {
+            uint32_t idx = (uint32_t)(row * cols + col);
+            if (idx >= grid->count) return;
+            lv_area_t area;
+            tile_area(&coords, grid, cols, idx, &area);
+            tile_draw(layer, &area, &grid->tiles[idx]);
+        }
+    }
+}
+
+static void tile_grid_size_cb(lv_event_t* e) {
+    lv_obj_t* obj = lv_event_get_current_target(e);
+    tile_grid_t* grid = (tile_grid_t*)lv_obj_get_user_data(obj);
+    if (!grid) return;
+    /* A new width may change the column count and so the height */
+    lv_obj_set_height(obj, grid_content_height(grid, grid_cols(obj, grid)));
+}
+
+static void tile_grid_delete_cb(lv_event_t* e) {
+    lv_obj_t* obj = lv_event_get_current_target(e);
+    tile_grid_t* grid = (tile_grid_t*)lv_obj_get_user_data(obj);
+    lv_obj_set_user_data(obj, NULL);
+    if (!grid) return;
+    lv_free(grid->tiles);
+    lv_free(grid);
+}
+
+/* ---------------- Public API ---------------- */
+
+lv_obj_t* tile_grid_create(lv_obj_t* parent, int32_t tile_w, int32_t tile_h, int32_t gap) {
+    tile_grid_t* grid = lv_malloc(sizeof(tile_grid_t));
+    LV_ASSERT_NULL(grid);
+    if (!grid) return NULL;
+    memset(grid, 0, sizeof(*grid));
+    grid->tile_w = tile_w;
+    grid->tile_h = tile_h;
+    grid->gap = gap;
+
+    lv_obj_t* obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_set_height(obj, 0);
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_user_data(obj, grid);
+    lv_obj_add_event_cb(obj, tile_grid_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+    lv_obj_add_event_cb(obj, tile_grid_size_cb, LV_EVENT_SIZE_CHANGED, NULL);
+    lv_obj_add_event_cb(obj, tile_grid_delete_cb, LV_EVENT_DELETE, NULL);
+    return obj;
+}
+
+void tile_grid_set_count(lv_obj_t* obj, uint32_t count) {
+    tile_grid_t* grid = (tile_grid_t*)lv_obj_get_user_data(obj);
+    if (!grid || grid->count == count) return;
+
+    if (count > grid->count) {
+        tile_grid_tile_t* tiles = lv_realloc(grid->tiles, count * sizeof(tile_grid_tile_t));
+        if (!tiles) return;
+        for (uint32_t i = grid->count; i < count; i++) tiles[i] = fault_tile;
+        grid->tiles = tiles;
+    }
+
+    /* Tiles appear or disappear at the end; everything from the first
+     * affected tile down may change, the rows above do not */
+    lv_area_t coords, first;
+    lv_obj_get_coords(obj, &coords);
+    int32_t cols = grid_cols(obj, grid);
+    tile_area(&coords, grid, cols, LV_MIN(grid->count, count), &first);
+    grid->count = count;
+
+    lv_obj_set_height(obj, grid_content_height(grid, cols));
+    lv_obj_get_coords(obj, &coords);
+    coords.y1 = first.y1;
+    if (coords.y2 >= coords.y1) lv_obj_invalidate_area(obj, &coords);
+}
+
+void tile_grid_set_tile(lv_obj_t* obj, uint32_t idx, const tile_grid_tile_t* tile) {
+    tile_grid_t* grid = (tile_grid_t*)lv_obj_get_user_data(obj);
+    if (!grid || !tile || idx >= grid->count) return;
+    if (tile_equal(&grid->tiles[idx], tile)) return;
+    grid->tiles[idx] = *tile;
+
+    lv_area_t coords, area;
+    lv_obj_get_coords(obj, &coords);
+    tile_area(&coords, grid, grid_cols(obj, grid), idx, &area);
+    lv_obj_invalidate_area(obj, &area);
+}
+
+int32_t tile_grid_hit_test(lv_obj_t* obj, const lv_point_t* p) {
+    tile_grid_t* grid = (tile_grid_t*)lv_obj_get_user_data(obj);
+    if (!grid || !p) return -1;
+
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    int32_t x = p->x - coords.x1;
+    int32_t y = p->y - coords.y1;
+    if (x < 0 || y < 0) return -1;
+
+    int32_t cols = grid_cols(obj, grid);
+    int32_t col = x / (grid->tile_w + grid->gap);
+    int32_t row = y / (grid->tile_h + grid->gap);
+    /* Taps in the gaps belong to no tile */
+    if (col >= cols || x % (grid->tile_w + grid->gap) >= grid->tile_w) return -1;
+    if (y % (grid->tile_h + grid->gap) >= grid->tile_h) return -1;
+
+    int32_t idx = row * cols + col;
+    return (idx < (int32_t)grid->count) ? idx : -1;
+}
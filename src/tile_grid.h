@@ -0,0 +1,42 @@
+#pragma once
+/* tile_grid.h */
+#ifndef TILE_GRID_H
+#define TILE_GRID_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lvgl/lvgl.h"
+
+/* What one tile shows. `color` is the status colour, `level` fills the tile
+ * from the bottom and `marker` draws a tick at that height (both percent).
+ * A faulted tile is drawn greyed out with a red border and no level.
+ */
+typedef struct {
+    lv_color_t color;
+    uint8_t level;
+    uint8_t marker;
+    bool fault;
+} tile_grid_tile_t;
+
+/* Create a grid of `tile_w` x `tile_h` tiles separated by `gap` pixels, all
+ * painted by a single object. Set the object's width; the column count
+ * follows from it and the height follows from the tile count.
+ */
+lv_obj_t* tile_grid_create(lv_obj_t* parent, int32_t tile_w, int32_t tile_h, int32_t gap);
+
+/* Resize the grid to `count` tiles. New tiles start out faulted. */
+void tile_grid_set_count(lv_obj_t* grid, uint32_t count);
+
+/* Update tile `idx`. Only that tile is invalidated, and only if it changed. */
+void tile_grid_set_tile(lv_obj_t* grid, uint32_t idx, const tile_grid_tile_t* tile);
+
+/* Index of the tile under the absolute point `p`, or -1 if none */
+int32_t tile_grid_hit_test(lv_obj_t* grid, const lv_point_t* p);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* TILE_GRID_H */
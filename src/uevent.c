@@ -0,0 +1,161 @@
+/*
+ * uevent.c
+ * Hotplug monitor for USB serial nodes. The kernel broadcasts a uevent on
+ * a NETLINK_KOBJECT_UEVENT socket for every device it adds or removes; we
+ * keep the tty ones for ttyACM* / ttyUSB* and look up the USB device above
+ * the node in sysfs (idVendor, idProduct, serial). The kernel group is used
+ * rather than udev's, so there is no libudev dependency; the /dev node is
+ * created by devtmpfs before the event is sent.
+ */
+
+#include "uevent.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+
+#define UEVENT_BUF 2048 /* the kernel's UEVENT_BUFFER_SIZE */
+#define UEVENT_RCVBUF (4 * 1024 * 1024) /* a tray of boards resetting at once */
+#define SYSFS_PATH_LEN 512
+
+static int is_usb_tty(const char *name)
+{
+    return strncmp(name, "ttyACM", 6) == 0 || strncmp(name, "ttyUSB", 6) == 0;
+}
+
+static void read_attr(const char *dir, const char *attr, char *out, size_t out_len)
+{
+    char path[SYSFS_PATH_LEN + 32]; snprintf(path, sizeof(path), "%s/%s", dir, attr);
+    out[0] = '\0';
+    FILE *f = fopen(path, "r"); if (!f) return;
+    if (fgets(out, (int)out_len, f)) out[strcspn(out, "\r\n")] = '\0';
+    fclose(f);
+}
+
+/* Walk up from the node's sysfs directory to the USB device (the first
+ * ancestor with an idVendor attribute) and copy its attributes. */
+static int fill_usb_attrs(const char *sysdir, uevent_tty_t *ev)
+{
+    char dir[SYSFS_PATH_LEN];
+    char *real = realpath(sysdir, NULL);
+    if (!real) return -1;
+    int fits = strlen(real) < sizeof(dir);
+    if (fits) strcpy(dir, real);
+    free(real);
+    if (!fits) return -1;
+    for (;;) {
+        char probe[SYSFS_PATH_LEN + 16]; snprintf(probe, sizeof(probe), "%s/idVendor", dir);
+        if (access(probe, R_OK) == 0) break;
+        char *slash = strrchr(dir, '/');
+        if (!slash || slash == dir) return -1;
+        *slash = '\0';
+    }
+    read_attr(dir, "idVendor", ev->vendor, sizeof(ev->vendor));
+    read_attr(dir, "idProduct", ev->product, sizeof(ev->product));
+    read_attr(dir, "serial", ev->serial, sizeof(ev->serial));
+    snprintf(ev->port, sizeof(ev->port), "%s", strrchr(dir, '/') + 1);
+    return 0;
+}
+
+int uevent_open(void)
+{
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    if (fd < 0) return -1;
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = 1; /* kernel events */
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) { close(fd); return -1; }
+    /* Events queue up unread while the upload runs. The FORCE variant
+     * ignores rmem_max but needs CAP_NET_ADMIN; without it the kernel caps
+     * the plain one. */
+    int size = UEVENT_RCVBUF;
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) != 0)
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    return fd;
+}
+
+void uevent_close(int fd)
+{
+    if (fd >= 0) close(fd);
+}
+
+/* Parse "ACTION@DEVPATH\0KEY=VALUE\0..." into `ev`. Returns 1 for a USB
+ * serial add or remove. */
+static int parse_uevent(const char *buf, size_t len, uevent_tty_t *ev)
+{
+    const char *action = NULL, *devpath = NULL, *subsystem = NULL, *devname = NULL;
+    for (size_t i = 0; i < len; i += strlen(buf + i) + 1) {
+        const char *kv = buf + i;
+        if (strncmp(kv, "ACTION=", 7) == 0) action = kv + 7;
+        else if (strncmp(kv, "DEVPATH=", 8) == 0) devpath = kv + 8;
+        else if (strncmp(kv, "SUBSYSTEM=", 10) == 0) subsystem = kv + 10;
+        else if (strncmp(kv, "DEVNAME=", 8) == 0) devname = kv + 8;
+    }
+    if (!action || !devpath || !subsystem || !devname || strcmp(subsystem, "tty") != 0) return 0;
+    if (strncmp(devname, "/dev/", 5) == 0) devname += 5;
+    if (!is_usb_tty(devname)) return 0;
+
+    memset(ev, 0, sizeof(*ev));
+    snprintf(ev->name, sizeof(ev->name), "%s", devname);
+    if (strcmp(action, "add") == 0) {
+        ev->added = 1;
+        char sysdir[SYSFS_PATH_LEN]; snprintf(sysdir, sizeof(sysdir), "/sys%s", devpath);
+        fill_usb_attrs(sysdir, ev); /* may already be gone again */
+        return 1;
+    }
+    return strcmp(action, "remove") == 0;
+}
+
+static int64_t now_ms(void)
+{
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int uevent_read_tty(int fd, int timeout_ms, uevent_tty_t *ev)
+{
+    char buf[UEVENT_BUF];
+    int64_t deadline = now_ms() + timeout_ms;
+    for (;;) {
+        int wait = timeout_ms;
+        if (timeout_ms > 0) { int64_t left = deadline - now_ms(); wait = left > 0 ? (int)left : 0; }
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        int pr = poll(&pfd, 1, wait);
+        if (pr < 0 && errno == EINTR) continue;
+        if (pr <= 0) return pr;
+
+        struct sockaddr_nl from; socklen_t from_len = sizeof(from);
+        ssize_t n = recvfrom(fd, buf, sizeof(buf) - 1, 0, (struct sockaddr *)&from, &from_len);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            if (errno == ENOBUFS) return UEVENT_OVERRUN;
+            return -1;
+        }
+        if (from.nl_pid != 0) continue; /* only trust the kernel */
+        buf[n] = '\0';
+        if (parse_uevent(buf, (size_t)n, ev)) return 1;
+    }
+}
+
+int uevent_tty_info(const char *name, uevent_tty_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    snprintf(out->name, sizeof(out->name), "%s", name);
+    out->added = 1;
+    char sysdir[SYSFS_PATH_LEN]; snprintf(sysdir, sizeof(sysdir), "/sys/class/tty/%s", name);
+    return fill_usb_attrs(sysdir, out);
+}
+
+int uevent_same_device(const uevent_tty_t *a, const uevent_tty_t *b)
+{
+    if (a->serial[0] && b->serial[0]) return strcmp(a->serial, b->serial) == 0;
+    return a->port[0] && strcmp(a->port, b->port) == 0 &&
+           strcmp(a->vendor, b->vendor) == 0 && strcmp(a->product, b->product) == 0;
+}
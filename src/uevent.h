@@ -0,0 +1,50 @@
+#pragma once
+#ifndef UEVENT_H
+#define UEVENT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* USB serial (ttyACM* / ttyUSB*) hotplug events from the kernel's netlink
+ * uevent socket, with the USB attributes of the device behind the node.
+ */
+typedef struct {
+    int added;          /* 1: node appeared, 0: node went away */
+    char name[32];      /* node name, e.g. "ttyACM0" */
+    char vendor[8];     /* idVendor, e.g. "2341"; empty if unknown */
+    char product[8];    /* idProduct */
+    char serial[64];    /* USB serial number; empty if the device has none */
+    char port[32];      /* USB port path, e.g. "1-1.2" */
+} uevent_tty_t;
+
+/* Open a monitor. Events are queued from this call on, so open it before
+ * doing whatever makes the device re-enumerate. Returns a pollable fd or
+ * -1 (e.g. no netlink in this environment).
+ */
+int uevent_open(void);
+void uevent_close(int fd);
+
+#define UEVENT_OVERRUN (-2)
+
+/* Wait up to `timeout_ms` (-1: forever, 0: don't wait) for the next USB
+ * serial event. Returns 1 with `ev` filled, 0 on timeout, -1 on error, or
+ * UEVENT_OVERRUN if the socket buffer overflowed and events were lost; the
+ * monitor keeps working, but the caller must re-read the current state.
+ * Removal events carry only `name`: the attributes are already gone.
+ */
+int uevent_read_tty(int fd, int timeout_ms, uevent_tty_t *ev);
+
+/* USB attributes of an existing node, read from sysfs. Returns 0 or -1. */
+int uevent_tty_info(const char *name, uevent_tty_t *out);
+
+/* Whether `a` and `b` are the same physical device: same USB serial when
+ * both have one, otherwise same vendor, product and USB port.
+ */
+int uevent_same_device(const uevent_tty_t *a, const uevent_tty_t *b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UEVENT_H */
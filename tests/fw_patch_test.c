@@ -0,0 +1,163 @@
+/*
+ * fw_patch_test.c
+ * Host test for src/fw_patch.c: patches a sample image holding a config
+ * block behind a decoy magic and checks every byte of the result.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "src/fw_patch.h"
+#include "firmware/plant_sensor/fw_config.h"
+
+#define IMAGE_SIZE 1024
+#define DECOY_OFFSET 100  /* magic with the wrong version and size */
+#define BLOCK_OFFSET 500  /* 4-aligned, as the linker places it */
+
+static int failures = 0;
+
+#define CHECK(cond) do { if (!(cond)) { fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); failures++; } } while (0)
+
+static void put_le16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_string(uint8_t *field, const char *s) { memcpy(field, s, strlen(s) + 1); }
+
+/* Filler bytes, a decoy and a block holding the firmware's defaults */
+static void make_image(uint8_t *image, int with_block)
+{
+    for (size_t i = 0; i < IMAGE_SIZE; ++i) image[i] = (uint8_t)(i * 7 + 3);
+
+    uint8_t *decoy = image + DECOY_OFFSET;
+    memcpy(decoy, FW_CONFIG_MAGIC, FW_CONFIG_MAGIC_LEN);
+    put_le16(decoy + offsetof(fw_config_t, version), FW_CONFIG_VERSION + 1);
+    put_le16(decoy + offsetof(fw_config_t, size), FW_CONFIG_SIZE - 4);
+    if (!with_block) return;
+
+    uint8_t *b = image + BLOCK_OFFSET;
+    memset(b, 0, FW_CONFIG_SIZE);
+    memcpy(b, FW_CONFIG_MAGIC, FW_CONFIG_MAGIC_LEN);
+    put_le16(b + offsetof(fw_config_t, version), FW_CONFIG_VERSION);
+    put_le16(b + offsetof(fw_config_t, size), FW_CONFIG_SIZE);
+    put_string(b + offsetof(fw_config_t, ssid), "PiTestAP-with-a-long-default");
+    put_string(b + offsetof(fw_config_t, pass), "doublepump-and-then-some-more-text");
+    put_string(b + offsetof(fw_config_t, target_ip), "192.168.50.100");
+    b[offsetof(fw_config_t, control_pin)] = 2;
+}
+
+/* `field` holds `s` followed by zeros up to its end */
+static int field_is(const uint8_t *field, size_t len, const char *s)
+{
+    size_t n = strlen(s);
+    if (n >= len || memcmp(field, s, n) != 0) return 0;
+    for (size_t i = n; i < len; ++i) if (field[i] != 0) return 0;
+    return 1;
+}
+
+static void check_patched(const uint8_t *image, const uint8_t *orig)
+{
+    const uint8_t *b = image + BLOCK_OFFSET;
+    CHECK(field_is(b + offsetof(fw_config_t, ssid), sizeof(((fw_config_t *)0)->ssid), "MyNet"));
+    CHECK(field_is(b + offsetof(fw_config_t, pass), sizeof(((fw_config_t *)0)->pass), "secret"));
+    CHECK(field_is(b + offsetof(fw_config_t, target_ip), sizeof(((fw_config_t *)0)->target_ip), "10.0.0.7"));
+    CHECK(b[offsetof(fw_config_t, control_pin)] == 5);
+    CHECK(get_le32(b + FW_CONFIG_CRC_OFFSET) == fw_config_crc32(b, FW_CONFIG_CRC_OFFSET));
+    CHECK(get_le32(b + FW_CONFIG_CRC_OFFSET) != FW_CONFIG_CRC_UNSET);
+
+    /* Nothing outside the block changed, the decoy included */
+    CHECK(memcmp(image, orig, BLOCK_OFFSET) == 0);
+    CHECK(memcmp(image + BLOCK_OFFSET + FW_CONFIG_SIZE, orig + BLOCK_OFFSET + FW_CONFIG_SIZE,
+                 IMAGE_SIZE - BLOCK_OFFSET - FW_CONFIG_SIZE) == 0);
+}
+
+static const fw_patch_config_t good = { "MyNet", "secret", "10.0.0.7", 5 };
+
+static void test_patch_image(void)
+{
+    uint8_t image[IMAGE_SIZE], orig[IMAGE_SIZE];
+    make_image(image, 1); memcpy(orig, image, sizeof(image));
+    CHECK(fw_patch_image(image, sizeof(image), &good) == FW_PATCH_OK);
+    check_patched(image, orig);
+}
+
+static void test_keep_unset_fields(void)
+{
+    uint8_t image[IMAGE_SIZE];
+    make_image(image, 1);
+    fw_patch_config_t cfg = { "MyNet", NULL, NULL, -1 };
+    CHECK(fw_patch_image(image, sizeof(image), &cfg) == FW_PATCH_OK);
+    const uint8_t *b = image + BLOCK_OFFSET;
+    CHECK(field_is(b + offsetof(fw_config_t, ssid), sizeof(((fw_config_t *)0)->ssid), "MyNet"));
+    CHECK(field_is(b + offsetof(fw_config_t, pass), sizeof(((fw_config_t *)0)->pass), "doublepump-and-then-some-more-text"));
+    CHECK(field_is(b + offsetof(fw_config_t, target_ip), sizeof(((fw_config_t *)0)->target_ip), "192.168.50.100"));
+    CHECK(b[offsetof(fw_config_t, control_pin)] == 2);
+    CHECK(get_le32(b + FW_CONFIG_CRC_OFFSET) == fw_config_crc32(b, FW_CONFIG_CRC_OFFSET));
+}
+
+static void test_rejects_leave_image(void)
+{
+    uint8_t image[IMAGE_SIZE], orig[IMAGE_SIZE];
+    make_image(image, 1); memcpy(orig, image, sizeof(image));
+
+    char ssid33[34]; memset(ssid33, 'a', 33); ssid33[33] = '\0';
+    fw_patch_config_t long_ssid = { ssid33, "secret", "10.0.0.7", 5 };
+    CHECK(fw_patch_image(image, sizeof(image), &long_ssid) == FW_PATCH_TOO_LONG);
+    CHECK(memcmp(image, orig, sizeof(image)) == 0);
+
+    fw_patch_config_t big_pin = { "MyNet", "secret", "10.0.0.7", 256 };
+    CHECK(fw_patch_image(image, sizeof(image), &big_pin) == FW_PATCH_TOO_LONG);
+    CHECK(memcmp(image, orig, sizeof(image)) == 0);
+
+    /* 32 characters is the most that fits */
+    ssid33[32] = '\0';
+    CHECK(fw_patch_image(image, sizeof(image), &long_ssid) == FW_PATCH_OK);
+}
+
+static void test_no_block(void)
+{
+    uint8_t image[IMAGE_SIZE], orig[IMAGE_SIZE];
+    make_image(image, 0); memcpy(orig, image, sizeof(image));
+    CHECK(fw_patch_image(image, sizeof(image), &good) == FW_PATCH_NO_BLOCK);
+    CHECK(memcmp(image, orig, sizeof(image)) == 0);
+    CHECK(fw_patch_image(image, FW_CONFIG_SIZE - 1, &good) == FW_PATCH_NO_BLOCK);
+}
+
+static void test_patch_file(void)
+{
+    uint8_t image[IMAGE_SIZE], orig[IMAGE_SIZE], out[IMAGE_SIZE + 1];
+    make_image(image, 1); memcpy(orig, image, sizeof(image));
+
+    char in_path[64], out_path[64];
+    snprintf(in_path, sizeof(in_path), "fw_patch_test_%d_in.bin", (int)getpid());
+    snprintf(out_path, sizeof(out_path), "fw_patch_test_%d_out.bin", (int)getpid());
+    FILE *f = fopen(in_path, "wb"); CHECK(f != NULL); if (!f) return;
+    fwrite(image, 1, sizeof(image), f); fclose(f);
+
+    CHECK(fw_patch_file(in_path, out_path, &good) == FW_PATCH_OK);
+    f = fopen(out_path, "rb"); CHECK(f != NULL);
+    if (f) {
+        CHECK(fread(out, 1, sizeof(out), f) == IMAGE_SIZE);
+        fclose(f);
+        check_patched(out, orig);
+    }
+    CHECK(fw_patch_file("fw_patch_test_missing.bin", out_path, &good) == FW_PATCH_IO);
+    remove(in_path); remove(out_path);
+}
+
+int main(void)
+{
+    test_patch_image();
+    test_keep_unset_fields();
+    test_rejects_leave_image();
+    test_no_block();
+    test_patch_file();
+    if (failures) { fprintf(stderr, "fw_patch_test: %d check(s) failed\n", failures); return 1; }
+    printf("fw_patch_test: all checks passed\n");
+    return 0;
+}